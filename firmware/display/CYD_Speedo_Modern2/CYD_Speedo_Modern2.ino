@@ -8,7 +8,12 @@
  * FreeSansBold48pt7b or using truetype2gfx converter.
  */
 
+#include "digit_atlas.h"
+#include "history_graph.h"
+#include "sensor_registry.h"
+#include "trip_computer.h"
 #include <Adafruit_GFX.h>
+#include <Preferences.h>
 #include <SD.h>
 #include <SPI.h>
 #include <TFT_eSPI.h>
@@ -16,45 +21,10 @@
 #include <XPT2046_Touchscreen_TT.h>
 #include <esp_now.h>
 #include <esp_wifi.h>
-
-// ===== OIL SENDER DATA PACKET (Protocol v3) =====
-typedef struct __attribute__((packed)) {
-  uint8_t version;     // Protocol version = 3
-  uint32_t timestamp;  // Milliseconds since boot
-  float temperature;   // Head Temperature in Celsius (currently unused)
-  float coldJunction;  // Head Cold junction temperature
-  uint8_t faultStatus; // Head MAX31856 fault register
-
-  float oilTemperature;   // Oil Temperature in Celsius
-  float oilColdJunction;  // Oil Cold junction temperature
-  uint8_t oilFaultStatus; // Oil MAX31856 fault register
-
-  float oilPressure;       // Oil Pressure in PSI
-  uint8_t sensorsStatus;   // Bitmask: Bit 0=Head, 1=Oil Temp, 2=Oil Press
-  uint16_t sequenceNumber; // Packet sequence number
-  uint8_t batteryLevel;    // Battery percentage 0-100
-  uint8_t checksum;        // XOR checksum
-} SensorData;
-
-// ===== FUEL SENDER DATA PACKET (Protocol v1) =====
-typedef struct __attribute__((packed)) {
-  uint8_t version;           // Protocol version = 1
-  uint16_t raw_resistance;   // Fuel sender resistance in 0.01 Ohm units
-  uint8_t fuel_percent;      // Calculated fuel percentage (0-100%)
-  uint8_t fault_status;      // Fault flags
-  uint32_t timestamp;        // Milliseconds since boot
-  uint16_t sequence_number;  // Packet counter
-  uint8_t checksum;          // XOR checksum
-} FuelDataPacket;
-
-// Fault status flags
-#define FUEL_FAULT_NONE 0x00
-#define FUEL_FAULT_OPEN_CIRCUIT 0x01
-#define FUEL_FAULT_SHORT_CIRCUIT 0x02
-#define FUEL_FAULT_LOW_FUEL 0x04
-
-SensorData receivedData;
-FuelDataPacket fuelData;
+#include <link_espnow.h>
+#include <packet_link.h>
+#include <telemetry_uplink.h>
+#include <vehicle_packets.h>
 
 TFT_eSPI tft = TFT_eSPI();
 
@@ -74,19 +44,118 @@ String currentLon = "--";
 String currentAlt = "--";
 float currentHeading = 0.0;
 
-// ESP-NOW Sensor data - Oil Sender
-float currentOilTemp = 0.0;
-float currentOilPressure = 0.0;
-unsigned long lastOilUpdate = 0;
-bool oilDataValid = false;
+// ESP-NOW sensor channels. Decoders turn each sender's packets into
+// channel readings; the channel table is next to registerSensors().
+SensorRegistry sensors;
+
+#define CHANNEL_OIL_TEMP 1   // Channel ids emitted by the decoders
+#define CHANNEL_OIL_PRESS 2
+#define CHANNEL_FUEL_LEVEL 3
 
-// ESP-NOW Sensor data - Fuel Sender
-uint8_t currentFuelPercent = 0;
-uint8_t fuelFaultStatus = 0;
-unsigned long lastFuelUpdate = 0;
-bool fuelDataValid = false;
+#define SENSOR_OIL_TEMP 0    // Handles: index into sensorDefs
+#define SENSOR_OIL_PRESS 1
+#define SENSOR_FUEL 2
+#define SENSOR_COUNT 3
+#define SENSOR_PANEL_SLOTS 3 // Channels shown in the bottom panel
 
 #define DATA_TIMEOUT_MS 5000  // Mark data as stale if no update for 5 seconds
+#define SENSOR_LATENCY_LOG_MS 10000
+
+// Broadcast link - senders in our group pair with us and broadcast to every
+// receiver, so a second display or logger needs no sender changes
+#define LINK_GROUP_ID 1 // Same as the senders' LINK_GROUP_ID
+LinkReceiver radioLink;
+
+// Boot - 1 starts the radio at once and draws the first frame without the
+// old serial and WiFi settling delays; the SD card is brought up after the
+// first frame. 0 keeps the bench boot that waits for a serial monitor.
+#define FAST_BOOT 1
+unsigned long firstFrameMs = 0;      // ms since reset, logged as [BOOT]
+unsigned long firstSensorMs[SENSOR_COUNT] = {};
+
+// Sender alarm flags last drawn per sensor, logged as [ALARM] on change
+uint16_t shownAlarms[SENSOR_COUNT] = {};
+bool sdPending = true;               // SD.begin() still to run
+
+// Time beacon - senders lock to it and stamp samples in our millis()
+#define TIME_BEACON_INTERVAL_MS 1000
+#define GPS_SPEED_TIMEOUT_MS 3000 // Older GPS speed goes out as unknown
+uint16_t beaconSeq = 0;
+unsigned long lastBeacon = 0;
+unsigned long lastLatencyLog = 0;
+
+// Telemetry uplink - the merged sensor and GPS state goes back to the laptop
+// as binary frames between the log lines (telemetry_uplink.h), for its
+// recorder. 0 leaves the serial port to the log alone.
+#define TELEMETRY_UPLINK 1
+#define TELEMETRY_INTERVAL_MS 1000
+uint16_t telemetrySeq = 0;
+unsigned long lastTelemetry = 0;
+
+// Trip computer
+TripComputer trip;
+Preferences tripPrefs;
+uint32_t tripFuelUpdates = 0; // Fuel readings already fed to the trip
+unsigned long lastTripSave = 0;
+
+#define TRIP_PREFS_NAMESPACE "cyd_trip"
+#define TRIP_PREFS_KEY "state"
+#define TRIP_SAVE_INTERVAL_MS 60000  // Persist trip at most once a minute
+
+// Info row pages (tap the screen to cycle, hold on TRIP to reset it)
+#define INFO_PAGE_GPS 0
+#define INFO_PAGE_TRIP 1
+#define INFO_PAGE_GRAPHS 2
+#define INFO_PAGE_COUNT 3
+#define TOUCH_HOLD_RESET_MS 2000
+int infoPage = INFO_PAGE_GPS;
+bool touchDown = false;
+unsigned long touchStart = 0;
+
+// History graphs - one hour of min/max per pixel column
+#define GRAPH_OIL_TEMP 0
+#define GRAPH_OIL_PRESS 1
+#define GRAPH_FUEL 2
+#define GRAPH_COUNT 3
+
+typedef struct {
+  int sensor; // Registry handle
+  float lo;   // Value at bottom of strip
+  float hi;   // Value at top of strip
+  uint16_t color;
+  HistoryRing ring;
+} GraphChannel;
+
+GraphChannel graphs[GRAPH_COUNT] = {
+    {SENSOR_OIL_TEMP, 100.0f, 300.0f, 0xFD20, HistoryRing()},
+    {SENSOR_OIL_PRESS, 0.0f, 100.0f, TFT_GREEN, HistoryRing()},
+    {SENSOR_FUEL, 0.0f, 100.0f, TFT_CYAN, HistoryRing()},
+};
+HistoryClock historyClock;
+
+// Speed digits - pre-rendered atlas pushed with DMA. Set to 0 to fall back to
+// the scaled built-in font (keeps the timing log for before/after comparison;
+// the host emulator takes -DUSE_DIGIT_ATLAS=0).
+#ifndef USE_DIGIT_ATLAS
+#define USE_DIGIT_ATLAS 1
+#endif
+#define SPEED_MAX_DIGITS 3
+#define SPEED_DIGITS_Y 43     // Top of the glyphs (same as size-8 text at y=75)
+#define SPEED_PERF_LOG_MS 10000
+
+DigitAtlas digitAtlas;
+uint16_t digitCellBuf[2][DIGIT_CELL_W * DIGIT_H]; // Double buffer for DMA
+uint16_t digitPalette[16];
+uint16_t digitPaletteColor = 0;
+int shownDigits[SPEED_MAX_DIGITS];
+int shownDigitCount = 0;
+uint16_t shownSpeedColor = 0;
+
+// Per-update speed draw timing
+uint32_t speedDrawCount = 0;
+uint32_t speedDrawTotalUs = 0;
+uint32_t speedDrawMaxUs = 0;
+unsigned long lastSpeedPerfLog = 0;
 
 // Previous values
 float prevSpeed = -1.0;
@@ -96,12 +165,53 @@ String prevLat = "";
 String prevLon = "";
 String prevAlt = "";
 float prevHeading = -1.0;
-float prevOilTemp = -999.0;
-float prevOilPressure = -999.0;
-uint8_t prevFuelPercent = 255;
+int prevTripTenths = -1;
+int prevTripRange = -1;
+int prevTripMpgTenths = -1;
 
 unsigned long lastUpdate = 0;
-bool firstDraw = true;
+
+// ===== FRAME SCHEDULER =====
+// Data sources mark the widgets they invalidate; loop() renders at most one
+// frame per FRAME_MIN_INTERVAL_MS covering everything marked since the last.
+#define DIRTY_HEADER 0x01
+#define DIRTY_SPEED 0x02
+#define DIRTY_INFO_ROW 0x04 // Position/heading or trip panels
+#define DIRTY_SENSORS 0x08  // Oil/fuel panel, or graph labels on graph page
+#define DIRTY_GRAPH 0x10    // New history column(s) to draw
+#define DIRTY_PAGE 0x20     // Whole info area (page change)
+#define DIRTY_ALL 0x3F
+
+#define FRAME_MIN_INTERVAL_MS 40 // Cap at 25 fps
+#define FRAME_PERF_LOG_MS 10000
+
+uint8_t pendingDirty = 0;
+uint32_t dirtySinceUs = 0;         // Oldest unrendered change in this frame
+volatile uint8_t radioDirty = 0;   // Set from the ESP-NOW callback
+volatile uint32_t radioDirtyUs = 0;
+int pendingGraphColumns = 0;
+unsigned long lastFrameMs = 0;
+
+// Frame statistics, logged every FRAME_PERF_LOG_MS
+uint32_t framesRendered = 0;
+uint32_t updatesCoalesced = 0; // markDirty() calls with a frame already pending
+uint32_t passesHeld = 0;       // loop() passes the frame cap held a frame back
+uint32_t frameTotalUs = 0;
+uint32_t frameMaxUs = 0;
+uint32_t latencyTotalUs = 0;
+uint32_t latencyMaxUs = 0;
+unsigned long lastFramePerfLog = 0;
+
+// What the sensor panel or graph labels last drew for each channel. Packets
+// arrive about twice a second; only a change here is worth a frame.
+typedef struct {
+  bool valid;
+  bool fault;
+  uint8_t level;
+  char text[16]; // Formatted value
+} ShownReading;
+
+ShownReading shownReadings[SENSOR_COUNT];
 
 // ===== MODERN DASHBOARD DESIGN CONFIG =====
 // Color scheme - orange/amber theme
@@ -124,82 +234,297 @@ bool firstDraw = true;
 #define INFO_PANEL_Y 130
 #define PANEL_MARGIN 5
 
+// Graph page layout (covers info row + sensor panel)
+#define GRAPH_X 10            // Left edge of the plot area
+#define GRAPH_STRIP_H 35      // Label row + plot per channel
+#define GRAPH_LABEL_H 10
+#define GRAPH_PLOT_H 22
+
+
 // ESP-NOW Receive Callback (ESP32 Arduino Core 3.x)
-// Handles both oil sender (v3) and fuel sender (v1) packets
+// The registry picks the decoder by message type and updates the channels
+// registered for this sender
 void onDataReceive(const esp_now_recv_info *recv_info, const uint8_t *data,
                    int data_len) {
-  if (data_len < 1) return;  // Minimum: version byte
-  
-  uint8_t packet_version = data[0];
-  
-  // ===== OIL SENDER PACKET (TempDataPacket, v3) =====
-  if (packet_version == 3 && data_len == sizeof(SensorData)) {
-    memcpy(&receivedData, data, sizeof(SensorData));
-
-    // Update current values
-    currentOilTemp = receivedData.oilTemperature;
-    currentOilPressure = receivedData.oilPressure;
-    lastOilUpdate = millis();
-    oilDataValid = true;
-
-    // Debug output
-    Serial.print("[OIL] ESP-NOW from: ");
-    for (int i = 0; i < 6; i++) {
-      Serial.printf("%02X", recv_info->src_addr[i]);
-      if (i < 5) Serial.print(":");
-    }
-    Serial.print(" - Oil Temp: ");
-    Serial.print(currentOilTemp);
-    Serial.print("C, Oil Pressure: ");
-    Serial.print(currentOilPressure);
-    Serial.println(" PSI");
+  // Repeated events are older than what's on screen, so only new data from
+  // paired senders reaches the registry
+  uint8_t missed = 0;
+  const int rx =
+      radioLink.receive(recv_info->src_addr, data, data_len, &missed);
+  int updated = rx == LINK_RX_DATA
+                    ? sensors.ingest(recv_info->src_addr,
+                                     packetType(data, data_len), data,
+                                     data_len, millis(), missed)
+                    : -1;
+  if (updated > 0)
+    markRadioDirty();
+
+  // Debug output
+  static const char *const RX_LABELS[] = {"[UNKNOWN] ", "[LINK] ", "[RX] ",
+                                          "[REPEAT] ", "[UNPAIRED] "};
+  Serial.print(rx == LINK_RX_DATA && updated < 0 ? "[UNKNOWN] "
+                                                 : RX_LABELS[rx]);
+  for (int i = 0; i < 6; i++) {
+    Serial.printf("%02X", recv_info->src_addr[i]);
+    if (i < 5) Serial.print(":");
   }
-  
-  // ===== FUEL SENDER PACKET (FuelDataPacket, v1) =====
-  else if (packet_version == 1 && data_len == sizeof(FuelDataPacket)) {
-    memcpy(&fuelData, data, sizeof(FuelDataPacket));
-
-    // Update current values
-    currentFuelPercent = fuelData.fuel_percent;
-    fuelFaultStatus = fuelData.fault_status;
-    lastFuelUpdate = millis();
-    fuelDataValid = true;
-
-    // Debug output
-    Serial.print("[FUEL] ESP-NOW from: ");
-    for (int i = 0; i < 6; i++) {
-      Serial.printf("%02X", recv_info->src_addr[i]);
-      if (i < 5) Serial.print(":");
-    }
-    Serial.print(" - Fuel: ");
-    Serial.print(currentFuelPercent);
-    Serial.print("%, Resistance: ");
-    Serial.print(fuelData.raw_resistance / 100.0, 1);
-    Serial.print(" Ohm, Faults: 0x");
-    Serial.println(fuelFaultStatus, HEX);
+  Serial.printf(" version=0x%02X type=0x%02X size=%d channels=%d\n",
+                data_len > 0 ? data[0] : 0, data_len > 1 ? data[1] : 0,
+                data_len, updated);
+}
+
+// ===== SENSOR DECODERS =====
+// Each packet carries the previous PACKET_HISTORY_DEPTH readings, so frames
+// the link reports missed are rebuilt from it without a retransmit
+void setReading(ChannelReading *r, uint8_t channelId, float value,
+                uint8_t faults, uint32_t sampleMs, bool synced,
+                bool recovered) {
+  r->channelId = channelId;
+  r->value = value;
+  r->faults = faults;
+  r->sampleMs = sampleMs;
+  r->synced = synced;
+  r->recovered = recovered;
+  r->severity = CHANNEL_NORMAL;
+  r->alarms = 0;
+  r->windowSamples = 0;
+  r->windowFault = false;
+}
+
+// Range of the samples the sender took since its last packet
+void setWindow(ChannelReading *r, uint8_t samples, float lo, float hi,
+               uint16_t faultAgeMs) {
+  r->windowSamples = samples;
+  r->windowMin = lo;
+  r->windowMax = hi;
+  r->windowFault = faultAgeMs != 0;
+}
+
+// Sender alarm flags for one channel, and how bad the worst of them is
+void setAlarms(ChannelReading *r, uint16_t alarms, uint16_t criticalMask) {
+  r->alarms = alarms;
+  r->severity = (alarms & criticalMask) ? CHANNEL_ALARM
+                : alarms                 ? CHANNEL_WARNING
+                                         : CHANNEL_NORMAL;
+}
+
+int decodeOilPacket(const uint8_t *data, size_t len, uint8_t missed,
+                    ChannelReading *out, int maxOut) {
+  TempDataPacketView oil(data, len);
+  if (!oil.valid() || maxOut < 2 + 2 * PACKET_HISTORY_DEPTH)
+    return -1;
+  const uint32_t t = oil.timestamp();
+  const bool synced = oil.timeSource() == TIME_SOURCE_DISPLAY;
+  // Display in F
+  setReading(&out[0], CHANNEL_OIL_TEMP, oil.oilTemperature() * 9.0 / 5.0 + 32.0,
+             oil.oilFaultStatus(), t, synced, false);
+  setReading(&out[1], CHANNEL_OIL_PRESS, oil.oilPressure(), 0, t, synced,
+             false);
+  // Raised by the sender's rules on this sample
+  setAlarms(&out[0], oil.alarms() & OIL_ALARM_TEMP_MASK,
+            OIL_ALARM_CRITICAL_MASK);
+  setAlarms(&out[1], oil.alarms() & OIL_ALARM_PRESS_MASK,
+            OIL_ALARM_CRITICAL_MASK);
+  // Every sample since the sender's last packet
+  setWindow(&out[0], oil.oilTempSamples(), oil.oilTempMin() * 0.18f + 32.0f,
+            oil.oilTempMax() * 0.18f + 32.0f, oil.faultAgeMs());
+  setWindow(&out[1], oil.oilPressSamples(), oil.oilPressMin() / 10.0f,
+            oil.oilPressMax() / 10.0f, 0);
+  int n = 2;
+  if (missed >= 1 && oil.prev1AgeMs()) {
+    setReading(&out[n++], CHANNEL_OIL_TEMP, oil.prev1OilTemp() * 0.18f + 32.0f,
+               oil.prev1OilFault(), t - oil.prev1AgeMs(), synced, true);
+    setReading(&out[n++], CHANNEL_OIL_PRESS, oil.prev1OilPressure() / 10.0f,
+               0, t - oil.prev1AgeMs(), synced, true);
   }
-  
-  // Unknown packet type
-  else {
-    Serial.print("[UNKNOWN] Packet version=0x");
-    Serial.print(packet_version, HEX);
-    Serial.print(" size=");
-    Serial.println(data_len);
+  if (missed >= 2 && oil.prev2AgeMs()) {
+    setReading(&out[n++], CHANNEL_OIL_TEMP, oil.prev2OilTemp() * 0.18f + 32.0f,
+               oil.prev2OilFault(), t - oil.prev2AgeMs(), synced, true);
+    setReading(&out[n++], CHANNEL_OIL_PRESS, oil.prev2OilPressure() / 10.0f,
+               0, t - oil.prev2AgeMs(), synced, true);
   }
+  return n;
+}
+
+int decodeFuelPacket(const uint8_t *data, size_t len, uint8_t missed,
+                     ChannelReading *out, int maxOut) {
+  FuelDataPacketView fuel(data, len);
+  if (!fuel.valid() || maxOut < 1 + PACKET_HISTORY_DEPTH)
+    return -1;
+  const uint32_t t = fuel.timestamp();
+  const bool synced = fuel.timeSource() == TIME_SOURCE_DISPLAY;
+  // Low fuel is shown by colour, only wiring faults get the FAULT! flag. The
+  // sender raises it at its own threshold setting.
+  setReading(&out[0], CHANNEL_FUEL_LEVEL, fuel.fuel_percent(),
+             fuel.fault_status() & ~FUEL_FAULT_LOW_FUEL, t, synced, false);
+  setAlarms(&out[0], fuel.fault_status() & FUEL_FAULT_LOW_FUEL,
+            FUEL_FAULT_LOW_FUEL);
+  setWindow(&out[0], fuel.windowSamples(), fuel.percentMin(),
+            fuel.percentMax(), fuel.faultAgeMs());
+  int n = 1;
+  if (missed >= 1 && fuel.prev1AgeMs())
+    setReading(&out[n++], CHANNEL_FUEL_LEVEL, fuel.prev1Percent(),
+               fuel.prev1Faults() & ~FUEL_FAULT_LOW_FUEL,
+               t - fuel.prev1AgeMs(), synced, true);
+  if (missed >= 2 && fuel.prev2AgeMs())
+    setReading(&out[n++], CHANNEL_FUEL_LEVEL, fuel.prev2Percent(),
+               fuel.prev2Faults() & ~FUEL_FAULT_LOW_FUEL,
+               t - fuel.prev2AgeMs(), synced, true);
+  return n;
+}
+
+// ===== SENSOR FORMATTERS =====
+void formatTempF(float value, char *out, size_t outLen) {
+  snprintf(out, outLen, "%.1f F", value);
+}
+
+void formatPsi(float value, char *out, size_t outLen) {
+  snprintf(out, outLen, "%.1f PSI", value);
+}
+
+void formatPercent(float value, char *out, size_t outLen) {
+  snprintf(out, outLen, "%d%%", (int)value);
+}
+
+// Dash channels, in sensor panel order. To add a sensor, give it a channel
+// id, a decoder for its sender's message type and a row here. Limits live
+// in the senders' settings; the alarms they raise colour the channels.
+const ChannelDef sensorDefs[SENSOR_COUNT] = {
+    {CHANNEL_OIL_TEMP, "OIL TEMP", "F", COLOR_ACCENT, formatTempF, NULL,
+     DATA_TIMEOUT_MS},
+    {CHANNEL_OIL_PRESS, "OIL PRESSURE", "PSI", COLOR_GOOD, formatPsi, NULL,
+     DATA_TIMEOUT_MS},
+    {CHANNEL_FUEL_LEVEL, "FUEL", "%", COLOR_GOOD, formatPercent, NULL,
+     DATA_TIMEOUT_MS},
+};
+
+void registerSensors() {
+  sensors.addDecoder(MSG_TYPE_OIL, decodeOilPacket);
+  sensors.addDecoder(MSG_TYPE_FUEL, decodeFuelPacket);
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    if (sensors.addChannel(&sensorDefs[i]) != i)
+      Serial.printf("Sensor %s not registered\n", sensorDefs[i].label);
+  }
+}
+
+// Broadcast our millis() so senders can stamp samples in display time.
+// Taken right before the send so queueing in loop() doesn't skew it. The
+// GPS speed goes along for the senders' alarm rules that only apply moving.
+void sendTimeBeacon() {
+  TimeBeaconPacket beacon;
+  beacon.beaconSeq = beaconSeq++;
+  bool hasFix = currentFixStatus.indexOf("3D Fix") >= 0 ||
+                currentFixStatus.indexOf("2D Fix") >= 0;
+  beacon.speedMph10 =
+      hasFix && millis() - lastUpdate < GPS_SPEED_TIMEOUT_MS
+          ? (uint16_t)constrain(currentSpeed * 10.0f + 0.5f, 0.0f, 65534.0f)
+          : BEACON_SPEED_UNKNOWN;
+  beacon.displayMs = millis();
+  packetSeal(&beacon);
+  esp_now_send(LINK_BROADCAST, (uint8_t *)&beacon, sizeof(beacon));
+}
+
+// One channel's value in tenths, and its bit in fresh if it is fresh
+int32_t telemetryDeci(int handle, uint8_t bit, uint8_t *fresh) {
+  const ChannelState &ch = sensors.channel(handle);
+  if (ch.valid && ch.faults == 0)
+    *fresh |= bit;
+  return (int32_t)lroundf(ch.value * 10.0f);
+}
+
+// Send the state on screen to the laptop, one frame per call
+void sendTelemetry() {
+  TelemetryPacket pkt = {};
+  pkt.displayMs = millis();
+  pkt.frameSeq = telemetrySeq++;
+  uint8_t fresh = 0;
+  pkt.oilTempF10 = (int16_t)constrain(
+      telemetryDeci(SENSOR_OIL_TEMP, TELEMETRY_OIL_TEMP, &fresh), -32768,
+      32767);
+  pkt.oilPressPsi10 = (uint16_t)constrain(
+      telemetryDeci(SENSOR_OIL_PRESS, TELEMETRY_OIL_PRESS, &fresh), 0, 65535);
+  pkt.fuelPercent10 = (uint16_t)constrain(
+      telemetryDeci(SENSOR_FUEL, TELEMETRY_FUEL, &fresh), 0, 65535);
+  pkt.oilFaults = sensors.channel(SENSOR_OIL_TEMP).faults;
+  pkt.fuelFaults = sensors.channel(SENSOR_FUEL).faults;
+  pkt.oilAlarms = sensors.channel(SENSOR_OIL_TEMP).alarms |
+                  sensors.channel(SENSOR_OIL_PRESS).alarms;
+  pkt.fuelAlarms = (uint8_t)sensors.channel(SENSOR_FUEL).alarms;
+
+  bool hasFix = currentFixStatus.indexOf("3D Fix") >= 0 ||
+                currentFixStatus.indexOf("2D Fix") >= 0;
+  if (hasFix && millis() - lastUpdate < GPS_SPEED_TIMEOUT_MS)
+    fresh |= TELEMETRY_GPS_FIX;
+  pkt.speedMph10 = (uint16_t)constrain(currentSpeed * 10.0f + 0.5f, 0.0f,
+                                       65535.0f);
+  pkt.latE7 = (int32_t)llround(atof(currentLat.c_str()) * 1e7);
+  pkt.lonE7 = (int32_t)llround(atof(currentLon.c_str()) * 1e7);
+  pkt.altM = (int16_t)constrain(lroundf(atof(currentAlt.c_str())), -32768L,
+                                32767L);
+  pkt.headingDeg10 = (uint16_t)constrain(currentHeading * 10.0f + 0.5f, 0.0f,
+                                         3600.0f);
+  pkt.satellites = (uint8_t)constrain(currentSatellites, 0, 255);
+  pkt.fresh = fresh;
+  packetSeal(&pkt);
+
+  uint8_t frame[sizeof(pkt) + UPLINK_OVERHEAD];
+  Serial.write(frame, uplinkFrame(pkt, frame));
+}
+
+// Sensor-to-display latency per channel, from senders locked to the beacon
+void logSensorLatency() {
+  for (int i = 0; i < sensors.size(); i++) {
+    LatencyStats stats = sensors.takeLatency(i);
+    if (stats.count == 0)
+      continue;
+    Serial.printf("[PERF] latency %s: avg %.1f ms, max %ld ms (%lu samples)\n",
+                  sensors.channel(i).def->label,
+                  (float)stats.totalMs / stats.count, (long)stats.maxMs,
+                  (unsigned long)stats.count);
+  }
+}
+
+// Paired senders, event frames recovered by NACK, and lost data frames
+// rebuilt from carried history
+void logLinkStats() {
+  const LinkStats &stats = radioLink.linkStats();
+  Serial.printf("[LINK] senders %d, events recovered %lu, lost %lu, "
+                "nacks %lu, frames missed %lu\n",
+                radioLink.senderCount(), (unsigned long)stats.recovered,
+                (unsigned long)stats.lost, (unsigned long)stats.nacks,
+                (unsigned long)stats.framesMissed);
+  for (int i = 0; i < sensors.size(); i++) {
+    const ChannelState &ch = sensors.channel(i);
+    if (ch.recovered > 0)
+      Serial.printf("[LINK] %s: %lu samples recovered\n", ch.def->label,
+                    (unsigned long)ch.recovered);
+    if (ch.transientFaults > 0)
+      Serial.printf("[LINK] %s: %lu faults cleared between packets\n",
+                    ch.def->label, (unsigned long)ch.transientFaults);
+  }
+}
+
+// Runs on the WiFi task: only record that the sensor panel needs a redraw
+// and when the data arrived, loop() picks it up on the next pass
+void markRadioDirty() {
+  if (radioDirty == 0)
+    radioDirtyUs = micros();
+  __atomic_fetch_or(&radioDirty, DIRTY_SENSORS, __ATOMIC_RELEASE);
 }
 
 void setup() {
   Serial.begin(115200);
+#if !FAST_BOOT
   delay(2000); // Longer delay to let serial stabilize
+#endif
 
   Serial.println("\n\n\n=== CYD GPS Speedometer - Modern Design 2 ===");
 
-  // Initialize WiFi in Station mode for ESP-NOW
+  // Initialize WiFi in Station mode for ESP-NOW. Both calls return once the
+  // driver is in the new state, so there is nothing to wait for.
   Serial.println(">>> Init WiFi for ESP-NOW...");
   WiFi.mode(WIFI_STA);
-  delay(100);
   WiFi.disconnect();
-  delay(500);
   
   // Set WiFi channel to match sender (channel 1)
   esp_wifi_set_channel(1, WIFI_SECOND_CHAN_NONE);
@@ -207,11 +532,11 @@ void setup() {
 
   Serial.print(">>> MAC Address: ");
   Serial.println(WiFi.macAddress());
-  Serial.println(">>> COPY THIS MAC ADDRESS FOR YOUR SENDER!");
+
+  registerSensors();
 
   // Initialize ESP-NOW
   Serial.println(">>> Init ESP-NOW...");
-  delay(100);
 
   esp_err_t result = esp_now_init();
   if (result != ESP_OK) {
@@ -222,21 +547,33 @@ void setup() {
 
     // Register receive callback
     esp_now_register_recv_cb(onDataReceive);
+
+    // Broadcast peer for pair requests and the time beacon
+    if (!radioLink.begin(&LINK_ESPNOW, LINK_GROUP_ID, LINK_ROLE_DISPLAY))
+      Serial.println(">>> ERROR: Broadcast peer not added, cannot pair");
     Serial.println(">>> ESP-NOW receive callback registered");
-    Serial.println(">>> Waiting for data from sender: 98:A3:16:8E:6A:E4 (ESP32-1)");
+    Serial.printf(">>> Pairing with senders in link group %d\n",
+                  LINK_GROUP_ID);
+    // First pair request now, so senders answer while the screen comes up
+    radioLink.poll(millis());
   }
   Serial.println();
 
-  // Backlight
+  // Backlight stays off until the first frame is drawn
   pinMode(21, OUTPUT);
-  digitalWrite(21, HIGH);
-  delay(100);
+  digitalWrite(21, LOW);
 
   // TFT
   Serial.println("Init TFT...");
   tft.init();
   tft.setRotation(1);
   tft.fillScreen(COLOR_BACKGROUND);
+#if USE_DIGIT_ATLAS
+  unsigned long atlasStart = millis();
+  digitAtlas.build();
+  tft.initDMA();
+  Serial.printf("Digit atlas built in %lu ms\n", millis() - atlasStart);
+#endif
   Serial.println("TFT ready");
 
   // Touch
@@ -244,20 +581,74 @@ void setup() {
   ts.setRotation(1);
   Serial.println("Touch ready");
 
-  // SD Card
+  // Trip computer - resume the trip from flash
+  tripPrefs.begin(TRIP_PREFS_NAMESPACE, false);
+  TripState savedTrip;
+  if (tripPrefs.getBytes(TRIP_PREFS_KEY, &savedTrip, sizeof(savedTrip)) ==
+          sizeof(savedTrip) &&
+      trip.restore(savedTrip)) {
+    Serial.printf("Trip restored: %.1f mi, %.2f gal\n", trip.distanceMiles(),
+                  trip.fuelUsedGal());
+  } else {
+    Serial.println("Trip: starting new trip");
+  }
+
+  // SD Card - deselected now, probed after the first frame (an empty slot
+  // can take a while to give up)
   pinMode(SD_CS, OUTPUT);
   digitalWrite(SD_CS, HIGH);
-  if (SD.begin(SD_CS)) {
-    Serial.println("SD Card ready");
-  }
+#if !FAST_BOOT
+  initSdCard();
+#endif
 
   // Draw initial screen
   drawScreen();
-  firstDraw = false;
+  digitalWrite(21, HIGH);
+  lastFrameMs = millis();
+  firstFrameMs = lastFrameMs;
+  Serial.printf("[BOOT] first frame at %lu ms\n", firstFrameMs);
 
   Serial.println("=== READY ===");
 }
 
+void initSdCard() {
+  sdPending = false;
+  if (SD.begin(SD_CS)) {
+    Serial.println("SD Card ready");
+  }
+}
+
+// First time each sensor's reading reaches the screen after boot
+void logFirstSensorFrames() {
+  for (int i = 0; i < sensors.size() && i < SENSOR_COUNT; i++) {
+    if (firstSensorMs[i] == 0 && sensors.channel(i).valid) {
+      firstSensorMs[i] = millis();
+      Serial.printf("[BOOT] first %s on screen at %lu ms\n",
+                    sensors.channel(i).def->label, firstSensorMs[i]);
+    }
+  }
+}
+
+// Sender alarms that changed in the frame just drawn, with how long after
+// the sample that raised them they reached the screen
+void logAlarms() {
+  for (int i = 0; i < sensors.size() && i < SENSOR_COUNT; i++) {
+    const ChannelState &ch = sensors.channel(i);
+    const uint16_t alarms = ch.alarms;
+    if (!ch.valid || alarms == shownAlarms[i])
+      continue;
+    if (alarms & ~shownAlarms[i])
+      Serial.printf("[ALARM] %s: 0x%04X %s, sample to screen %lu ms\n",
+                    ch.def->label, alarms,
+                    ch.severity == CHANNEL_ALARM ? "ALARM" : "warning",
+                    millis() - ch.sampleMs);
+    else
+      Serial.printf("[ALARM] %s: 0x%04X cleared\n", ch.def->label,
+                    shownAlarms[i] & ~alarms);
+    shownAlarms[i] = alarms;
+  }
+}
+
 void loop() {
   // Read serial GPS data
   while (Serial.available()) {
@@ -266,7 +657,7 @@ void loop() {
       if (incomingIdx > 0) {
         incoming[incomingIdx] = '\0';
         parseGPSData(incoming);
-        updateScreen();
+        markGpsDirty();
       }
       incomingIdx = 0;
     } else if (c != '\r' && incomingIdx < 199) {
@@ -274,12 +665,58 @@ void loop() {
     }
   }
 
-  if (millis() - lastUpdate > 2000) {
-    updateScreen();
-    lastUpdate = millis();
+  // Feed fresh fuel readings to the trip computer (one per packet)
+  const ChannelState &fuel = sensors.channel(SENSOR_FUEL);
+  if (fuel.valid && fuel.updates != tripFuelUpdates) {
+    tripFuelUpdates = fuel.updates;
+    trip.addFuel(fuel.value, fuel.sampleMs, fuel.faults != 0);
+  }
+
+  feedHistory();
+
+  handleTouch();
+  saveTripIfDue();
+
+  // Collect updates from the ESP-NOW callback
+  uint32_t radioUs = radioDirtyUs;
+  uint8_t fromRadio = __atomic_exchange_n(&radioDirty, 0, __ATOMIC_ACQUIRE);
+  if (fromRadio && readingsChanged())
+    markDirty(fromRadio, radioUs);
+
+  checkStaleData();
+  checkTripDisplay();
+
+  radioLink.poll(millis()); // Pair requests and event NACKs
+  if (millis() - lastBeacon >= TIME_BEACON_INTERVAL_MS) {
+    lastBeacon = millis();
+    sendTimeBeacon();
+  }
+#if TELEMETRY_UPLINK
+  if (millis() - lastTelemetry >= TELEMETRY_INTERVAL_MS) {
+    lastTelemetry = millis();
+    sendTelemetry();
+  }
+#endif
+  if (millis() - lastLatencyLog >= SENSOR_LATENCY_LOG_MS) {
+    lastLatencyLog = millis();
+    logSensorLatency();
+    logLinkStats();
+  }
+
+  // Render at most one frame per interval, covering everything marked
+  if (pendingDirty && millis() - lastFrameMs >= FRAME_MIN_INTERVAL_MS) {
+    lastFrameMs = millis();
+    renderFrame();
+    logFirstSensorFrames();
+    logAlarms();
+  } else {
+    if (pendingDirty)
+      passesHeld++;
+    if (sdPending)
+      initSdCard(); // Deferred from setup(), on a pass with nothing to draw
   }
 
-  delay(10);
+  delay(2);
 }
 
 void parseGPSData(char *data) {
@@ -316,6 +753,69 @@ void parseGPSData(char *data) {
     currentSatellites = atoi(parts[6]);
 
   lastUpdate = millis();
+
+  bool hasFix = currentFixStatus.indexOf("3D Fix") >= 0 ||
+                currentFixStatus.indexOf("2D Fix") >= 0;
+  trip.addFix(atof(currentLat.c_str()), atof(currentLon.c_str()), currentSpeed,
+              hasFix, lastUpdate);
+}
+
+// Fold new sensor readings, including ones rebuilt after a lost frame, into
+// the graph columns and advance the sweep
+void feedHistory() {
+  for (int g = 0; g < GRAPH_COUNT; g++) {
+    float lo, hi;
+    if (sensors.takeSpan(graphs[g].sensor, &lo, &hi)) {
+      graphs[g].ring.addSample(lo);
+      graphs[g].ring.addSample(hi);
+    }
+  }
+
+  int columns = historyClock.tick(millis());
+  for (int c = 0; c < columns; c++) {
+    for (int g = 0; g < GRAPH_COUNT; g++)
+      graphs[g].ring.commitColumn();
+  }
+  if (columns > 0 && infoPage == INFO_PAGE_GRAPHS) {
+    pendingGraphColumns += columns;
+    markDirty(DIRTY_GRAPH, micros());
+  }
+}
+
+// Tap cycles the info row page; holding on the TRIP page resets the trip
+void handleTouch() {
+  bool touched = ts.touched();
+  if (touched && !touchDown) {
+    touchDown = true;
+    touchStart = millis();
+  } else if (touched && touchDown && infoPage == INFO_PAGE_TRIP &&
+             touchStart != 0 && millis() - touchStart >= TOUCH_HOLD_RESET_MS) {
+    trip.reset();
+    saveTrip();
+    touchStart = 0; // Consume the hold so release doesn't change page
+    Serial.println("Trip reset");
+    markDirty(DIRTY_INFO_ROW, micros());
+  } else if (!touched && touchDown) {
+    touchDown = false;
+    if (touchStart != 0) {
+      infoPage = (infoPage + 1) % INFO_PAGE_COUNT;
+      pendingGraphColumns = 0; // Page draw covers any pending columns
+      markDirty(DIRTY_PAGE, micros());
+    }
+  }
+}
+
+void saveTrip() {
+  const TripState &state = trip.snapshot();
+  tripPrefs.putBytes(TRIP_PREFS_KEY, &state, sizeof(state));
+  trip.clearDirty();
+  lastTripSave = millis();
+}
+
+// Coalesce trip writes to limit flash wear
+void saveTripIfDue() {
+  if (trip.isDirty() && millis() - lastTripSave >= TRIP_SAVE_INTERVAL_MS)
+    saveTrip();
 }
 
 uint16_t getSpeedColor(float speed) {
@@ -337,56 +837,120 @@ uint16_t getFixColor(String fixStatus) {
     return COLOR_BAD;
 }
 
-void updateScreen() {
-  if (firstDraw) {
-    drawScreen();
-    firstDraw = false;
-    return;
-  }
+void markDirty(uint8_t flags, uint32_t sinceUs) {
+  if (pendingDirty == 0)
+    dirtySinceUs = sinceUs;
+  else
+    updatesCoalesced++;
+  pendingDirty |= flags;
+}
 
-  // Update speed if changed
+// GPS line parsed: mark only the widgets whose values moved
+void markGpsDirty() {
+  uint32_t now = micros();
   if (abs(currentSpeed - prevSpeed) > 0.1) {
-    drawSpeedPanel();
     prevSpeed = currentSpeed;
+    markDirty(DIRTY_SPEED, now);
   }
 
-  // Update header if status changed
   if (currentFixStatus != prevFixStatus ||
       currentSatellites != prevSatellites) {
-    drawHeader();
     prevFixStatus = currentFixStatus;
     prevSatellites = currentSatellites;
+    markDirty(DIRTY_HEADER, now);
   }
 
-  // Update info if changed
   if (currentLat != prevLat || currentLon != prevLon || currentAlt != prevAlt ||
-      abs(currentHeading - prevHeading) > 0.1 ||
-      abs(currentOilTemp - prevOilTemp) > 0.1 ||
-      abs(currentOilPressure - prevOilPressure) > 0.1) {
-    drawInfoPanels();
+      abs(currentHeading - prevHeading) > 0.1) {
     prevLat = currentLat;
     prevLon = currentLon;
     prevAlt = currentAlt;
     prevHeading = currentHeading;
-    prevOilTemp = currentOilTemp;
-    prevOilPressure = currentOilPressure;
+    if (infoPage == INFO_PAGE_GPS)
+      markDirty(DIRTY_INFO_ROW, now);
   }
+}
+
+// Check if sensor data is stale (per-channel timeouts)
+void checkStaleData() {
+  if (sensors.expireStale(millis()))
+    markDirty(DIRTY_SENSORS, micros()); // Redraw to show "No Data"
+}
 
-  // Check if sensor data is stale (no update in 5 seconds)
-  if (oilDataValid && (millis() - lastOilUpdate > DATA_TIMEOUT_MS)) {
-    oilDataValid = false;
-    drawInfoPanels(); // Redraw to show "No Data"
+// Update trip page when its rounded values move
+void checkTripDisplay() {
+  if (infoPage != INFO_PAGE_TRIP)
+    return;
+  int tripTenths = (int)(trip.distanceMiles() * 10);
+  float range = -1, mpg = -1;
+  trip.rangeMiles(&range);
+  trip.economyMpg(&mpg);
+  if (tripTenths != prevTripTenths || (int)range != prevTripRange ||
+      (int)(mpg * 10) != prevTripMpgTenths) {
+    prevTripTenths = tripTenths;
+    prevTripRange = (int)range;
+    prevTripMpgTenths = (int)(mpg * 10);
+    markDirty(DIRTY_INFO_ROW, micros());
   }
-  
-  if (fuelDataValid && (millis() - lastFuelUpdate > DATA_TIMEOUT_MS)) {
-    fuelDataValid = false;
-    drawInfoPanels(); // Redraw to show "No Data"
+}
+
+// Draw everything marked since the last frame, then clear the marks
+void renderFrame() {
+  uint8_t dirty = pendingDirty;
+  pendingDirty = 0;
+  uint32_t start = micros();
+
+  if (dirty & DIRTY_HEADER)
+    drawHeader();
+
+  if (dirty & DIRTY_SPEED) {
+    uint32_t speedStart = micros();
+    updateSpeedValue();
+    recordSpeedDrawTime(micros() - speedStart);
   }
-  
-  // Check if fuel percent changed
-  if (currentFuelPercent != prevFuelPercent) {
+
+  if (dirty & DIRTY_PAGE) {
     drawInfoPanels();
-    prevFuelPercent = currentFuelPercent;
+  } else if (infoPage == INFO_PAGE_GRAPHS) {
+    if (dirty & DIRTY_GRAPH)
+      drawPendingGraphColumns();
+    if (dirty & DIRTY_SENSORS)
+      drawGraphLabels(true);
+  } else {
+    if (dirty & DIRTY_INFO_ROW)
+      drawInfoRow();
+    if (dirty & DIRTY_SENSORS)
+      drawSensorSlots(true);
+  }
+
+  uint32_t end = micros();
+  recordFrame(end - start, end - dirtySinceUs);
+}
+
+void recordFrame(uint32_t frameUs, uint32_t latencyUs) {
+  framesRendered++;
+  frameTotalUs += frameUs;
+  if (frameUs > frameMaxUs)
+    frameMaxUs = frameUs;
+  latencyTotalUs += latencyUs;
+  if (latencyUs > latencyMaxUs)
+    latencyMaxUs = latencyUs;
+
+  if (millis() - lastFramePerfLog >= FRAME_PERF_LOG_MS) {
+    lastFramePerfLog = millis();
+    Serial.printf("[PERF] frames: %lu rendered, %lu updates coalesced, %lu "
+                  "passes held by the cap | frame avg %lu us max %lu us | "
+                  "input-to-photon avg %lu ms max %lu ms\n",
+                  framesRendered, updatesCoalesced, passesHeld,
+                  frameTotalUs / framesRendered, frameMaxUs,
+                  latencyTotalUs / framesRendered / 1000, latencyMaxUs / 1000);
+    framesRendered = 0;
+    updatesCoalesced = 0;
+    passesHeld = 0;
+    frameTotalUs = 0;
+    frameMaxUs = 0;
+    latencyTotalUs = 0;
+    latencyMaxUs = 0;
   }
 }
 
@@ -435,6 +999,85 @@ void drawSpeedPanel() {
   tft.fillRoundRect(PANEL_MARGIN, SPEED_PANEL_Y, 320 - PANEL_MARGIN * 2, 4, 2,
                     speedColor);
 
+  // Draw MPH label
+  tft.setTextDatum(MC_DATUM);
+  tft.setFreeFont(NULL);
+  tft.setTextSize(2);
+  tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
+  tft.drawString("MPH", 160, 108);
+
+  // Panel background was just cleared, so every digit must be pushed
+  shownDigitCount = 0;
+  shownSpeedColor = speedColor;
+  drawSpeedDigits(speedColor);
+}
+
+// Speed changed: redraw the accent bar only if the colour band changed and
+// leave the panel background and MPH label alone
+void updateSpeedValue() {
+#if !USE_DIGIT_ATLAS
+  drawSpeedPanel(); // Original full-panel path, kept as the timing baseline
+  return;
+#endif
+  uint16_t speedColor = getSpeedColor(currentSpeed);
+  if (speedColor != shownSpeedColor) {
+    tft.fillRoundRect(PANEL_MARGIN, SPEED_PANEL_Y, 320 - PANEL_MARGIN * 2, 4,
+                      2, speedColor);
+    shownDigitCount = 0; // Force all digits in the new colour
+    shownSpeedColor = speedColor;
+  }
+  drawSpeedDigits(speedColor);
+}
+
+#if USE_DIGIT_ATLAS
+// Push only the digit cells that changed. The next cell is rendered into the
+// spare buffer while DMA sends the previous one.
+void drawSpeedDigits(uint16_t speedColor) {
+  int speedRounded = constrain((int)round(currentSpeed), 0, 999);
+  int digits[SPEED_MAX_DIGITS];
+  int count = 0;
+  do {
+    digits[count++] = speedRounded % 10;
+    speedRounded /= 10;
+  } while (speedRounded > 0 && count < SPEED_MAX_DIGITS);
+  // digits[] is least significant first; flip to left-to-right
+  for (int i = 0; i < count / 2; i++) {
+    int t = digits[i];
+    digits[i] = digits[count - 1 - i];
+    digits[count - 1 - i] = t;
+  }
+
+  if (speedColor != digitPaletteColor) {
+    DigitAtlas::makePalette(speedColor, COLOR_PANEL_BG, true, digitPalette);
+    digitPaletteColor = speedColor;
+  }
+
+  // Centering shifts when the digit count changes, so clear the old extent
+  bool redrawAll = count != shownDigitCount;
+  if (redrawAll && shownDigitCount > 0) {
+    int oldW = shownDigitCount * DIGIT_CELL_W;
+    tft.fillRect(160 - oldW / 2, SPEED_DIGITS_Y, oldW, DIGIT_H,
+                 COLOR_PANEL_BG);
+  }
+
+  int x0 = 160 - (count * DIGIT_CELL_W) / 2;
+  int buf = 0;
+  tft.startWrite();
+  for (int i = 0; i < count; i++) {
+    if (!redrawAll && digits[i] == shownDigits[i])
+      continue;
+    digitAtlas.renderCell(digitCellBuf[buf], digits[i], digitPalette);
+    tft.pushImageDMA(x0 + i * DIGIT_CELL_W, SPEED_DIGITS_Y, DIGIT_CELL_W,
+                     DIGIT_H, digitCellBuf[buf]);
+    buf ^= 1;
+    shownDigits[i] = digits[i];
+  }
+  tft.dmaWait();
+  tft.endWrite();
+  shownDigitCount = count;
+}
+#else
+void drawSpeedDigits(uint16_t speedColor) {
   // Draw HUGE speed number (centered)
   tft.setTextDatum(MC_DATUM);
   tft.setTextSize(8);
@@ -442,18 +1085,47 @@ void drawSpeedPanel() {
   int speedRounded = (int)round(currentSpeed);
   tft.setTextColor(speedColor, COLOR_PANEL_BG);
   tft.drawString(String(speedRounded), 160, 75);
-
-  // Draw MPH label
-  tft.setTextSize(2);
-  tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
-  tft.drawString("MPH", 160, 108);
 }
+#endif
+
+void recordSpeedDrawTime(uint32_t us) {
+  speedDrawCount++;
+  speedDrawTotalUs += us;
+  if (us > speedDrawMaxUs)
+    speedDrawMaxUs = us;
+
+  if (millis() - lastSpeedPerfLog >= SPEED_PERF_LOG_MS) {
+    lastSpeedPerfLog = millis();
+    Serial.printf("[PERF] speed draw (%s): avg %lu us, max %lu us, n=%lu\n",
+                  USE_DIGIT_ATLAS ? "atlas+DMA" : "text size 8",
+                  speedDrawTotalUs / speedDrawCount, speedDrawMaxUs,
+                  speedDrawCount);
+    speedDrawCount = 0;
+    speedDrawTotalUs = 0;
+    speedDrawMaxUs = 0;
+  }
+}
+
+#define INFO_ROW_H 50
 
 void drawInfoPanels() {
-  int panelY = INFO_PANEL_Y;
+  if (infoPage == INFO_PAGE_GRAPHS) {
+    drawGraphPanel();
+    return;
+  }
+  drawInfoRow();
+  drawSensorPanel();
+}
+
+void drawInfoRow() {
   int panelW = (320 - PANEL_MARGIN * 3) / 2;
-  int panelH = 50;
+  if (infoPage == INFO_PAGE_TRIP)
+    drawTripPanels(INFO_PANEL_Y, panelW, INFO_ROW_H);
+  else
+    drawGpsPanels(INFO_PANEL_Y, panelW, INFO_ROW_H);
+}
 
+void drawGpsPanels(int panelY, int panelW, int panelH) {
   // Left panel - Coordinates
   tft.fillRoundRect(PANEL_MARGIN, panelY, panelW, panelH, 6, COLOR_PANEL_BG);
   tft.setTextDatum(TL_DATUM);
@@ -485,77 +1157,137 @@ void drawInfoPanels() {
 
   // Draw compass visualization
   drawMiniCompass(rightPanelX + panelW - 35, panelY + 30, 18, currentHeading);
+}
 
-  // Bottom panel - Oil Temp, Oil Pressure, and Fuel Level
-  panelY = INFO_PANEL_Y + panelH + PANEL_MARGIN;
-  panelH = 240 - panelY - PANEL_MARGIN;
-  tft.fillRoundRect(PANEL_MARGIN, panelY, 320 - PANEL_MARGIN * 2, panelH, 6,
-                    COLOR_PANEL_BG);
-
+void drawTripPanels(int panelY, int panelW, int panelH) {
+  // Left panel - Distance and average speed
+  tft.fillRoundRect(PANEL_MARGIN, panelY, panelW, panelH, 6, COLOR_PANEL_BG);
   tft.setTextDatum(TL_DATUM);
   tft.setTextSize(1);
   tft.setFreeFont(NULL);
+  tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
+  tft.drawString("TRIP", PANEL_MARGIN + 5, panelY + 5);
 
-  if (oilDataValid) {
-    // Oil Temperature - Left side
-    tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
-    tft.drawString("OIL TEMP", PANEL_MARGIN + 10, panelY + 8);
-
-    tft.setTextSize(2);
-    tft.setTextColor(COLOR_ACCENT, COLOR_PANEL_BG);
-    // Convert Celsius to Fahrenheit for display
-    float tempF = (currentOilTemp * 9.0 / 5.0) + 32.0;
-    String tempStr = String(tempF, 1) + " F";
-    tft.drawString(tempStr, PANEL_MARGIN + 10, panelY + 22);
+  tft.setTextColor(COLOR_TEXT_PRIMARY, COLOR_PANEL_BG);
+  tft.drawString(String(trip.distanceMiles(), 1) + " mi", PANEL_MARGIN + 5,
+                 panelY + 18);
+  tft.drawString("AVG " + String((int)round(trip.averageMph())) + " mph",
+                 PANEL_MARGIN + 5, panelY + 30);
 
-    // Oil Pressure - Middle
-    tft.setTextSize(1);
-    tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
-    tft.drawString("OIL PRESSURE", 120, panelY + 8);
+  // Right panel - Economy, burn rate and range
+  int rightPanelX = PANEL_MARGIN * 2 + panelW;
+  tft.fillRoundRect(rightPanelX, panelY, panelW, panelH, 6, COLOR_PANEL_BG);
+  tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
+  tft.drawString("ECONOMY", rightPanelX + 5, panelY + 5);
 
-    tft.setTextSize(2);
-    // Color code pressure (warning if < 10 PSI, good if >= 10)
-    uint16_t pressureColor =
-        currentOilPressure >= 10.0 ? COLOR_GOOD : COLOR_WARNING;
-    tft.setTextColor(pressureColor, COLOR_PANEL_BG);
-    String pressureStr = String(currentOilPressure, 1) + " PSI";
-    tft.drawString(pressureStr, 120, panelY + 22);
+  tft.setTextColor(COLOR_TEXT_PRIMARY, COLOR_PANEL_BG);
+  float mpg, gph, range;
+  String econ = trip.economyMpg(&mpg) ? String(mpg, 1) + " mpg" : "-- mpg";
+  if (trip.burnRateGph(&gph))
+    econ += " " + String(gph, 1) + " gph";
+  tft.drawString(econ, rightPanelX + 5, panelY + 18);
+
+  if (trip.rangeMiles(&range)) {
+    uint16_t rangeColor = range < 30 ? COLOR_BAD
+                          : range < 60 ? COLOR_WARNING
+                                       : COLOR_TEXT_PRIMARY;
+    tft.setTextColor(rangeColor, COLOR_PANEL_BG);
+    tft.drawString("RANGE " + String((int)range) + " mi", rightPanelX + 5,
+                   panelY + 30);
   } else {
-    // No oil data
-    tft.setTextSize(1);
-    tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
-    tft.drawString("OIL: No Data", PANEL_MARGIN + 10, panelY + 8);
+    tft.drawString("RANGE --", rightPanelX + 5, panelY + 30);
   }
-  
-  // Fuel Level - Right side
-  if (fuelDataValid) {
+}
+
+#define SENSOR_PANEL_Y (INFO_PANEL_Y + INFO_ROW_H + PANEL_MARGIN)
+
+void drawSensorPanel() {
+  // Bottom panel - one slot per registered channel (oil temp, pressure, fuel)
+  int panelH = 240 - SENSOR_PANEL_Y - PANEL_MARGIN;
+  tft.fillRoundRect(PANEL_MARGIN, SENSOR_PANEL_Y, 320 - PANEL_MARGIN * 2,
+                    panelH, 6, COLOR_PANEL_BG);
+  drawSensorSlots(false);
+}
+
+// Draw each slot, or with onlyChanged just those whose reading moved since
+// they were last drawn
+void drawSensorSlots(bool onlyChanged) {
+  static const int slotX[SENSOR_PANEL_SLOTS] = {PANEL_MARGIN + 10, 120, 220};
+  static const int slotW[SENSOR_PANEL_SLOTS] = {100, 95, 90};
+
+  tft.setTextDatum(TL_DATUM);
+  tft.setFreeFont(NULL);
+
+  for (int i = 0; i < SENSOR_PANEL_SLOTS && i < sensors.size(); i++) {
+    if (!takeReading(i) && onlyChanged)
+      continue;
+    const ShownReading &shown = shownReadings[i];
+    int x = slotX[i];
     tft.setTextSize(1);
     tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
-    tft.drawString("FUEL", 220, panelY + 8);
+    if (onlyChanged) // Clear the value and fault rows, the label stays
+      tft.fillRect(x, SENSOR_PANEL_Y + 22, slotW[i], 24, COLOR_PANEL_BG);
+    else
+      tft.drawString(sensors.channel(i).def->label, x, SENSOR_PANEL_Y + 8);
+
+    if (!shown.valid) {
+      tft.drawString("No Data", x, SENSOR_PANEL_Y + 22);
+      continue;
+    }
 
     tft.setTextSize(2);
-    // Color code fuel level (red if low < 15%, yellow if < 25%, green otherwise)
-    uint16_t fuelColor = COLOR_GOOD;
-    if (currentFuelPercent < 15) {
-      fuelColor = COLOR_BAD;  // Red
-    } else if (currentFuelPercent < 25) {
-      fuelColor = COLOR_WARNING;  // Yellow
-    }
-    tft.setTextColor(fuelColor, COLOR_PANEL_BG);
-    String fuelStr = String(currentFuelPercent) + "%";
-    tft.drawString(fuelStr, 220, panelY + 22);
-    
-    // Fuel fault indicator
-    if (fuelFaultStatus & ~FUEL_FAULT_NONE) {
+    tft.setTextColor(channelColor(i), COLOR_PANEL_BG);
+    tft.drawString(shown.text, x, SENSOR_PANEL_Y + 22);
+
+    if (shown.fault) {
       tft.setTextSize(1);
       tft.setTextColor(COLOR_BAD, COLOR_PANEL_BG);
-      tft.drawString("FAULT!", 220, panelY + 38);
+      tft.drawString("FAULT!", x, SENSOR_PANEL_Y + 38);
     }
-  } else {
-    // No fuel data
-    tft.setTextSize(1);
-    tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
-    tft.drawString("FUEL: No Data", 220, panelY + 8);
+  }
+}
+
+// Channel's reading as the screen shows it
+void readingFor(int sensor, ShownReading *reading) {
+  const ChannelState &ch = sensors.channel(sensor);
+  memset(reading, 0, sizeof(*reading));
+  reading->valid = ch.valid;
+  if (!ch.valid)
+    return;
+  reading->fault = ch.faults != 0;
+  reading->level = sensors.level(sensor);
+  sensors.format(sensor, reading->text, sizeof(reading->text));
+}
+
+// Record the channel's reading as drawn; true if it differs from last time
+bool takeReading(int sensor) {
+  ShownReading reading;
+  readingFor(sensor, &reading);
+  bool changed = memcmp(&reading, &shownReadings[sensor], sizeof(reading));
+  shownReadings[sensor] = reading;
+  return changed;
+}
+
+// Whether any channel on screen would draw differently now
+bool readingsChanged() {
+  for (int i = 0; i < SENSOR_COUNT && i < sensors.size(); i++) {
+    ShownReading reading;
+    readingFor(i, &reading);
+    if (memcmp(&reading, &shownReadings[i], sizeof(reading)) != 0)
+      return true;
+  }
+  return false;
+}
+
+// Channel colour for its current severity
+uint16_t channelColor(int sensor) {
+  switch (sensors.level(sensor)) {
+  case CHANNEL_ALARM:
+    return COLOR_BAD;
+  case CHANNEL_WARNING:
+    return COLOR_WARNING;
+  default:
+    return sensors.channel(sensor).def->color;
   }
 }
 
@@ -571,3 +1303,95 @@ void drawMiniCompass(int x, int y, int radius, float heading) {
   tft.drawLine(x, y, x2, y2, COLOR_ACCENT);
   tft.fillCircle(x2, y2, 2, COLOR_ACCENT);
 }
+
+// Full graph page draw - only on page entry, afterwards columns are added
+// one at a time by feedHistory()
+void drawGraphPanel() {
+  tft.fillRoundRect(PANEL_MARGIN, INFO_PANEL_Y, 320 - PANEL_MARGIN * 2,
+                    240 - INFO_PANEL_Y - PANEL_MARGIN, 6, COLOR_PANEL_BG);
+
+  for (int g = 0; g < GRAPH_COUNT; g++) {
+    int plotY = INFO_PANEL_Y + g * GRAPH_STRIP_H + GRAPH_LABEL_H;
+    tft.fillRect(GRAPH_X, plotY, HISTORY_COLUMNS, GRAPH_PLOT_H,
+                 COLOR_BACKGROUND);
+    for (int slot = 0; slot < HISTORY_COLUMNS; slot++) {
+      if (!HistoryRing::isEmpty(graphs[g].ring.slot(slot)))
+        drawGraphColumn(g, slot);
+    }
+    drawGraphCursor(g);
+  }
+  drawGraphLabels(false);
+}
+
+// Each channel's label and value, or with onlyChanged just those whose
+// reading moved since they were last drawn
+void drawGraphLabels(bool onlyChanged) {
+  tft.setTextDatum(TL_DATUM);
+  tft.setTextSize(1);
+  tft.setFreeFont(NULL);
+
+  for (int g = 0; g < GRAPH_COUNT; g++) {
+    int sensor = graphs[g].sensor;
+    if (!takeReading(sensor) && onlyChanged)
+      continue;
+    const ShownReading &shown = shownReadings[sensor];
+    int labelY = INFO_PANEL_Y + g * GRAPH_STRIP_H + 2;
+
+    tft.fillRect(GRAPH_X, labelY, HISTORY_COLUMNS, 8, COLOR_PANEL_BG);
+    tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
+    tft.drawString(sensors.channel(sensor).def->label, GRAPH_X, labelY);
+    tft.setTextColor(graphs[g].color, COLOR_PANEL_BG);
+    tft.drawString(shown.valid ? shown.text : "--", GRAPH_X + 80, labelY);
+
+    tft.setTextDatum(TR_DATUM);
+    tft.setTextColor(COLOR_TEXT_SECONDARY, COLOR_PANEL_BG);
+    tft.drawString("1 HR", GRAPH_X + HISTORY_COLUMNS, labelY);
+    tft.setTextDatum(TL_DATUM);
+  }
+}
+
+// Draw the columns committed since the last frame (normally just one)
+void drawPendingGraphColumns() {
+  int count = min(pendingGraphColumns, HISTORY_COLUMNS);
+  pendingGraphColumns = 0;
+  for (int g = 0; g < GRAPH_COUNT; g++) {
+    int newest = graphs[g].ring.newestSlot();
+    for (int i = count - 1; i >= 0; i--)
+      drawGraphColumn(g, (newest - i + HISTORY_COLUMNS) % HISTORY_COLUMNS);
+    drawGraphCursor(g);
+  }
+}
+
+// Draw one min/max column at its sweep position
+void drawGraphColumn(int g, int slot) {
+  GraphChannel &ch = graphs[g];
+  int plotY = INFO_PANEL_Y + g * GRAPH_STRIP_H + GRAPH_LABEL_H;
+  int x = GRAPH_X + slot;
+
+  tft.drawFastVLine(x, plotY, GRAPH_PLOT_H, COLOR_BACKGROUND);
+
+  const HistoryColumn &col = ch.ring.slot(slot);
+  if (!HistoryRing::isEmpty(col)) {
+    int yMax = graphValueToY(ch, col.max / 10.0f, plotY);
+    int yMin = graphValueToY(ch, col.min / 10.0f, plotY);
+    tft.drawFastVLine(x, yMax, yMin - yMax + 1, ch.color);
+  }
+}
+
+// Sweep cursor marks where the next column lands, just ahead of the newest
+// slot (not the last one drawn - after a wrap those differ). The old cursor
+// needs no erase: it sat on the slot just redrawn.
+void drawGraphCursor(int g) {
+  int plotY = INFO_PANEL_Y + g * GRAPH_STRIP_H + GRAPH_LABEL_H;
+  int next = (graphs[g].ring.newestSlot() + 1) % HISTORY_COLUMNS;
+  tft.drawFastVLine(GRAPH_X + next, plotY, GRAPH_PLOT_H, COLOR_TEXT_SECONDARY);
+}
+
+int graphValueToY(const GraphChannel &ch, float value, int plotY) {
+  float frac = (value - ch.lo) / (ch.hi - ch.lo);
+  if (frac < 0)
+    frac = 0;
+  if (frac > 1)
+    frac = 1;
+  return plotY + GRAPH_PLOT_H - 1 - (int)(frac * (GRAPH_PLOT_H - 1));
+}
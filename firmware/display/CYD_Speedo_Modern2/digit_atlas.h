@@ -0,0 +1,145 @@
+#ifndef DIGIT_ATLAS_H
+#define DIGIT_ATLAS_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// ============================================================================
+// SPEED DIGIT ATLAS
+// ============================================================================
+// Anti-aliased 0-9 glyphs for the big speed readout, rendered once at boot
+// from the same 5x7 GLCD shapes the built-in font uses. Glyphs are stored as
+// 4-bit coverage so one atlas serves every speed colour; drawing a digit is a
+// palette lookup into an RGB565 cell buffer that can be pushed with DMA.
+//
+// No Arduino dependencies so the atlas can be generated and inspected on a
+// host.
+
+#define DIGIT_FONT_COLS 5
+#define DIGIT_FONT_ROWS 7
+#define DIGIT_SCALE 8                              // Same size as setTextSize(8)
+#define DIGIT_W (DIGIT_FONT_COLS * DIGIT_SCALE)    // 40 px glyph
+#define DIGIT_H (DIGIT_FONT_ROWS * DIGIT_SCALE)    // 56 px glyph
+#define DIGIT_CELL_PAD 4                           // Blank columns each side
+#define DIGIT_CELL_W (DIGIT_W + DIGIT_CELL_PAD * 2) // 48 px, matches GLCD pitch
+#define DIGIT_SUPERSAMPLE 4                        // 4x4 samples per pixel
+#define DIGIT_BLANK -1                             // Cell with no glyph
+
+// GLCD font digits, column-major, bit 0 = top row
+static const uint8_t DIGIT_FONT[10][DIGIT_FONT_COLS] = {
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, // 2
+    {0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
+    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
+    {0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
+};
+
+class DigitAtlas {
+public:
+  // Rasterize all ten digits. Each output pixel averages 4x4 samples of a
+  // bilinear-smoothed glyph thresholded at 0.5, which joins diagonal steps
+  // and rounds stroke ends before anti-aliasing the edges.
+  void build() {
+    memset(alpha, 0, sizeof(alpha));
+    const int ss = DIGIT_SUPERSAMPLE;
+    for (int d = 0; d < 10; d++) {
+      for (int y = 0; y < DIGIT_H; y++) {
+        for (int x = 0; x < DIGIT_W; x++) {
+          int hits = 0;
+          for (int sy = 0; sy < ss; sy++) {
+            for (int sx = 0; sx < ss; sx++) {
+              float u = (x + (sx + 0.5f) / ss) / DIGIT_SCALE - 0.5f;
+              float v = (y + (sy + 0.5f) / ss) / DIGIT_SCALE - 0.5f;
+              if (smoothSample(d, u, v) >= 0.5f)
+                hits++;
+            }
+          }
+          // Scale 0..16 hits to 0..15 coverage
+          uint8_t a = (uint8_t)((hits * 15 + (ss * ss) / 2) / (ss * ss));
+          setAlpha(d, x, y, a);
+        }
+      }
+    }
+  }
+
+  uint8_t coverage(int digit, int x, int y) const {
+    const uint8_t b = alpha[digit][y][x >> 1];
+    return (x & 1) ? (b >> 4) : (b & 0x0F);
+  }
+
+  // Fill a DIGIT_CELL_W x DIGIT_H RGB565 buffer with one digit (or blank)
+  // using a 16-entry palette from makePalette().
+  void renderCell(uint16_t *out, int digit, const uint16_t palette[16]) const {
+    for (int y = 0; y < DIGIT_H; y++) {
+      uint16_t *row = out + y * DIGIT_CELL_W;
+      for (int x = 0; x < DIGIT_CELL_PAD; x++) {
+        row[x] = palette[0];
+        row[DIGIT_CELL_W - 1 - x] = palette[0];
+      }
+      uint16_t *glyph = row + DIGIT_CELL_PAD;
+      if (digit < 0) {
+        for (int x = 0; x < DIGIT_W; x++)
+          glyph[x] = palette[0];
+      } else {
+        const uint8_t *src = alpha[digit][y];
+        for (int x = 0; x < DIGIT_W; x += 2) {
+          glyph[x] = palette[src[x >> 1] & 0x0F];
+          glyph[x + 1] = palette[src[x >> 1] >> 4];
+        }
+      }
+    }
+  }
+
+  // Blend bg -> fg in 16 steps. swapBytes produces the big-endian order
+  // the ILI9341 expects so the buffer can go straight to pushImageDMA().
+  static void makePalette(uint16_t fg, uint16_t bg, bool swapBytes,
+                          uint16_t palette[16]) {
+    const int fr = (fg >> 11) & 0x1F, fgn = (fg >> 5) & 0x3F, fb = fg & 0x1F;
+    const int br = (bg >> 11) & 0x1F, bgn = (bg >> 5) & 0x3F, bb = bg & 0x1F;
+    for (int a = 0; a < 16; a++) {
+      int r = br + ((fr - br) * a + 7) / 15;
+      int g = bgn + ((fgn - bgn) * a + 7) / 15;
+      int b = bb + ((fb - bb) * a + 7) / 15;
+      uint16_t c = (uint16_t)((r << 11) | (g << 5) | b);
+      palette[a] = swapBytes ? (uint16_t)((c >> 8) | (c << 8)) : c;
+    }
+  }
+
+private:
+  static float fontPixel(int d, int col, int row) {
+    if (col < 0 || col >= DIGIT_FONT_COLS || row < 0 || row >= DIGIT_FONT_ROWS)
+      return 0.0f;
+    return (DIGIT_FONT[d][col] >> row) & 1 ? 1.0f : 0.0f;
+  }
+
+  // Bilinear interpolation of the font bitmap at font-pixel coordinates
+  static float smoothSample(int d, float u, float v) {
+    int c0 = (int)floorf(u);
+    int r0 = (int)floorf(v);
+    float fu = u - c0;
+    float fv = v - r0;
+    float top = fontPixel(d, c0, r0) * (1 - fu) + fontPixel(d, c0 + 1, r0) * fu;
+    float bot =
+        fontPixel(d, c0, r0 + 1) * (1 - fu) + fontPixel(d, c0 + 1, r0 + 1) * fu;
+    return top * (1 - fv) + bot * fv;
+  }
+
+  void setAlpha(int d, int x, int y, uint8_t a) {
+    uint8_t &b = alpha[d][y][x >> 1];
+    if (x & 1)
+      b = (b & 0x0F) | (a << 4);
+    else
+      b = (b & 0xF0) | a;
+  }
+
+  // 4-bit coverage, two pixels per byte: 10 x 56 x 20 = 11.2 KB
+  uint8_t alpha[10][DIGIT_H][DIGIT_W / 2];
+};
+
+#endif // DIGIT_ATLAS_H
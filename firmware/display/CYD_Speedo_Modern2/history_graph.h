@@ -0,0 +1,117 @@
+#ifndef HISTORY_GRAPH_H
+#define HISTORY_GRAPH_H
+
+#include <stdint.h>
+
+// ============================================================================
+// HISTORY GRAPH DATA
+// ============================================================================
+// Fixed-size ring of min/max pairs, one per graph pixel column. Samples are
+// folded into the open column until its time slot ends, so an hour of data
+// fits a 300-pixel graph in 1.2 KB per channel regardless of sample rate.
+//
+// Values are stored as int16 tenths to halve memory. No Arduino dependencies.
+
+#define HISTORY_COLUMNS 300          // Graph width in pixels
+#define HISTORY_COLUMN_MS 12000      // 300 columns x 12 s = 1 hour
+#define HISTORY_EMPTY_MIN INT16_MAX  // Marks a column with no samples
+#define HISTORY_EMPTY_MAX INT16_MIN
+
+typedef struct {
+  int16_t min; // Tenths of the channel unit
+  int16_t max;
+} HistoryColumn;
+
+class HistoryRing {
+public:
+  HistoryRing() { clear(); }
+
+  void clear() {
+    for (int i = 0; i < HISTORY_COLUMNS; i++) {
+      columns[i].min = HISTORY_EMPTY_MIN;
+      columns[i].max = HISTORY_EMPTY_MAX;
+    }
+    head = 0;
+    filled = 0;
+    open.min = HISTORY_EMPTY_MIN;
+    open.max = HISTORY_EMPTY_MAX;
+  }
+
+  // Fold a sample into the open column. O(1).
+  void addSample(float value) {
+    float scaled = value * 10.0f;
+    if (scaled > 32000.0f)
+      scaled = 32000.0f;
+    if (scaled < -32000.0f)
+      scaled = -32000.0f;
+    int16_t v = (int16_t)scaled;
+    if (v < open.min)
+      open.min = v;
+    if (v > open.max)
+      open.max = v;
+  }
+
+  // Close the open column into the ring and start a new one. Columns with no
+  // samples are kept as gaps so the time axis stays linear.
+  void commitColumn() {
+    columns[head] = open;
+    head = (head + 1) % HISTORY_COLUMNS;
+    if (filled < HISTORY_COLUMNS)
+      filled++;
+    open.min = HISTORY_EMPTY_MIN;
+    open.max = HISTORY_EMPTY_MAX;
+  }
+
+  // Number of committed columns (up to HISTORY_COLUMNS)
+  int size() const { return filled; }
+
+  // Ring slot of the newest committed column, which is also its sweep
+  // position on screen
+  int newestSlot() const {
+    return (head - 1 + HISTORY_COLUMNS) % HISTORY_COLUMNS;
+  }
+
+  const HistoryColumn &slot(int i) const { return columns[i]; }
+
+  static bool isEmpty(const HistoryColumn &c) { return c.min > c.max; }
+
+private:
+  HistoryColumn columns[HISTORY_COLUMNS];
+  HistoryColumn open;
+  int head;
+  int filled;
+};
+
+// ============================================================================
+// COLUMN CLOCK
+// ============================================================================
+// Shared time base so every channel advances its column together.
+class HistoryClock {
+public:
+  HistoryClock() : columnStart(0), started(false) {}
+
+  // Returns the number of column slots that have elapsed since the last
+  // call (usually 0 or 1; more after a long stall).
+  int tick(uint32_t nowMs) {
+    if (!started) {
+      columnStart = nowMs;
+      started = true;
+      return 0;
+    }
+    int elapsed = 0;
+    while (nowMs - columnStart >= HISTORY_COLUMN_MS &&
+           elapsed < HISTORY_COLUMNS) {
+      columnStart += HISTORY_COLUMN_MS;
+      elapsed++;
+    }
+    if (elapsed == HISTORY_COLUMNS)
+      columnStart = nowMs;
+    return elapsed;
+  }
+
+private:
+  uint32_t columnStart;
+  bool started;
+};
+
+#endif // HISTORY_GRAPH_H
@@ -0,0 +1,335 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ============================================================================
+// SENSOR REGISTRY
+// ============================================================================
+// Fixed-capacity table of sensor channels keyed by (sender MAC, channel id).
+// A decoder registered per message type turns a packet into channel
+// readings; each channel carries its own formatter, classifier and staleness
+// timeout. Adding a sensor means registering a decoder and its channels, not
+// editing the receive callback or the panels.
+//
+// Senders that run their own alarm rules pass the result in the reading:
+// level() is the worse of the channel's classifier and the sender's alarm.
+//
+// When frames were lost, decoders also emit the older readings the packet
+// carries, flagged recovered. Those feed the graph span and the recovered
+// count but never overwrite the current value.
+//
+// Readings may also carry the range of every sample the sender took since
+// its last packet. It widens the graph span, so a spike between packets
+// shows even though only the latest value is displayed.
+//
+// Lookups go through a small open-addressed hash, so ingesting a packet is
+// O(1) in the number of registered channels. No Arduino dependencies.
+
+#define REGISTRY_MAX_CHANNELS 48  // 20 ESP-NOW peers with a few channels each
+#define REGISTRY_HASH_SIZE 128    // Power of two, at least 2x channels
+#define REGISTRY_MAX_READINGS 8   // Readings one packet may produce
+#define REGISTRY_MAX_DECODERS 8
+
+// Decoded value for one channel
+typedef struct {
+  uint8_t channelId;
+  float value;
+  uint8_t faults;    // Sender fault flags for this channel, 0 = OK
+  uint32_t sampleMs; // When it was measured, in display millis()
+  bool synced;       // False if sampleMs is on the sender's own clock
+  bool recovered;    // From a lost frame, rebuilt out of carried history
+  uint8_t severity;  // Worst alarm the sender raised (CHANNEL_*)
+  uint16_t alarms;   // Sender's alarm flags for this channel, 0 = none
+  uint8_t windowSamples; // Samples behind windowMin/Max, 0 = none sent
+  float windowMin;
+  float windowMax;
+  bool windowFault; // A sample since the sender's last packet was faulted
+} ChannelReading;
+
+// Sensor-to-display latency of synced readings since the last takeLatency()
+typedef struct {
+  int32_t totalMs;
+  int32_t maxMs;
+  uint32_t count;
+} LatencyStats;
+
+// Severity a classifier assigns to a value
+#define CHANNEL_NORMAL 0
+#define CHANNEL_WARNING 1
+#define CHANNEL_ALARM 2
+
+// Turns a packet into readings, plus recovered readings for up to missed
+// frames lost just before it. Returns the number written to out, or -1 if
+// the packet is malformed.
+typedef int (*PacketDecoder)(const uint8_t *data, size_t len, uint8_t missed,
+                             ChannelReading *out, int maxOut);
+// Writes the display text for a value ("145.4 F")
+typedef void (*ChannelFormatter)(float value, char *out, size_t outLen);
+// Returns CHANNEL_NORMAL/WARNING/ALARM for a value
+typedef uint8_t (*ChannelClassifier)(float value, uint8_t faults);
+
+typedef struct {
+  uint8_t channelId;
+  const char *label; // Panel caption ("OIL TEMP")
+  const char *unit;  // Axis unit for graphs ("F")
+  uint16_t color;    // RGB565 colour for CHANNEL_NORMAL values
+  ChannelFormatter format;
+  ChannelClassifier classify; // NULL = always CHANNEL_NORMAL
+  uint32_t timeoutMs;         // Stale after this long without a reading
+} ChannelDef;
+
+typedef struct {
+  const ChannelDef *def;
+  uint8_t mac[6];
+  bool bound; // False until a sender is seen (wildcard registration)
+  bool valid; // Has a reading younger than def->timeoutMs
+  float value;
+  uint8_t faults;
+  uint8_t severity;          // Sender's alarms, see ChannelReading
+  uint16_t alarms;
+  uint32_t lastUpdateMs;     // Arrival time (drives staleness)
+  uint32_t sampleMs;         // Measurement time, arrival time if unsynced
+  volatile uint32_t updates; // Bumped per reading; consumers track changes
+  LatencyStats latency;
+  float spanMin; // Fault-free readings since the last takeSpan()
+  float spanMax;
+  uint32_t spanCount;
+  uint32_t recovered; // Readings rebuilt from carried history
+  uint32_t transientFaults; // Faults that cleared before a packet was sent
+} ChannelState;
+
+class SensorRegistry {
+public:
+  SensorRegistry() { clear(); }
+
+  void clear() {
+    count = 0;
+    decoderCount = 0;
+    memset(hash, -1, sizeof(hash));
+    memset(decoderIndex, -1, sizeof(decoderIndex));
+    memset(unbound, -1, sizeof(unbound));
+    minTimeoutMs = 0;
+    nextCheckMs = 0;
+  }
+
+  bool addDecoder(uint8_t msgType, PacketDecoder decoder) {
+    if (decoderCount >= REGISTRY_MAX_DECODERS || decoderIndex[msgType] >= 0)
+      return false;
+    decoders[decoderCount] = decoder;
+    decoderIndex[msgType] = decoderCount++;
+    return true;
+  }
+
+  // Register a channel. With mac == NULL the channel binds to the first
+  // sender that reports its id. Returns a handle for channel(), or -1 if the
+  // table is full or the channel is already registered.
+  int addChannel(const ChannelDef *def, const uint8_t *mac = NULL) {
+    if (count >= REGISTRY_MAX_CHANNELS)
+      return -1;
+    if (mac ? find(mac, def->channelId) >= 0 : unbound[def->channelId] >= 0)
+      return -1;
+
+    ChannelState &ch = channels[count];
+    memset(&ch, 0, sizeof(ch));
+    ch.def = def;
+    if (mac) {
+      memcpy(ch.mac, mac, 6);
+      ch.bound = true;
+      insert(mac, def->channelId, count);
+    } else {
+      unbound[def->channelId] = count;
+    }
+    if (minTimeoutMs == 0 || def->timeoutMs < minTimeoutMs)
+      minTimeoutMs = def->timeoutMs;
+    return count++;
+  }
+
+  // Decode one packet from mac and store its readings. missed is the number
+  // of frames from mac lost just before this one. Safe to call from the
+  // radio callback. Returns the number of channels updated, or -1 if there
+  // is no decoder for the type or the decoder rejected the packet.
+  int ingest(const uint8_t *mac, uint8_t msgType, const uint8_t *data,
+             size_t len, uint32_t nowMs, uint8_t missed = 0) {
+    const int d = decoderIndex[msgType];
+    if (d < 0)
+      return -1;
+    ChannelReading readings[REGISTRY_MAX_READINGS];
+    const int n =
+        decoders[d](data, len, missed, readings, REGISTRY_MAX_READINGS);
+    if (n < 0)
+      return -1;
+
+    int updated = 0;
+    for (int i = 0; i < n; i++) {
+      int h = find(mac, readings[i].channelId);
+      if (h < 0)
+        h = bindUnbound(mac, readings[i].channelId);
+      if (h < 0)
+        continue; // Nobody registered this channel
+      ChannelState &ch = channels[h];
+      if (readings[i].faults == 0)
+        addToSpan(ch, readings[i].value);
+      if (readings[i].windowSamples > 0) {
+        addToSpan(ch, readings[i].windowMin);
+        addToSpan(ch, readings[i].windowMax);
+      }
+      if (readings[i].windowFault && readings[i].faults == 0)
+        ch.transientFaults++;
+      if (readings[i].recovered) {
+        ch.recovered++;
+        continue;
+      }
+      ch.value = readings[i].value;
+      ch.faults = readings[i].faults;
+      ch.severity = readings[i].severity;
+      ch.alarms = readings[i].alarms;
+      ch.lastUpdateMs = nowMs;
+      ch.sampleMs = readings[i].synced ? readings[i].sampleMs : nowMs;
+      if (readings[i].synced) {
+        const int32_t latencyMs = (int32_t)(nowMs - readings[i].sampleMs);
+        ch.latency.totalMs += latencyMs;
+        if (ch.latency.count == 0 || latencyMs > ch.latency.maxMs)
+          ch.latency.maxMs = latencyMs;
+        ch.latency.count++;
+      }
+      ch.valid = true;
+      ch.updates++;
+      updated++;
+    }
+    return updated;
+  }
+
+  // Invalidate channels whose timeout has passed. Only scans when the
+  // earliest possible deadline is due, so calling it every loop is cheap.
+  // Returns true if any channel went stale.
+  bool expireStale(uint32_t nowMs) {
+    if (count == 0 || (int32_t)(nowMs - nextCheckMs) < 0)
+      return false;
+
+    // A channel that turns valid after this scan can't expire sooner than
+    // minTimeoutMs from now, so that bounds the next check without the
+    // radio callback having to touch the schedule.
+    bool expired = false;
+    uint32_t next = nowMs + minTimeoutMs;
+    for (int i = 0; i < count; i++) {
+      ChannelState &ch = channels[i];
+      if (!ch.valid)
+        continue;
+      const uint32_t deadline = ch.lastUpdateMs + ch.def->timeoutMs;
+      if ((int32_t)(nowMs - deadline) > 0) {
+        ch.valid = false;
+        expired = true;
+      } else if ((int32_t)(deadline - next) < 0) {
+        next = deadline;
+      }
+    }
+    nextCheckMs = next;
+    return expired;
+  }
+
+  int size() const { return count; }
+  const ChannelState &channel(int handle) const { return channels[handle]; }
+
+  // Colour-independent severity of a channel's current value: the worse of
+  // its classifier and the sender's alarm
+  uint8_t level(int handle) const {
+    const ChannelState &ch = channels[handle];
+    const uint8_t own =
+        ch.def->classify ? ch.def->classify(ch.value, ch.faults)
+                         : CHANNEL_NORMAL;
+    return own > ch.severity ? own : ch.severity;
+  }
+
+  // Copy and clear a channel's latency stats. A reading that lands during
+  // the copy may be lost, which is fine for a periodic log.
+  LatencyStats takeLatency(int handle) {
+    LatencyStats stats = channels[handle].latency;
+    memset(&channels[handle].latency, 0, sizeof(LatencyStats));
+    return stats;
+  }
+
+  // Range of a channel's fault-free readings, recovered ones included, since
+  // the last call. Returns false if there were none.
+  bool takeSpan(int handle, float *lo, float *hi) {
+    ChannelState &ch = channels[handle];
+    if (ch.spanCount == 0)
+      return false;
+    *lo = ch.spanMin;
+    *hi = ch.spanMax;
+    ch.spanCount = 0;
+    return true;
+  }
+
+  void format(int handle, char *out, size_t outLen) const {
+    const ChannelState &ch = channels[handle];
+    ch.def->format(ch.value, out, outLen);
+  }
+
+private:
+  static uint32_t hashKey(const uint8_t *mac, uint8_t channelId) {
+    uint32_t h = 2166136261u; // FNV-1a
+    for (int i = 0; i < 6; i++)
+      h = (h ^ mac[i]) * 16777619u;
+    h = (h ^ channelId) * 16777619u;
+    return h;
+  }
+
+  static void addToSpan(ChannelState &ch, float value) {
+    if (!(value == value))
+      return; // NaN
+    if (ch.spanCount == 0 || value < ch.spanMin)
+      ch.spanMin = value;
+    if (ch.spanCount == 0 || value > ch.spanMax)
+      ch.spanMax = value;
+    ch.spanCount++;
+  }
+
+  int find(const uint8_t *mac, uint8_t channelId) const {
+    uint32_t slot = hashKey(mac, channelId) & (REGISTRY_HASH_SIZE - 1);
+    for (int probe = 0; probe < REGISTRY_HASH_SIZE; probe++) {
+      const int h = hash[slot];
+      if (h < 0)
+        return -1;
+      const ChannelState &ch = channels[h];
+      if (ch.def->channelId == channelId && memcmp(ch.mac, mac, 6) == 0)
+        return h;
+      slot = (slot + 1) & (REGISTRY_HASH_SIZE - 1);
+    }
+    return -1;
+  }
+
+  void insert(const uint8_t *mac, uint8_t channelId, int handle) {
+    uint32_t slot = hashKey(mac, channelId) & (REGISTRY_HASH_SIZE - 1);
+    while (hash[slot] >= 0)
+      slot = (slot + 1) & (REGISTRY_HASH_SIZE - 1);
+    hash[slot] = handle;
+  }
+
+  // Claim a wildcard channel for the first sender that reports it
+  int bindUnbound(const uint8_t *mac, uint8_t channelId) {
+    const int h = unbound[channelId];
+    if (h < 0)
+      return -1;
+    ChannelState &ch = channels[h];
+    memcpy(ch.mac, mac, 6);
+    ch.bound = true;
+    unbound[channelId] = -1;
+    insert(mac, channelId, h);
+    return h;
+  }
+
+  ChannelState channels[REGISTRY_MAX_CHANNELS];
+  int count;
+  int8_t hash[REGISTRY_HASH_SIZE];  // Channel handle, -1 = empty
+  int8_t unbound[256];              // Wildcard handle by channel id
+  PacketDecoder decoders[REGISTRY_MAX_DECODERS];
+  int8_t decoderIndex[256];         // By message type
+  int decoderCount;
+  uint32_t minTimeoutMs;
+  uint32_t nextCheckMs;
+};
+
+#endif // SENSOR_REGISTRY_H
@@ -0,0 +1,380 @@
+#ifndef TRIP_COMPUTER_H
+#define TRIP_COMPUTER_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// TRIP COMPUTER
+// ============================================================================
+// Incremental trip engine for the CYD. Integrates distance from successive
+// GPS fixes and fits fuel percent against distance/time to estimate economy,
+// burn rate and range to empty.
+//
+// Plain C++ with no Arduino dependencies so the math can be replayed on a
+// host against simulated drives (host/trip_replay). All updates are O(1).
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+#define TRIP_TANK_CAPACITY_GAL 10.6f  // 1972 VW Superbeetle (40 L)
+#define TRIP_EARTH_RADIUS_MI 3958.8
+#define TRIP_MIN_MOVING_MPH 2.0f      // Below this, fixes are GPS drift
+#define TRIP_MAX_PLAUSIBLE_MPH 150.0f // Reject position jumps faster than this
+#define TRIP_MAX_FIX_GAP_MS 10000     // Don't bridge gaps longer than this
+#define TRIP_FIT_WINDOW 64            // Fuel samples kept in the regression
+#define TRIP_FIT_STEP_MI 0.1f         // Add a fuel sample every 0.1 mile
+#define TRIP_FIT_MIN_SAMPLES 8        // Samples needed before reporting
+#define TRIP_FIT_MIN_SPAN_MI 2.0f     // Distance needed before reporting
+#define TRIP_FIT_OUTLIER_PCT 6.0f     // Residual (fuel %) that rejects a sample
+#define TRIP_REFUEL_JUMP_PCT 10.0f    // Fuel rise that means the tank was filled
+#define TRIP_FIT_RESET_REJECTS 5      // Outliers on one side that restart the fit
+
+// ============================================================================
+// ROLLING LINEAR FIT
+// ============================================================================
+// Least-squares line over a fixed-size ring of (x, y) points. Running sums
+// make push/evict O(1). x is stored relative to the first point after a reset
+// to keep the sums well conditioned.
+class RollingFit {
+public:
+  RollingFit() { reset(); }
+
+  void reset() {
+    count = 0;
+    head = 0;
+    sx = sy = sxx = sxy = 0.0;
+    originSet = false;
+    origin = 0.0;
+  }
+
+  void push(double x, double y) {
+    if (!originSet) {
+      origin = x;
+      originSet = true;
+    }
+    x -= origin;
+
+    if (count == TRIP_FIT_WINDOW) {
+      // Evict oldest point
+      const double ox = xs[head];
+      const double oy = ys[head];
+      sx -= ox;
+      sy -= oy;
+      sxx -= ox * ox;
+      sxy -= ox * oy;
+      count--;
+    }
+    xs[head] = x;
+    ys[head] = y;
+    head = (head + 1) % TRIP_FIT_WINDOW;
+    count++;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+  }
+
+  int size() const { return count; }
+
+  // Span of x covered by the window
+  double span() const {
+    if (count < 2)
+      return 0.0;
+    const int oldest = (head - count + TRIP_FIT_WINDOW) % TRIP_FIT_WINDOW;
+    const int newest = (head - 1 + TRIP_FIT_WINDOW) % TRIP_FIT_WINDOW;
+    return xs[newest] - xs[oldest];
+  }
+
+  // Returns false if the fit is degenerate (fewer than 2 distinct x values)
+  bool solve(double *slope, double *intercept) const {
+    if (count < 2)
+      return false;
+    const double n = count;
+    const double den = n * sxx - sx * sx;
+    if (fabs(den) < 1e-12)
+      return false;
+    *slope = (n * sxy - sx * sy) / den;
+    *intercept = (sy - *slope * sx) / n;
+    return true;
+  }
+
+  // Predicted y at absolute x (caller's coordinate system)
+  bool predict(double x, double *y) const {
+    double m, b;
+    if (!solve(&m, &b))
+      return false;
+    *y = m * (x - origin) + b;
+    return true;
+  }
+
+private:
+  double xs[TRIP_FIT_WINDOW];
+  double ys[TRIP_FIT_WINDOW];
+  int count;
+  int head;
+  double sx, sy, sxx, sxy;
+  bool originSet;
+  double origin;
+};
+
+// ============================================================================
+// PERSISTENT STATE
+// ============================================================================
+// Saved as a single blob so a power cycle resumes the trip. Bump
+// TRIP_STATE_VERSION whenever the layout changes.
+#define TRIP_STATE_VERSION 1
+
+typedef struct __attribute__((packed)) {
+  uint8_t version;      // TRIP_STATE_VERSION
+  float distanceMi;     // Distance since trip reset
+  uint32_t movingSec;   // Time spent above TRIP_MIN_MOVING_MPH
+  float fuelUsedGal;    // Fuel burned since trip reset (from fit)
+  float lastMpg;        // Last good economy estimate, seeds the next boot
+} TripState;
+
+// ============================================================================
+// TRIP COMPUTER
+// ============================================================================
+class TripComputer {
+public:
+  TripComputer() { reset(); }
+
+  void reset() {
+    memset(&state, 0, sizeof(state));
+    state.version = TRIP_STATE_VERSION;
+    haveFix = false;
+    lastFixMs = 0;
+    movingMsAccum = 0;
+    restartFit();
+    fuelHistCount = 0;
+    lastFuelPct = -1.0f;
+    dirty = true;
+  }
+
+  // Restore from persisted state. Returns false on version mismatch.
+  bool restore(const TripState &saved) {
+    if (saved.version != TRIP_STATE_VERSION)
+      return false;
+    reset();
+    state = saved;
+    dirty = false;
+    return true;
+  }
+
+  const TripState &snapshot() const { return state; }
+
+  // True if state changed since the last clearDirty()
+  bool isDirty() const { return dirty; }
+  void clearDirty() { dirty = false; }
+
+  // Feed one GPS fix. O(1).
+  void addFix(double lat, double lon, float speedMph, bool hasFix,
+              uint32_t nowMs) {
+    if (!hasFix || isnan(lat) || isnan(lon)) {
+      haveFix = false;
+      return;
+    }
+
+    if (haveFix) {
+      const uint32_t dtMs = nowMs - lastFixMs;
+      if (dtMs > 0 && dtMs <= TRIP_MAX_FIX_GAP_MS &&
+          speedMph >= TRIP_MIN_MOVING_MPH) {
+        const double d = distanceMi(lastLat, lastLon, lat, lon);
+        const double hours = dtMs / 3600000.0;
+        if (d / hours <= TRIP_MAX_PLAUSIBLE_MPH) {
+          state.distanceMi += (float)d;
+          movingMsAccum += dtMs;
+          if (movingMsAccum >= 1000) {
+            state.movingSec += movingMsAccum / 1000;
+            movingMsAccum %= 1000;
+          }
+          dirty = true;
+        }
+      }
+    }
+
+    lastLat = lat;
+    lastLon = lon;
+    lastFixMs = nowMs;
+    haveFix = true;
+  }
+
+  // Feed one fuel reading (percent). A reading the sender flagged as a
+  // wiring fault (open or shorted sender) is a clamped 0% or 100%, not a
+  // level: it is dropped, and the median starts again after it. O(1).
+  void addFuel(float percent, uint32_t nowMs, bool faulted) {
+    if (faulted) {
+      fuelHistCount = 0;
+      return;
+    }
+    // Median of the last three readings knocks out single slosh spikes
+    fuelHist[fuelHistCount % 3] = percent;
+    fuelHistCount++;
+    if (fuelHistCount < 3)
+      return;
+    const float pct = median3(fuelHist[0], fuelHist[1], fuelHist[2]);
+
+    // Refuel: the tank level jumped up, start a fresh fit. Its first sample
+    // waits for the next step, when the level has settled.
+    if (lastFuelPct >= 0 && pct - lastFuelPct >= TRIP_REFUEL_JUMP_PCT) {
+      restartFit();
+      lastFitDistance = state.distanceMi;
+    }
+    lastFuelPct = pct;
+
+    // Sample by distance so a stationary car doesn't flood the window
+    const double dist = state.distanceMi;
+    if (lastFitDistance >= 0 && dist - lastFitDistance < TRIP_FIT_STEP_MI)
+      return;
+
+    // Reject readings far from the current fit (slosh on corners/hills).
+    // Slosh lands on both sides of the line; a run on one side means the
+    // level really moved (a top-up, or a fill too slow to look like a jump),
+    // so the old line is dropped instead of freezing the fit. Outliers are
+    // counted once per sample step, so the run spans half a mile.
+    double predicted;
+    if (distFit.size() >= TRIP_FIT_MIN_SAMPLES &&
+        distFit.predict(dist, &predicted) &&
+        fabs(pct - predicted) > TRIP_FIT_OUTLIER_PCT) {
+      const int side = pct > predicted ? 1 : -1;
+      rejectRun = rejectRun * side > 0 ? rejectRun + side : side;
+      if (abs(rejectRun) < TRIP_FIT_RESET_REJECTS) {
+        lastFitDistance = dist;
+        return;
+      }
+      restartFit();
+    }
+    rejectRun = 0;
+
+    distFit.push(dist, pct);
+    timeFit.push(nowMs / 3600000.0, pct);
+    lastFitDistance = dist;
+
+    // Fuel burned is the fitted economy over the miles driven, not the
+    // raw readings. Until the window fills, a fit's early estimates are
+    // rough, so all its miles are re-costed at the latest one; after that
+    // each step's miles are added at the economy of the time.
+    if (fitStartDistance < 0) {
+      fitStartDistance = dist;
+      fitStartGal = state.fuelUsedGal;
+    }
+    float mpg;
+    if (economyMpg(&mpg)) {
+      if (distFit.size() < TRIP_FIT_WINDOW || fitUsedDistance < 0)
+        state.fuelUsedGal =
+            fitStartGal + (float)((dist - fitStartDistance) / mpg);
+      else
+        state.fuelUsedGal += (float)((dist - fitUsedDistance) / mpg);
+      fitUsedDistance = dist;
+      state.lastMpg = mpg;
+    }
+    dirty = true;
+  }
+
+  float distanceMiles() const { return state.distanceMi; }
+  float fuelUsedGal() const { return state.fuelUsedGal; }
+
+  // Average moving speed over the trip
+  float averageMph() const {
+    if (state.movingSec == 0)
+      return 0.0f;
+    return state.distanceMi / (state.movingSec / 3600.0f);
+  }
+
+  // Miles per gallon from the distance fit. Returns false until enough
+  // data has been collected.
+  bool economyMpg(float *mpg) const {
+    if (distFit.size() < TRIP_FIT_MIN_SAMPLES ||
+        distFit.span() < TRIP_FIT_MIN_SPAN_MI)
+      return false;
+    double slope, intercept;
+    if (!distFit.solve(&slope, &intercept) || slope >= 0)
+      return false;
+    const double galPerMile = -slope / 100.0 * TRIP_TANK_CAPACITY_GAL;
+    *mpg = (float)(1.0 / galPerMile);
+    return true;
+  }
+
+  // Gallons per hour from the time fit
+  bool burnRateGph(float *gph) const {
+    if (timeFit.size() < TRIP_FIT_MIN_SAMPLES)
+      return false;
+    double slope, intercept;
+    if (!timeFit.solve(&slope, &intercept) || slope >= 0)
+      return false;
+    *gph = (float)(-slope / 100.0 * TRIP_TANK_CAPACITY_GAL);
+    return true;
+  }
+
+  // Miles to empty using the live fit, falling back to the persisted
+  // economy estimate after a power cycle.
+  bool rangeMiles(float *miles) const {
+    if (lastFuelPct < 0)
+      return false;
+    float mpg;
+    if (!economyMpg(&mpg)) {
+      if (state.lastMpg <= 0)
+        return false;
+      mpg = state.lastMpg;
+    }
+    *miles = lastFuelPct / 100.0f * TRIP_TANK_CAPACITY_GAL * mpg;
+    return true;
+  }
+
+  // Equirectangular approximation: accurate to well under 0.1% for the
+  // sub-kilometre steps between 1 Hz fixes, and much cheaper than haversine.
+  static double distanceMi(double lat1, double lon1, double lat2,
+                           double lon2) {
+    const double toRad = M_PI / 180.0;
+    const double meanLat = (lat1 + lat2) * 0.5 * toRad;
+    const double dx = (lon2 - lon1) * toRad * cos(meanLat);
+    const double dy = (lat2 - lat1) * toRad;
+    return sqrt(dx * dx + dy * dy) * TRIP_EARTH_RADIUS_MI;
+  }
+
+private:
+  void restartFit() {
+    distFit.reset();
+    timeFit.reset();
+    lastFitDistance = -1.0;
+    fitStartDistance = -1.0;
+    fitUsedDistance = -1.0;
+    rejectRun = 0;
+  }
+
+  static float median3(float a, float b, float c) {
+    if (a > b) {
+      float t = a;
+      a = b;
+      b = t;
+    }
+    if (b > c)
+      b = c;
+    return a > b ? a : b;
+  }
+
+  TripState state;
+  bool dirty;
+
+  bool haveFix;
+  double lastLat, lastLon;
+  uint32_t lastFixMs;
+  uint32_t movingMsAccum;
+
+  RollingFit distFit; // fuel % vs miles
+  RollingFit timeFit; // fuel % vs hours
+  double lastFitDistance;
+  double fitStartDistance; // First sample of the fit, -1 = none yet
+  float fitStartGal;       // Fuel used when the fit started
+  double fitUsedDistance;  // Where fuel used was last counted, -1 = not yet
+  int rejectRun; // Consecutive outliers, + above the fit, - below
+
+  float fuelHist[3];
+  uint32_t fuelHistCount;
+  float lastFuelPct;
+};
+
+#endif // TRIP_COMPUTER_H
@@ -0,0 +1,176 @@
+#ifndef ALARM_ENGINE_H
+#define ALARM_ENGINE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// ============================================================================
+// ALARM ENGINE
+// ============================================================================
+// A sender's alarm rules, evaluated on every sample so an alarm leaves in the
+// packet built from the sample that raised it. Rules are a fixed table and
+// each keeps a few words of state, so evaluate() costs the same per rule
+// however long it has been running.
+//
+//   ALARM_ABOVE    value over limit
+//   ALARM_BELOW    value under limit
+//   ALARM_RISING   value climbing faster than limit per second
+//   ALARM_FALLING  value dropping faster than limit per second
+//
+// Rates are smoothed over rateMs with an exponential average. A raised alarm
+// clears once the value (or rate) is back hysteresis inside the limit, so a
+// reading sitting on the limit doesn't flicker.
+//
+// Debounce: the condition must hold for raiseMs before the alarm is raised,
+// and be gone for clearMs before it clears.
+//
+// A rule may be gated on another input, such as road speed or RPM. While the
+// gate input is outside [gateMin, gateMax] the condition counts as not met,
+// so low oil pressure can be ignored at idle. A gate input with no reading
+// counts as outside.
+//
+// Inputs are floats indexed by AlarmRule::input. NaN means no reading (the
+// sensor is faulted or not fitted) and holds the rule where it is: a broken
+// sender is reported as a fault, not as an alarm or an all-clear.
+//
+// No Arduino dependencies.
+
+#define ALARM_MAX_RULES 16
+#define ALARM_NO_GATE 0xFF
+
+typedef enum {
+  ALARM_ABOVE,
+  ALARM_BELOW,
+  ALARM_RISING,
+  ALARM_FALLING,
+} AlarmKind;
+
+typedef struct {
+  uint16_t bit;       // Set in the active mask while raised
+  uint8_t input;      // Index into evaluate()'s inputs
+  uint8_t kind;       // AlarmKind
+  float limit;        // Value, or rate per second for RISING/FALLING
+  float hysteresis;   // How far back inside the limit before it clears
+  uint32_t raiseMs;   // Condition held this long before raising
+  uint32_t clearMs;   // ...and gone this long before clearing
+  uint32_t rateMs;    // RISING/FALLING smoothing time constant
+  uint8_t gate;       // Input the rule is conditioned on, or ALARM_NO_GATE
+  float gateMin;
+  float gateMax;
+} AlarmRule;
+
+typedef struct {
+  bool active;
+  bool changing;      // Condition has differed from active since sinceMs
+  uint32_t sinceMs;
+  uint32_t onsetMs;   // When the condition that raised it first held
+  bool haveLast;      // RISING/FALLING: lastValue/lastMs are set
+  float lastValue;
+  uint32_t lastMs;
+  float rate;         // Smoothed, per second
+} AlarmState;
+
+class AlarmEngine {
+public:
+  AlarmEngine() { clear(); }
+
+  void clear() {
+    count = 0;
+    mask = 0;
+    changedMask = 0;
+    memset(states, 0, sizeof(states));
+  }
+
+  // Set rule index, keeping its state so a limit changed from the console
+  // doesn't drop or re-raise an alarm. index == size() appends. Returns
+  // false if the table is full or index is past the end.
+  bool set(int index, const AlarmRule &rule) {
+    if (index < 0 || index > count || index >= ALARM_MAX_RULES)
+      return false;
+    if (index == count)
+      memset(&states[count++], 0, sizeof(AlarmState));
+    rules[index] = rule;
+    return true;
+  }
+
+  // Run every rule against one sample. Returns the active mask.
+  uint16_t evaluate(const float *inputs, uint32_t nowMs) {
+    changedMask = 0;
+    for (int i = 0; i < count; i++)
+      step(rules[i], states[i], inputs, nowMs);
+    return mask;
+  }
+
+  uint16_t active() const { return mask; }
+  uint16_t changed() const { return changedMask; } // By the last evaluate()
+
+  int size() const { return count; }
+  const AlarmRule &rule(int index) const { return rules[index]; }
+  const AlarmState &state(int index) const { return states[index]; }
+
+private:
+  void step(const AlarmRule &r, AlarmState &s, const float *inputs,
+            uint32_t nowMs) {
+    const float value = inputs[r.input];
+    if (!(value == value)) {
+      s.haveLast = false;
+      s.changing = false;
+      return;
+    }
+
+    float x = value;
+    if (r.kind == ALARM_RISING || r.kind == ALARM_FALLING) {
+      if (!s.haveLast || nowMs == s.lastMs) {
+        if (!s.haveLast)
+          s.rate = 0;
+        s.haveLast = true;
+        s.lastValue = value;
+        s.lastMs = nowMs;
+        return;
+      }
+      const float dt = (nowMs - s.lastMs) / 1000.0f;
+      const float instant = (value - s.lastValue) / dt;
+      s.rate += (instant - s.rate) * (dt / (r.rateMs / 1000.0f + dt));
+      s.lastValue = value;
+      s.lastMs = nowMs;
+      x = r.kind == ALARM_RISING ? s.rate : -s.rate;
+    }
+
+    // Past the limit raises, back inside by the hysteresis clears
+    bool met;
+    if (r.kind == ALARM_BELOW)
+      met = s.active ? x < r.limit + r.hysteresis : x < r.limit;
+    else
+      met = s.active ? x > r.limit - r.hysteresis : x > r.limit;
+    if (r.gate != ALARM_NO_GATE) {
+      const float g = inputs[r.gate];
+      if (!(g >= r.gateMin && g <= r.gateMax))
+        met = false;
+    }
+
+    if (met == s.active) {
+      s.changing = false;
+      return;
+    }
+    if (!s.changing) {
+      s.changing = true;
+      s.sinceMs = nowMs;
+    }
+    if (nowMs - s.sinceMs < (met ? r.raiseMs : r.clearMs))
+      return;
+    s.active = met;
+    s.changing = false;
+    if (met)
+      s.onsetMs = s.sinceMs;
+    mask = met ? (mask | r.bit) : (mask & ~r.bit);
+    changedMask |= r.bit;
+  }
+
+  AlarmRule rules[ALARM_MAX_RULES];
+  AlarmState states[ALARM_MAX_RULES];
+  int count;
+  uint16_t mask;
+  uint16_t changedMask;
+};
+
+#endif // ALARM_ENGINE_H
@@ -0,0 +1,110 @@
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stdint.h>
+
+// ============================================================================
+// SENDER CLOCK SYNC
+// ============================================================================
+// Tracks the CYD's millis() from its periodic time beacons so senders can
+// stamp samples in display time. Each beacon gives one offset measurement
+// (display ms - local ms); a small phase-locked loop smooths the offset and
+// learns the crystal drift between the two boards, so timestamps stay
+// accurate between beacons and the 1 ms beacon resolution averages out.
+//
+// Beacons that arrive late (radio busy, callback delayed) read as a smaller
+// offset, so large negative residuals are dropped. A large jump either way
+// after several rejects means the display rebooted and the loop restarts.
+//
+// Plain C++: callers pass esp_timer_get_time() so the math runs on a host.
+
+#define CLOCK_SYNC_TIMEOUT_MS 5000   // Unsynced after this long with no beacon
+#define CLOCK_SYNC_LATE_MS 3.0       // Reject beacons this far behind the fit
+#define CLOCK_SYNC_STEP_MS 50.0      // Residual that means the display reset
+#define CLOCK_SYNC_MAX_REJECTS 5     // Consecutive rejects before restarting
+#define CLOCK_SYNC_OFFSET_GAIN 0.1   // Share of each residual taken as offset
+#define CLOCK_SYNC_DRIFT_GAIN 0.01   // Share taken as frequency correction
+#define CLOCK_SYNC_MAX_DRIFT_PPM 200 // Crystal tolerance clamp
+
+class ClockSync {
+public:
+  ClockSync() { reset(); }
+
+  void reset() {
+    beacons = 0;
+    rejects = 0;
+    offsetMs = 0;
+    driftPpm = 0;
+    refUs = 0;
+    lastBeaconUs = 0;
+  }
+
+  // Feed one beacon: the display's millis() when it was sent and the local
+  // microsecond clock when it arrived.
+  void onBeacon(uint32_t displayMs, int64_t localUs) {
+    // The display's millis() is the floor of its true time, add half a tick
+    const double measured = (double)displayMs + 0.5 - localUs / 1000.0;
+    lastBeaconUs = localUs;
+
+    if (beacons == 0) {
+      offsetMs = measured;
+      refUs = localUs;
+      beacons = 1;
+      return;
+    }
+
+    // A display millis() wrap (49 days) looks like a reset and is handled
+    // the same way
+    const double predicted = offsetAt(localUs);
+    const double residual = measured - predicted;
+
+    if (residual < -CLOCK_SYNC_LATE_MS || residual > CLOCK_SYNC_STEP_MS) {
+      if (++rejects >= CLOCK_SYNC_MAX_REJECTS) {
+        reset();
+        onBeacon(displayMs, localUs);
+      }
+      return;
+    }
+    rejects = 0;
+
+    const double dtMs = (localUs - refUs) / 1000.0;
+    offsetMs = predicted + CLOCK_SYNC_OFFSET_GAIN * residual;
+    if (dtMs > 0) {
+      driftPpm += CLOCK_SYNC_DRIFT_GAIN * residual / dtMs * 1e6;
+      if (driftPpm > CLOCK_SYNC_MAX_DRIFT_PPM)
+        driftPpm = CLOCK_SYNC_MAX_DRIFT_PPM;
+      if (driftPpm < -CLOCK_SYNC_MAX_DRIFT_PPM)
+        driftPpm = -CLOCK_SYNC_MAX_DRIFT_PPM;
+    }
+    refUs = localUs;
+    beacons++;
+  }
+
+  // True while beacons are arriving
+  bool synced(int64_t nowUs) const {
+    return beacons > 0 && nowUs - lastBeaconUs < CLOCK_SYNC_TIMEOUT_MS * 1000LL;
+  }
+
+  // Local microsecond time converted to the display's millis()
+  uint32_t toDisplayMs(int64_t localUs) const {
+    return (uint32_t)(int64_t)(localUs / 1000.0 + offsetAt(localUs));
+  }
+
+  double offset() const { return offsetMs; }
+  double drift() const { return driftPpm; }
+  uint32_t beaconCount() const { return beacons; }
+
+private:
+  double offsetAt(int64_t localUs) const {
+    return offsetMs + driftPpm * 1e-6 * ((localUs - refUs) / 1000.0);
+  }
+
+  uint32_t beacons;
+  int rejects;
+  double offsetMs; // Display ms - local ms at refUs
+  double driftPpm; // How much faster the display clock runs
+  int64_t refUs;
+  int64_t lastBeaconUs;
+};
+
+#endif // CLOCK_SYNC_H
@@ -0,0 +1,32 @@
+#ifndef LINK_ESPNOW_H
+#define LINK_ESPNOW_H
+
+#include <esp_now.h>
+#include "packet_link.h"
+
+// ============================================================================
+// ESP-NOW TRANSPORT FOR THE BROADCAST LINK
+// ============================================================================
+// Peers are added on the current Wi-Fi channel, so call esp_now_init() and
+// set the channel first. Pass &LINK_ESPNOW to LinkSender/LinkReceiver::begin().
+
+inline bool linkEspNowSend(const uint8_t *mac, const uint8_t *data,
+                           size_t len) {
+  return esp_now_send(mac, data, len) == ESP_OK;
+}
+
+inline bool linkEspNowPeer(const uint8_t *mac, bool add) {
+  if (!add)
+    return esp_now_del_peer(mac) == ESP_OK;
+  if (esp_now_is_peer_exist(mac))
+    return true;
+  esp_now_peer_info_t peer = {};
+  memcpy(peer.peer_addr, mac, 6);
+  peer.channel = 0; // Current channel
+  peer.encrypt = false;
+  return esp_now_add_peer(&peer) == ESP_OK;
+}
+
+static const LinkTransport LINK_ESPNOW = {linkEspNowSend, linkEspNowPeer};
+
+#endif // LINK_ESPNOW_H
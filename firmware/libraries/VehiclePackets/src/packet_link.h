@@ -0,0 +1,578 @@
+#ifndef PACKET_LINK_H
+#define PACKET_LINK_H
+
+#include "vehicle_packets.h"
+
+// ============================================================================
+// BROADCAST LINK
+// ============================================================================
+// Senders broadcast each data packet once, so any number of receivers (the
+// CYD, a second dash, a logger) get it for the airtime of a single frame.
+//
+// Pairing: receivers broadcast a PairRequest for their group, every
+// LINK_SEARCH_MS until a sender answers and every LINK_ANNOUNCE_MS after.
+// For the first LINK_BOOT_WINDOW_MS they ask every LINK_BOOT_SEARCH_MS, as
+// on key-on the senders are still booting when the receiver first asks. A
+// sender can also re-add receivers it remembers from before a restart.
+// A sender in the same group adds the receiver as a peer and answers with a
+// unicast PairAccept. Receivers only take data from senders that accepted,
+// and senders stay quiet while nobody is paired. Either side forgets the
+// other after LINK_PEER_TIMEOUT_MS without hearing from it.
+//
+// Broadcast frames get no MAC-level ACK or retry. Frames that must not be
+// missed (fault changes, alarms) are sent as events: every data packet
+// carries the number of events sent so far, and the sender keeps the last
+// LINK_EVENT_HISTORY. A receiver that sees the count skip NACKs each missing
+// event and the sender broadcasts it again flagged LINK_FLAG_REPEAT.
+// Ordinary frames are never NACKed or retried: each carries the previous
+// readings (vehicle_packets.h), and receive() reports how many frames were
+// skipped so the receiver can rebuild them from that history.
+//
+// Radio callbacks only queue frames in a LinkInbox; anything that sends or
+// changes peers runs from poll() in loop(). The one exception: a receiver's
+// callback takes a sender slot as soon as the PairAccept arrives, because
+// the sender sends data straight after accepting and that frame must not be
+// dropped as unpaired. No Arduino dependencies: the sketch supplies the send
+// and peer functions (link_espnow.h).
+
+#define LINK_SEARCH_MS 1000        // Pair request interval with no senders
+#define LINK_ANNOUNCE_MS 5000      // Pair request interval once paired
+#define LINK_PEER_TIMEOUT_MS 16000 // Forget a peer after ~3 missed announces
+#define LINK_BOOT_SEARCH_MS 100    // Pair request interval just after boot
+#define LINK_BOOT_WINDOW_MS 3000   // ...for this long after the first request
+#define LINK_EVENT_HISTORY 8       // Event frames a sender can repeat
+#define LINK_NACK_RETRY_MS 100     // Wait this long for a repeat
+#define LINK_NACK_TRIES 3          // NACKs per missing event before giving up
+#define LINK_MAX_RECEIVERS 6
+#define LINK_MAX_SENDERS 8
+#define LINK_MAX_FRAME 80 // Largest data packet a sender can repeat
+#define LINK_INBOX_SIZE 8 // Power of two
+#define LINK_SEQ_RESYNC 1000 // Sequence jump that means a sender restart
+
+static const uint8_t LINK_BROADCAST[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// What the link needs from the radio
+typedef struct {
+  // Queue len bytes for mac (LINK_BROADCAST for everyone). True if queued.
+  bool (*send)(const uint8_t *mac, const uint8_t *data, size_t len);
+  // Add (add = true) or remove a unicast peer. True on success.
+  bool (*peer)(const uint8_t *mac, bool add);
+} LinkTransport;
+
+// One queued frame: who sent it and the few bytes poll() needs
+typedef struct {
+  uint8_t mac[6];
+  uint8_t type; // MSG_TYPE_*
+  uint8_t arg[2];
+} LinkFrame;
+
+// Single-producer (radio callback), single-consumer (loop) frame queue
+class LinkInbox {
+public:
+  LinkInbox() : head(0), tail(0), dropped(0) {}
+
+  bool push(const LinkFrame &frame) {
+    const uint8_t next = (head + 1) & (LINK_INBOX_SIZE - 1);
+    if (next == tail) {
+      dropped++;
+      return false;
+    }
+    frames[head] = frame;
+    __sync_synchronize(); // Frame is written before it is published
+    head = next;
+    return true;
+  }
+
+  bool pop(LinkFrame *frame) {
+    if (tail == head)
+      return false;
+    __sync_synchronize();
+    *frame = frames[tail];
+    tail = (tail + 1) & (LINK_INBOX_SIZE - 1);
+    return true;
+  }
+
+  uint32_t droppedCount() const { return dropped; }
+
+private:
+  LinkFrame frames[LINK_INBOX_SIZE];
+  volatile uint8_t head;
+  volatile uint8_t tail;
+  volatile uint32_t dropped;
+};
+
+// A paired device as seen from the other end
+typedef struct {
+  uint8_t mac[6];
+  volatile bool active; // Read by the radio callback, set last
+  uint8_t kind;         // Receiver: LINK_ROLE_*, sender: MSG_TYPE_*
+  uint32_t lastHeardMs;
+} LinkPeer;
+
+// ============================================================================
+// SENDER
+// ============================================================================
+class LinkSender {
+public:
+  LinkSender() : transport(NULL), group(0), dataType(0), eventSeq(0) {
+    memset(receivers, 0, sizeof(receivers));
+    memset(history, 0, sizeof(history));
+    lastRepeatSeq = 0;
+    lastRepeatMs = 0;
+    repeats = 0;
+    pairs = 0;
+  }
+
+  // Returns false if the broadcast peer could not be added
+  bool begin(const LinkTransport *radio, uint8_t groupId, uint8_t type) {
+    transport = radio;
+    group = groupId;
+    dataType = type;
+    return transport->peer(LINK_BROADCAST, true);
+  }
+
+  // Radio callback: queue pair requests and NACKs. Returns true if the
+  // frame was a link frame, false if the caller should handle it.
+  bool receive(const uint8_t *mac, const uint8_t *data, int len) {
+    LinkFrame frame;
+    memcpy(frame.mac, mac, 6);
+    frame.type = packetType(data, len);
+    if (frame.type == MSG_TYPE_PAIR_REQUEST) {
+      PairRequestPacketView request(data, len);
+      if (request.valid() && request.groupId() == group) {
+        frame.arg[0] = request.role();
+        inbox.push(frame);
+      }
+      return true;
+    }
+    if (frame.type == MSG_TYPE_NACK) {
+      NackPacketView nack(data, len);
+      if (nack.valid()) {
+        frame.arg[0] = nack.eventSeq();
+        inbox.push(frame);
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // Fill in the link fields, header and checksum. An event is kept so it can
+  // be repeated on request. Call once per packet, before send().
+  template <typename Packet> void seal(Packet *pkt, bool event) {
+    static_assert(sizeof(Packet) <= LINK_MAX_FRAME,
+                  "Raise LINK_MAX_FRAME to repeat this packet");
+    pkt->linkFlags = event ? LINK_FLAG_EVENT : 0;
+    if (event)
+      eventSeq++;
+    pkt->eventSeq = eventSeq;
+    packetSeal(pkt);
+    if (event) {
+      Stored &slot = history[eventSeq % LINK_EVENT_HISTORY];
+      memcpy(slot.data, pkt, sizeof(Packet));
+      slot.len = sizeof(Packet);
+      slot.flagsOffset = offsetof(Packet, linkFlags);
+      slot.eventSeq = eventSeq;
+    }
+  }
+
+  // Broadcast a sealed packet. False if nobody is paired or the radio queue
+  // is full; a packet sent to nobody still counts as a sent event.
+  template <typename Packet> bool send(const Packet *pkt) {
+    if (receiverCount() == 0)
+      return false;
+    return transport->send(LINK_BROADCAST, (const uint8_t *)pkt,
+                           sizeof(Packet));
+  }
+
+  // Answer pair requests, repeat NACKed events, forget silent receivers
+  void poll(uint32_t nowMs) {
+    LinkFrame frame;
+    while (inbox.pop(&frame)) {
+      if (frame.type == MSG_TYPE_PAIR_REQUEST)
+        onPairRequest(frame, nowMs);
+      else
+        onNack(frame, nowMs);
+    }
+    for (int i = 0; i < LINK_MAX_RECEIVERS; i++) {
+      LinkPeer &rx = receivers[i];
+      if (rx.active && nowMs - rx.lastHeardMs > LINK_PEER_TIMEOUT_MS) {
+        rx.active = false;
+        transport->peer(rx.mac, false);
+      }
+    }
+  }
+
+  // Pair with a receiver without waiting for its request, e.g. one
+  // remembered from before a reboot, so data goes out straight away. It is
+  // forgotten like any other if it stays silent. Returns NULL if the table or
+  // peer list is full.
+  LinkPeer *addReceiver(const uint8_t *mac, uint8_t kind, uint32_t nowMs) {
+    LinkPeer *rx = findReceiver(mac);
+    for (int i = 0; !rx && i < LINK_MAX_RECEIVERS; i++) {
+      if (!receivers[i].active && transport->peer(mac, true)) {
+        rx = &receivers[i];
+        memcpy(rx->mac, mac, 6);
+        rx->active = true;
+        pairs++;
+      }
+    }
+    if (!rx)
+      return NULL;
+    rx->kind = kind;
+    rx->lastHeardMs = nowMs;
+    return rx;
+  }
+
+  int receiverCount() const {
+    int n = 0;
+    for (int i = 0; i < LINK_MAX_RECEIVERS; i++)
+      n += receivers[i].active;
+    return n;
+  }
+  const LinkPeer &receiver(int i) const { return receivers[i]; }
+  uint32_t repeatCount() const { return repeats; }
+  // Receivers added since boot; changes whenever a new one pairs
+  uint32_t pairCount() const { return pairs; }
+
+private:
+  typedef struct {
+    uint8_t data[LINK_MAX_FRAME];
+    uint8_t len; // 0 = empty
+    uint8_t flagsOffset;
+    uint8_t eventSeq;
+  } Stored;
+
+  LinkPeer *findReceiver(const uint8_t *mac) {
+    for (int i = 0; i < LINK_MAX_RECEIVERS; i++) {
+      if (receivers[i].active && memcmp(receivers[i].mac, mac, 6) == 0)
+        return &receivers[i];
+    }
+    return NULL;
+  }
+
+  void onPairRequest(const LinkFrame &frame, uint32_t nowMs) {
+    LinkPeer *rx = addReceiver(frame.mac, frame.arg[0], nowMs);
+    if (!rx)
+      return; // Table or peer list full, the receiver keeps asking
+
+    PairAcceptPacket accept;
+    accept.groupId = group;
+    accept.dataType = dataType;
+    accept.eventSeq = eventSeq;
+    packetSeal(&accept);
+    transport->send(rx->mac, (const uint8_t *)&accept, sizeof(accept));
+  }
+
+  void onNack(const LinkFrame &frame, uint32_t nowMs) {
+    LinkPeer *rx = findReceiver(frame.mac);
+    if (!rx)
+      return;
+    rx->lastHeardMs = nowMs;
+    Stored &slot = history[frame.arg[0] % LINK_EVENT_HISTORY];
+    if (slot.len == 0 || slot.eventSeq != frame.arg[0])
+      return; // Too old, or from before a reboot
+
+    // One repeat serves every receiver that missed it; skip NACKs for the
+    // same event that arrive before the repeat could have been heard
+    if (frame.arg[0] == lastRepeatSeq && repeats > 0 &&
+        nowMs - lastRepeatMs < LINK_NACK_RETRY_MS / 2)
+      return;
+    uint8_t frameCopy[LINK_MAX_FRAME];
+    memcpy(frameCopy, slot.data, slot.len);
+    frameCopy[slot.flagsOffset] |= LINK_FLAG_REPEAT;
+    frameCopy[slot.len - 1] = packetChecksum(frameCopy, slot.len - 1);
+    transport->send(LINK_BROADCAST, frameCopy, slot.len);
+    lastRepeatSeq = frame.arg[0];
+    lastRepeatMs = nowMs;
+    repeats++;
+  }
+
+  const LinkTransport *transport;
+  uint8_t group;
+  uint8_t dataType;
+  uint8_t eventSeq;
+  LinkInbox inbox;
+  LinkPeer receivers[LINK_MAX_RECEIVERS];
+  Stored history[LINK_EVENT_HISTORY];
+  uint8_t lastRepeatSeq;
+  uint32_t lastRepeatMs;
+  uint32_t repeats;
+  uint32_t pairs;
+};
+
+// ============================================================================
+// RECEIVER
+// ============================================================================
+
+// What receive() found
+#define LINK_RX_OTHER 0    // Not a link or data frame, handle it yourself
+#define LINK_RX_CONTROL 1  // Pairing frame, queued for poll()
+#define LINK_RX_DATA 2     // New data from a paired sender
+#define LINK_RX_REPEAT 3   // Event repeated after a NACK, older than the latest
+#define LINK_RX_UNPAIRED 4 // Data from a sender that hasn't accepted us
+
+// Event frames recovered by NACK, or given up on, and data frames skipped
+typedef struct {
+  uint32_t nacks;
+  uint32_t recovered;
+  uint32_t lost;
+  uint32_t framesMissed; // Written by receive() only
+} LinkStats;
+
+class LinkReceiver {
+public:
+  LinkReceiver()
+      : transport(NULL), group(0), role(0), lastAnnounceMs(0),
+        firstAnnounceMs(0) {
+    memset(senders, 0, sizeof(senders));
+    memset(&stats, 0, sizeof(stats));
+    announced = false;
+  }
+
+  // Returns false if the broadcast peer could not be added
+  bool begin(const LinkTransport *radio, uint8_t groupId, uint8_t myRole) {
+    transport = radio;
+    group = groupId;
+    role = myRole;
+    return transport->peer(LINK_BROADCAST, true);
+  }
+
+  // Radio callback: classify a frame and queue what poll() needs to track
+  // pairing and missed events. Returns LINK_RX_*. For LINK_RX_DATA, missed
+  // gets the number of frames lost since the previous one from that sender.
+  int receive(const uint8_t *mac, const uint8_t *data, int len,
+              uint8_t *missed = NULL) {
+    LinkFrame frame;
+    memcpy(frame.mac, mac, 6);
+    frame.type = packetType(data, len);
+    if (frame.type == MSG_TYPE_PAIR_ACCEPT) {
+      PairAcceptPacketView accept(data, len);
+      if (accept.valid() && accept.groupId() == group) {
+        frame.arg[0] = accept.dataType();
+        frame.arg[1] = accept.eventSeq();
+        const int i = findSender(mac) >= 0 ? -1 : claimSender(frame);
+        if (!inbox.push(frame) && i >= 0)
+          senders[i].peer.active = false; // poll() would never finish it
+      }
+      return LINK_RX_CONTROL;
+    }
+
+    uint8_t flags, eventSeq;
+    uint16_t seq;
+    if (!packetLinkFields(data, len, &flags, &eventSeq, &seq))
+      return LINK_RX_OTHER;
+    const int i = findSender(mac);
+    if (i < 0)
+      return LINK_RX_UNPAIRED;
+    frame.arg[0] = flags;
+    frame.arg[1] = eventSeq;
+    inbox.push(frame);
+    if (flags & LINK_FLAG_REPEAT)
+      return LINK_RX_REPEAT;
+
+    const uint16_t gap = seq - senders[i].lastSeq - 1;
+    const uint16_t lost =
+        senders[i].seqValid && gap < LINK_SEQ_RESYNC ? gap : 0;
+    senders[i].lastSeq = seq;
+    senders[i].seqValid = true;
+    stats.framesMissed += lost;
+    if (missed)
+      *missed = lost > 0xFF ? 0xFF : (uint8_t)lost;
+    return LINK_RX_DATA;
+  }
+
+  // Send pair requests and NACKs, track events, forget silent senders
+  void poll(uint32_t nowMs) {
+    uint32_t interval = senderCount() > 0 ? LINK_ANNOUNCE_MS : LINK_SEARCH_MS;
+    if (announced && nowMs - firstAnnounceMs < LINK_BOOT_WINDOW_MS)
+      interval = LINK_BOOT_SEARCH_MS;
+    if (!announced || nowMs - lastAnnounceMs >= interval) {
+      PairRequestPacket request;
+      request.groupId = group;
+      request.role = role;
+      packetSeal(&request);
+      transport->send(LINK_BROADCAST, (const uint8_t *)&request,
+                      sizeof(request));
+      if (!announced)
+        firstAnnounceMs = nowMs;
+      lastAnnounceMs = nowMs;
+      announced = true;
+    }
+
+    // Drain after announcing so accepts that come straight back count now
+    LinkFrame frame;
+    while (inbox.pop(&frame)) {
+      if (frame.type == MSG_TYPE_PAIR_ACCEPT)
+        onAccept(frame, nowMs);
+      else
+        onData(frame, nowMs);
+    }
+
+    for (int i = 0; i < LINK_MAX_SENDERS; i++) {
+      Sender &tx = senders[i];
+      if (!tx.peer.active || tx.pending)
+        continue;
+      if (nowMs - tx.peer.lastHeardMs > LINK_PEER_TIMEOUT_MS) {
+        // The callback may reuse the slot once it is inactive
+        uint8_t mac[6];
+        memcpy(mac, tx.peer.mac, 6);
+        stats.lost += tx.missingCount;
+        tx.peer.active = false;
+        transport->peer(mac, false);
+        continue;
+      }
+      sendNacks(tx, nowMs);
+    }
+  }
+
+  int senderCount() const {
+    int n = 0;
+    for (int i = 0; i < LINK_MAX_SENDERS; i++)
+      n += senders[i].peer.active;
+    return n;
+  }
+  const LinkPeer &sender(int i) const { return senders[i].peer; }
+  const LinkStats &linkStats() const { return stats; }
+  uint32_t droppedCount() const { return inbox.droppedCount(); }
+
+private:
+  typedef struct {
+    LinkPeer peer;
+    uint8_t lastEvent; // Newest event count heard
+    uint8_t missing[LINK_EVENT_HISTORY];
+    uint8_t tries[LINK_EVENT_HISTORY];
+    uint8_t missingCount;
+    uint32_t nackDueMs;
+    uint16_t lastSeq; // Newest data sequence, callback side
+    bool seqValid;
+    volatile bool pending; // Taken by the callback, poll() adds the peer
+  } Sender;
+
+  int findSender(const uint8_t *mac) const {
+    for (int i = 0; i < LINK_MAX_SENDERS; i++) {
+      if (senders[i].peer.active && memcmp(senders[i].peer.mac, mac, 6) == 0)
+        return i;
+    }
+    return -1;
+  }
+
+  // Callback side: take a free slot for a sender that just accepted, so its
+  // next data frame is accepted. Only inactive slots are taken, which poll()
+  // leaves alone. Returns the slot, or -1 if the table is full.
+  int claimSender(const LinkFrame &frame) {
+    for (int i = 0; i < LINK_MAX_SENDERS; i++) {
+      Sender &tx = senders[i];
+      if (tx.peer.active)
+        continue;
+      memcpy(tx.peer.mac, frame.mac, 6);
+      tx.lastEvent = frame.arg[1]; // Don't NACK what was sent before us
+      tx.missingCount = 0;
+      tx.seqValid = false;
+      tx.pending = true;
+      __sync_synchronize(); // Everything above is seen before active
+      tx.peer.active = true;
+      return i;
+    }
+    return -1;
+  }
+
+  void onAccept(const LinkFrame &frame, uint32_t nowMs) {
+    const int i = findSender(frame.mac);
+    if (i < 0)
+      return; // Table full, the receiver keeps asking
+    Sender &tx = senders[i];
+    if (tx.pending && !transport->peer(frame.mac, true)) {
+      // No unicast peer for NACKs: drop it and pair on a later accept
+      tx.pending = false;
+      tx.peer.active = false;
+      return;
+    }
+    tx.peer.kind = frame.arg[0];
+    tx.peer.lastHeardMs = nowMs;
+    tx.pending = false;
+  }
+
+  void onData(const LinkFrame &frame, uint32_t nowMs) {
+    const int i = findSender(frame.mac);
+    if (i < 0)
+      return;
+    Sender &tx = senders[i];
+    tx.peer.lastHeardMs = nowMs;
+    const uint8_t flags = frame.arg[0];
+    const uint8_t seq = frame.arg[1];
+
+    if (flags & LINK_FLAG_REPEAT) {
+      if (removeMissing(tx, seq))
+        stats.recovered++;
+      return;
+    }
+
+    // Events the sender had sent before this frame
+    const uint8_t before = (flags & LINK_FLAG_EVENT) ? seq - 1 : seq;
+    const uint8_t gap = before - tx.lastEvent;
+    if (gap > LINK_EVENT_HISTORY) {
+      // Sender rebooted, or we were out of range longer than it remembers
+      stats.lost += tx.missingCount;
+      tx.missingCount = 0;
+    } else {
+      for (uint8_t k = 1; k <= gap; k++)
+        addMissing(tx, tx.lastEvent + k, nowMs);
+    }
+    tx.lastEvent = seq;
+  }
+
+  void addMissing(Sender &tx, uint8_t seq, uint32_t nowMs) {
+    if (tx.missingCount == LINK_EVENT_HISTORY) {
+      removeMissing(tx, tx.missing[0]); // Oldest has left the history
+      stats.lost++;
+    }
+    tx.missing[tx.missingCount] = seq;
+    tx.tries[tx.missingCount] = 0;
+    tx.missingCount++;
+    tx.nackDueMs = nowMs;
+  }
+
+  bool removeMissing(Sender &tx, uint8_t seq) {
+    for (int k = 0; k < tx.missingCount; k++) {
+      if (tx.missing[k] != seq)
+        continue;
+      tx.missingCount--;
+      memmove(&tx.missing[k], &tx.missing[k + 1], tx.missingCount - k);
+      memmove(&tx.tries[k], &tx.tries[k + 1], tx.missingCount - k);
+      return true;
+    }
+    return false;
+  }
+
+  void sendNacks(Sender &tx, uint32_t nowMs) {
+    if (tx.missingCount == 0 || (int32_t)(nowMs - tx.nackDueMs) < 0)
+      return;
+    for (int k = 0; k < tx.missingCount;) {
+      if (tx.tries[k] >= LINK_NACK_TRIES) {
+        removeMissing(tx, tx.missing[k]);
+        stats.lost++;
+        continue;
+      }
+      NackPacket nack;
+      nack.eventSeq = tx.missing[k];
+      packetSeal(&nack);
+      transport->send(tx.peer.mac, (const uint8_t *)&nack, sizeof(nack));
+      tx.tries[k]++;
+      stats.nacks++;
+      k++;
+    }
+    tx.nackDueMs = nowMs + LINK_NACK_RETRY_MS;
+  }
+
+  const LinkTransport *transport;
+  uint8_t group;
+  uint8_t role;
+  bool announced;
+  uint32_t lastAnnounceMs;
+  uint32_t firstAnnounceMs;
+  LinkInbox inbox;
+  Sender senders[LINK_MAX_SENDERS];
+  LinkStats stats;
+};
+
+#endif // PACKET_LINK_H
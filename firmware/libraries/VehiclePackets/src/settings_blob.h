@@ -0,0 +1,172 @@
+#ifndef SETTINGS_BLOB_H
+#define SETTINGS_BLOB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ============================================================================
+// SETTINGS BLOB
+// ============================================================================
+// A sketch's persistent settings kept as one NVS value rather than a key per
+// field, so boot costs one lookup and a save one flash write. The payload is
+// a plain struct behind a small header:
+//
+//   magic    SETTINGS_MAGIC; rejects anything else stored under the key
+//   version  the sketch's layout number; older layouts are the sketch's to
+//            migrate from storedPayload()
+//   length   payload bytes
+//   saves    lifetime save count, so flash wear is tracked across reboots
+//   crc      CRC-32 of header and payload; rejects a torn or corrupt write
+//
+// Saves are deferred: changed() marks the settings dirty and due() turns true
+// once they have been left alone for SETTINGS_SAVE_QUIET_MS, or have been
+// dirty for SETTINGS_SAVE_MAX_MS, so a run of console edits is one write.
+// prepare() skips the write if the image matches the one last stored.
+//
+// No Arduino dependencies: the sketch does the Preferences getBytes/putBytes
+// on buffer() and image().
+
+#define SETTINGS_MAGIC 0x5B
+#define SETTINGS_MAX_PAYLOAD 64
+#define SETTINGS_SAVE_QUIET_MS 3000  // Write this long after the last edit
+#define SETTINGS_SAVE_MAX_MS 30000   // ...or this long after the first
+
+typedef struct __attribute__((packed)) {
+  uint8_t magic;
+  uint8_t version;
+  uint16_t length;
+  uint32_t saves;
+  uint32_t crc; // Over the header up to here, then the payload
+} SettingsHeader;
+
+// CRC-32 (IEEE, reflected), bitwise to keep it out of flash-hungry tables
+inline uint32_t settingsCrc32(const uint8_t *data, size_t len,
+                              uint32_t crc = 0) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+typedef enum {
+  SETTINGS_LOADED,        // Current layout, copied into the values
+  SETTINGS_MISSING,       // Nothing stored (first boot, or old keys)
+  SETTINGS_CORRUPT,       // Wrong magic, length or CRC
+  SETTINGS_OTHER_VERSION, // Intact but another layout: see storedPayload()
+} SettingsLoad;
+
+template <typename T> class SettingsBlob {
+public:
+  explicit SettingsBlob(uint8_t version)
+      : version(version), saveCount(0), storedCrc(0), preparedCrc(0),
+        haveStored(false), dirty(false), firstChangeMs(0), lastChangeMs(0),
+        imageLen(0) {}
+
+  // Where to read the stored image to, and how much room there is
+  uint8_t *buffer() { return buf; }
+  size_t capacity() const { return sizeof(buf); }
+
+  // Check len bytes read into buffer(). On SETTINGS_LOADED *values holds
+  // them; on anything else *values is untouched.
+  SettingsLoad load(size_t len, T *values) {
+    SettingsHeader h;
+    if (len == 0)
+      return SETTINGS_MISSING;
+    if (len < sizeof(h))
+      return SETTINGS_CORRUPT;
+    memcpy(&h, buf, sizeof(h));
+    if (h.magic != SETTINGS_MAGIC || h.length != len - sizeof(h) ||
+        h.crc != imageCrc(h.length))
+      return SETTINGS_CORRUPT;
+    saveCount = h.saves;
+    if (h.version != version || h.length != sizeof(T))
+      return SETTINGS_OTHER_VERSION;
+    memcpy(values, buf + sizeof(h), sizeof(T));
+    storedCrc = settingsCrc32(buf + sizeof(h), sizeof(T));
+    haveStored = true;
+    return SETTINGS_LOADED;
+  }
+
+  // After SETTINGS_OTHER_VERSION: the stored layout and its bytes
+  uint8_t storedVersion() const {
+    return ((const SettingsHeader *)buf)->version;
+  }
+  const uint8_t *storedPayload(size_t *len) const {
+    *len = ((const SettingsHeader *)buf)->length;
+    return buf + sizeof(SettingsHeader);
+  }
+
+  // Deferred saving
+  void changed(uint32_t nowMs) {
+    if (!dirty)
+      firstChangeMs = nowMs;
+    dirty = true;
+    lastChangeMs = nowMs;
+  }
+  bool pending() const { return dirty; }
+  bool due(uint32_t nowMs) const {
+    return dirty && (nowMs - lastChangeMs >= SETTINGS_SAVE_QUIET_MS ||
+                     nowMs - firstChangeMs >= SETTINGS_SAVE_MAX_MS);
+  }
+
+  // Build the image for values. False (and no longer dirty) if flash
+  // already holds exactly this, so there is nothing to write.
+  bool prepare(const T &values) {
+    dirty = false;
+    const uint32_t payloadCrc =
+        settingsCrc32((const uint8_t *)&values, sizeof(T));
+    if (haveStored && payloadCrc == storedCrc)
+      return false;
+    SettingsHeader h;
+    h.magic = SETTINGS_MAGIC;
+    h.version = version;
+    h.length = sizeof(T);
+    h.saves = saveCount + 1;
+    memcpy(buf, &h, sizeof(h));
+    memcpy(buf + sizeof(h), &values, sizeof(T));
+    h.crc = imageCrc(sizeof(T));
+    memcpy(buf, &h, sizeof(h));
+    imageLen = sizeof(h) + sizeof(T);
+    preparedCrc = payloadCrc;
+    return true;
+  }
+  const uint8_t *image() const { return buf; }
+  size_t size() const { return imageLen; }
+
+  // The prepared image reached flash
+  void committed() {
+    saveCount++;
+    storedCrc = preparedCrc;
+    haveStored = true;
+  }
+  // The write failed: try again on the next due()
+  void failed(uint32_t nowMs) { changed(nowMs); }
+
+  uint32_t saves() const { return saveCount; }
+
+private:
+  uint32_t imageCrc(size_t payloadLen) const {
+    uint32_t crc = settingsCrc32(buf, offsetof(SettingsHeader, crc));
+    return settingsCrc32(buf + sizeof(SettingsHeader), payloadLen, crc);
+  }
+
+  static_assert(sizeof(T) <= SETTINGS_MAX_PAYLOAD,
+                "settings payload exceeds SETTINGS_MAX_PAYLOAD");
+
+  uint8_t version;
+  uint32_t saveCount;
+  uint32_t storedCrc;   // Payload CRC of what flash holds
+  uint32_t preparedCrc; // ...and of the image prepare() built
+  bool haveStored;
+  bool dirty;
+  uint32_t firstChangeMs;
+  uint32_t lastChangeMs;
+  size_t imageLen;
+  uint8_t buf[sizeof(SettingsHeader) + SETTINGS_MAX_PAYLOAD];
+};
+
+#endif // SETTINGS_BLOB_H
@@ -0,0 +1,86 @@
+#ifndef TELEMETRY_UPLINK_H
+#define TELEMETRY_UPLINK_H
+
+#include "vehicle_packets.h"
+
+// ============================================================================
+// SERIAL TELEMETRY UPLINK
+// ============================================================================
+// The CYD's USB serial carries its text log and, between log lines, a
+// TelemetryPacket about once a second. A frame is UPLINK_START, the packet
+// length, then the packet. The log never contains UPLINK_START (NUL), so a
+// reader splits the stream byte by byte with UplinkReader and passes the
+// text on untouched.
+//
+// Frames go out in one Serial.write() so a log line can't land inside one.
+// The packet's own checksum rejects a frame cut short by a reset.
+//
+// No Arduino dependencies.
+
+#define UPLINK_START 0x00
+#define UPLINK_MAX_PACKET 64
+#define UPLINK_OVERHEAD 2 // Start and length bytes
+
+// Frame pkt into out, which holds sizeof(Packet) + UPLINK_OVERHEAD bytes.
+// Returns the frame length.
+template <typename Packet>
+inline size_t uplinkFrame(const Packet &pkt, uint8_t *out) {
+  static_assert(sizeof(Packet) <= UPLINK_MAX_PACKET,
+                "Raise UPLINK_MAX_PACKET to send this packet");
+  out[0] = UPLINK_START;
+  out[1] = (uint8_t)sizeof(Packet);
+  memcpy(out + UPLINK_OVERHEAD, &pkt, sizeof(Packet));
+  return sizeof(Packet) + UPLINK_OVERHEAD;
+}
+
+// What a byte fed to UplinkReader turned out to be
+#define UPLINK_TEXT 0    // Log text, pass it on
+#define UPLINK_PENDING 1 // Part of a frame
+#define UPLINK_FRAME 2   // Last byte of a frame: see packet()
+
+class UplinkReader {
+public:
+  int feed(uint8_t c) {
+    switch (state) {
+    case READ_TEXT:
+      if (c != UPLINK_START)
+        return UPLINK_TEXT;
+      state = READ_LENGTH;
+      return UPLINK_PENDING;
+    case READ_LENGTH:
+      if (c == 0 || c > UPLINK_MAX_PACKET) {
+        state = READ_TEXT; // Not a frame after all
+        badFrames++;
+        return UPLINK_PENDING;
+      }
+      length = c;
+      got = 0;
+      state = READ_BODY;
+      return UPLINK_PENDING;
+    default:
+      buf[got++] = c;
+      if (got < length)
+        return UPLINK_PENDING;
+      state = READ_TEXT;
+      frames++;
+      return UPLINK_FRAME;
+    }
+  }
+
+  // The packet of the frame just completed, for a <Name>View to check
+  const uint8_t *packet() const { return buf; }
+  size_t packetLen() const { return length; }
+
+  uint32_t frameCount() const { return frames; }
+  uint32_t badFrameCount() const { return badFrames; }
+
+private:
+  enum { READ_TEXT, READ_LENGTH, READ_BODY } state = READ_TEXT;
+  uint8_t buf[UPLINK_MAX_PACKET];
+  size_t length = 0;
+  size_t got = 0;
+  uint32_t frames = 0;
+  uint32_t badFrames = 0;
+};
+
+#endif // TELEMETRY_UPLINK_H
@@ -0,0 +1,398 @@
+#ifndef VEHICLE_PACKETS_H
+#define VEHICLE_PACKETS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ============================================================================
+// VEHICLE MONITOR ESP-NOW PACKETS
+// ============================================================================
+// The one definition of every packet exchanged between the senders and the
+// CYD. Each message type is a single field list; the macros below expand it
+// into the packed struct the sender fills in, compile-time checks that pin
+// the wire layout, and a read-only view that decodes fields straight out of
+// the receive buffer without copying the packet.
+//
+// Field lists are F(P, type, name, wire offset). Offsets are part of the
+// protocol: changing one fails the build until the list and
+// PACKET_PROTOCOL_VERSION are updated together.
+//
+// Every packet starts with a PacketHeader: protocol version, then message
+// type. The message type says which sender (and layout) the packet came
+// from. It ends with an XOR checksum of all previous bytes.
+//
+// Data packets also carry the main reading of the previous
+// PACKET_HISTORY_DEPTH packets in compact form, so a receiver rebuilds one or
+// two lost frames from the next one instead of asking for a retransmit.
+// They also carry the min, max and mean of every sample taken since the
+// last packet (window_stats.h), so receivers see excursions between them.
+
+#define PACKET_PROTOCOL_VERSION 9
+
+// Maximum ESP-NOW payload: 250 bytes (v1.0) or 1470 bytes (v2.0+)
+// Using conservative size for v1.0 compatibility
+#define MAX_ESPNOW_DATA_LEN 250
+
+// Message types (one per sender role)
+#define MSG_TYPE_OIL 0x01  // Oil temperature/pressure sender
+#define MSG_TYPE_FUEL 0x02 // Fuel level sender
+#define MSG_TYPE_TIME_BEACON 0x10 // CYD clock broadcast
+#define MSG_TYPE_PAIR_REQUEST 0x11 // Receiver looking for senders
+#define MSG_TYPE_PAIR_ACCEPT 0x12  // Sender answering a pair request
+#define MSG_TYPE_NACK 0x13         // Receiver missed an event frame
+#define MSG_TYPE_TELEMETRY 0x20    // CYD state to the laptop, over USB serial
+
+// Clock a sender's timestamp field is in
+#define TIME_SOURCE_SENDER 0  // Sender's own millis() (no beacon yet)
+#define TIME_SOURCE_DISPLAY 1 // CYD millis(), from the time beacon
+
+// linkFlags bits of a data packet (see packet_link.h)
+#define LINK_FLAG_EVENT 0x01  // Must not be missed, receivers NACK if lost
+#define LINK_FLAG_REPEAT 0x02 // Resent after a NACK, older than the latest
+
+// Receiver roles in a pair request
+#define LINK_ROLE_DISPLAY 1
+#define LINK_ROLE_LOGGER 2
+
+typedef struct __attribute__((packed)) {
+  uint8_t version; // PACKET_PROTOCOL_VERSION
+  uint8_t type;    // MSG_TYPE_*
+} PacketHeader;
+
+// ============================================================================
+// OIL SENDER PACKET
+// ============================================================================
+#define TEMP_DATA_PACKET_FIELDS(F, P)                                        \
+  F(P, uint32_t, timestamp, 2)      /* Sample time, ms (see timeSource) */   \
+  F(P, float, temperature, 6)       /* Head temperature C (unused) */        \
+  F(P, float, coldJunction, 10)     /* Head cold junction C */               \
+  F(P, uint8_t, faultStatus, 14)    /* Head MAX31856 fault register */       \
+  F(P, float, oilTemperature, 15)   /* Oil temperature C */                  \
+  F(P, float, oilColdJunction, 19)  /* Oil cold junction C */                \
+  F(P, uint8_t, oilFaultStatus, 23) /* Oil MAX31856 fault register */        \
+  F(P, float, oilPressure, 24)      /* Oil pressure PSI */                   \
+  F(P, uint8_t, sensorsStatus, 28)  /* Bit 0=Head, 1=Oil Temp, 2=Oil Press */\
+  F(P, uint16_t, sequenceNumber, 29)/* Increments each send */               \
+  F(P, uint8_t, batteryLevel, 31)   /* Battery 0-100 (future use) */         \
+  F(P, uint8_t, timeSource, 32)     /* TIME_SOURCE_* of timestamp */         \
+  F(P, uint8_t, linkFlags, 33)      /* LINK_FLAG_* */                        \
+  F(P, uint8_t, eventSeq, 34)       /* Event frames sent so far (wraps) */   \
+  F(P, uint16_t, prev1AgeMs, 35)    /* Previous reading age ms, 0=none */   \
+  F(P, int16_t, prev1OilTemp, 37)   /* Oil temperature, 0.1 C */             \
+  F(P, uint16_t, prev1OilPressure, 39)/* Oil pressure, 0.1 PSI */            \
+  F(P, uint8_t, prev1OilFault, 41)  /* Oil fault register */                 \
+  F(P, uint16_t, prev2AgeMs, 42)    /* The one before: age, 0=none */        \
+  F(P, int16_t, prev2OilTemp, 44)   /* Oil temperature, 0.1 C */             \
+  F(P, uint16_t, prev2OilPressure, 46)/* Oil pressure, 0.1 PSI */            \
+  F(P, uint8_t, prev2OilFault, 48)  /* Oil fault register */                 \
+  F(P, uint16_t, alarms, 49)        /* OIL_ALARM_* raised by the sender */   \
+  F(P, uint8_t, oilTempSamples, 51) /* Fault-free samples since last packet */\
+  F(P, int16_t, oilTempMin, 52)     /* Their oil temperature, 0.1 C */       \
+  F(P, int16_t, oilTempMax, 54)                                              \
+  F(P, int16_t, oilTempMean, 56)                                             \
+  F(P, uint8_t, oilPressSamples, 58)/* Pressure samples since last packet */ \
+  F(P, uint16_t, oilPressMin, 59)   /* Their oil pressure, 0.1 PSI */        \
+  F(P, uint16_t, oilPressMax, 61)                                            \
+  F(P, uint16_t, oilPressMean, 63)                                           \
+  F(P, uint16_t, faultAgeMs, 65)    /* First faulted sample age, 0=none */
+
+// Oil alarms bits, raised by the sender's rules (alarm_engine.h) on the
+// sample the packet carries
+#define OIL_ALARM_TEMP_HIGH 0x0001      // Oil temperature over its limit
+#define OIL_ALARM_TEMP_RISING 0x0002    // Hot oil still climbing fast
+#define OIL_ALARM_PRESS_LOW 0x0004      // Under the low limit while moving
+#define OIL_ALARM_PRESS_CRITICAL 0x0008 // Near zero at any speed
+#define OIL_ALARM_PRESS_HIGH 0x0010     // Over the high limit
+#define OIL_ALARM_PRESS_DROP 0x0020     // Falling fast while moving
+#define OIL_ALARM_HEAD_HIGH 0x0040      // Head temperature warning
+#define OIL_ALARM_HEAD_CRITICAL 0x0080  // Head temperature critical
+#define OIL_ALARM_TEMP_MASK (OIL_ALARM_TEMP_HIGH | OIL_ALARM_TEMP_RISING)
+#define OIL_ALARM_PRESS_MASK                                                 \
+  (OIL_ALARM_PRESS_LOW | OIL_ALARM_PRESS_CRITICAL | OIL_ALARM_PRESS_HIGH |   \
+   OIL_ALARM_PRESS_DROP)
+// Stop the engine now; the rest are warnings
+#define OIL_ALARM_CRITICAL_MASK                                              \
+  (OIL_ALARM_PRESS_LOW | OIL_ALARM_PRESS_CRITICAL | OIL_ALARM_PRESS_DROP |   \
+   OIL_ALARM_HEAD_CRITICAL)
+
+// ============================================================================
+// FUEL SENDER PACKET
+// ============================================================================
+#define FUEL_DATA_PACKET_FIELDS(F, P)                                        \
+  F(P, uint32_t, timestamp, 2)      /* Sample time, ms (see timeSource) */   \
+  F(P, uint16_t, raw_resistance, 6) /* Sender resistance, 0.01 ohm units */  \
+  F(P, uint8_t, fuel_percent, 8)    /* Fuel level 0-100% */                  \
+  F(P, uint8_t, fault_status, 9)    /* FUEL_FAULT_* flags */                 \
+  F(P, uint16_t, sequence_number, 10)/* Increments each send */              \
+  F(P, uint8_t, timeSource, 12)     /* TIME_SOURCE_* of timestamp */         \
+  F(P, uint8_t, linkFlags, 13)      /* LINK_FLAG_* */                        \
+  F(P, uint8_t, eventSeq, 14)       /* Event frames sent so far (wraps) */   \
+  F(P, uint16_t, prev1AgeMs, 15)    /* Previous reading age ms, 0=none */   \
+  F(P, uint8_t, prev1Percent, 17)   /* Fuel level 0-100% */                  \
+  F(P, uint8_t, prev1Faults, 18)    /* FUEL_FAULT_* flags */                 \
+  F(P, uint16_t, prev2AgeMs, 19)    /* The one before: age, 0=none */        \
+  F(P, uint8_t, prev2Percent, 21)   /* Fuel level 0-100% */                  \
+  F(P, uint8_t, prev2Faults, 22)    /* FUEL_FAULT_* flags */                 \
+  F(P, uint8_t, windowSamples, 23)  /* Fault-free samples since last packet */\
+  F(P, uint8_t, percentMin, 24)     /* Their fuel level 0-100% */            \
+  F(P, uint8_t, percentMax, 25)                                              \
+  F(P, uint16_t, percentMean, 26)   /* 0.1% */                               \
+  F(P, uint16_t, faultAgeMs, 28)    /* First faulted sample age, 0=none */
+
+// Fuel fault_status bits
+#define FUEL_FAULT_NONE 0x00
+#define FUEL_FAULT_OPEN_CIRCUIT 0x01  // Sender disconnected or open wire
+#define FUEL_FAULT_SHORT_CIRCUIT 0x02 // Sender shorted or very low resistance
+#define FUEL_FAULT_SENSOR_ERROR 0x04  // Reserved for sensor-level errors
+#define FUEL_FAULT_LOW_FUEL 0x08      // Level below warning threshold
+#define FUEL_FAULT_RESERVED_MASK 0xF0 // Reserved for future use
+
+// ============================================================================
+// CYD TIME BEACON
+// ============================================================================
+// Broadcast by the CYD about once a second. Senders lock their clocks to it
+// (clock_sync.h) and stamp samples in display time. It also carries the GPS
+// road speed, which gates some of the senders' alarm rules.
+#define TIME_BEACON_FIELDS(F, P)                                              \
+  F(P, uint32_t, displayMs, 2) /* CYD millis() just before sending */         \
+  F(P, uint16_t, beaconSeq, 6) /* Increments each beacon */                   \
+  F(P, uint16_t, speedMph10, 8) /* GPS 0.1 mph, BEACON_SPEED_UNKNOWN = no fix */
+
+#define BEACON_SPEED_UNKNOWN 0xFFFF
+
+// ============================================================================
+// LINK CONTROL
+// ============================================================================
+// Pairing and event NACKs for the broadcast link (packet_link.h).
+#define PAIR_REQUEST_FIELDS(F, P)                                             \
+  F(P, uint8_t, groupId, 2) /* Vehicle group, senders ignore others */        \
+  F(P, uint8_t, role, 3)    /* LINK_ROLE_* */
+
+#define PAIR_ACCEPT_FIELDS(F, P)                                              \
+  F(P, uint8_t, groupId, 2)  /* Echoed from the request */                    \
+  F(P, uint8_t, dataType, 3) /* MSG_TYPE_* the sender broadcasts */           \
+  F(P, uint8_t, eventSeq, 4) /* Sender's current event count */
+
+#define NACK_FIELDS(F, P)                                                     \
+  F(P, uint8_t, eventSeq, 2) /* Event frame to repeat */
+
+// ============================================================================
+// CYD TELEMETRY UPLINK
+// ============================================================================
+// Not sent over ESP-NOW: the CYD writes one about once a second to its USB
+// serial, framed between its log lines (telemetry_uplink.h), for the laptop
+// recorder. It is the merged state the dashboard shows. Values of a channel
+// whose fresh bit is clear are the last ones received (or 0).
+#define TELEMETRY_FIELDS(F, P)                                                \
+  F(P, uint32_t, displayMs, 2)    /* CYD millis() when sent */                \
+  F(P, uint16_t, frameSeq, 6)     /* Increments each frame */                 \
+  F(P, uint8_t, fresh, 8)         /* TELEMETRY_* channels with fresh data */  \
+  F(P, int16_t, oilTempF10, 9)    /* Oil temperature, 0.1 F */                \
+  F(P, uint16_t, oilPressPsi10, 11)/* Oil pressure, 0.1 PSI */                \
+  F(P, uint16_t, fuelPercent10, 13)/* Fuel level, 0.1% */                     \
+  F(P, uint8_t, oilFaults, 15)    /* Oil temperature fault register */        \
+  F(P, uint8_t, fuelFaults, 16)   /* FUEL_FAULT_* wiring flags */             \
+  F(P, uint16_t, oilAlarms, 17)   /* OIL_ALARM_* */                           \
+  F(P, uint8_t, fuelAlarms, 19)   /* FUEL_FAULT_LOW_FUEL */                   \
+  F(P, uint16_t, speedMph10, 20)  /* GPS speed, 0.1 mph */                    \
+  F(P, int32_t, latE7, 22)        /* Latitude, 1e-7 degrees */                \
+  F(P, int32_t, lonE7, 26)        /* Longitude, 1e-7 degrees */               \
+  F(P, int16_t, altM, 30)         /* Altitude, m */                           \
+  F(P, uint16_t, headingDeg10, 32)/* Heading, 0.1 degree */                   \
+  F(P, uint8_t, satellites, 34)
+
+// fresh bits
+#define TELEMETRY_OIL_TEMP 0x01
+#define TELEMETRY_OIL_PRESS 0x02
+#define TELEMETRY_FUEL 0x04
+#define TELEMETRY_GPS_FIX 0x08 // 2D or 3D fix, position and speed fresh
+
+// ============================================================================
+// CODEC
+// ============================================================================
+
+// XOR of the first len bytes
+inline uint8_t packetChecksum(const uint8_t *data, size_t len) {
+  uint8_t sum = 0;
+  for (size_t i = 0; i < len; i++)
+    sum ^= data[i];
+  return sum;
+}
+
+// Unaligned little-endian field read (ESP32 and x86 are both little-endian)
+template <typename T> inline T packetRead(const uint8_t *data, size_t offset) {
+  T value;
+  memcpy(&value, data + offset, sizeof(T));
+  return value;
+}
+
+// Fill in the header and checksum of a packet before sending it
+template <typename Packet> inline void packetSeal(Packet *pkt) {
+  pkt->header.version = PACKET_PROTOCOL_VERSION;
+  pkt->header.type = Packet::TYPE;
+  pkt->checksum =
+      packetChecksum((const uint8_t *)pkt, offsetof(Packet, checksum));
+}
+
+// Message type of a received buffer, or 0 if it isn't a current-protocol
+// packet. Use it to pick the view to decode with.
+inline uint8_t packetType(const uint8_t *data, size_t len) {
+  if (len < sizeof(PacketHeader) || data[0] != PACKET_PROTOCOL_VERSION)
+    return 0;
+  return data[1];
+}
+
+// ============================================================================
+// GENERATORS
+// ============================================================================
+#define PACKET_FIELD_DECL(P, type, name, offset) type name;
+
+#define PACKET_FIELD_SIZE(P, type, name, offset) sizeof(type) +
+
+#define PACKET_FIELD_CHECK(P, type, name, offset)                             \
+  static_assert(offsetof(P, name) == (offset),                               \
+                #P "." #name " is not at its wire offset");
+
+#define PACKET_VIEW_GETTER(P, type, name, offset)                             \
+  type name() const { return packetRead<type>(data_, offset); }
+
+// Declares struct Name (what a sender fills in) and class NameView (what a
+// receiver decodes with), checking the layout at compile time.
+#define DEFINE_PACKET(Name, typeId, FIELDS)                                   \
+  struct __attribute__((packed)) Name {                                       \
+    static const uint8_t TYPE = typeId;                                       \
+    PacketHeader header;                                                      \
+    FIELDS(PACKET_FIELD_DECL, Name)                                           \
+    uint8_t checksum; /* XOR of all previous bytes */                         \
+  };                                                                          \
+  FIELDS(PACKET_FIELD_CHECK, Name)                                            \
+  static_assert(sizeof(Name) ==                                               \
+                    sizeof(PacketHeader) + FIELDS(PACKET_FIELD_SIZE, Name) 1, \
+                #Name " has padding or overlapping fields");                  \
+  static_assert(sizeof(Name) <= MAX_ESPNOW_DATA_LEN,                          \
+                #Name " exceeds ESP-NOW max payload");                        \
+                                                                              \
+  class Name##View {                                                          \
+  public:                                                                     \
+    /* Length, version, type and checksum are checked once here */           \
+    Name##View(const uint8_t *data, size_t len)                               \
+        : data_(data), valid_(len == sizeof(Name) &&                          \
+                              packetType(data, len) == typeId &&              \
+                              data[offsetof(Name, checksum)] ==               \
+                                  packetChecksum(                             \
+                                      data, offsetof(Name, checksum))) {}     \
+    bool valid() const { return valid_; }                                     \
+    FIELDS(PACKET_VIEW_GETTER, Name)                                          \
+                                                                              \
+  private:                                                                    \
+    const uint8_t *data_;                                                     \
+    bool valid_;                                                              \
+  };
+
+DEFINE_PACKET(TempDataPacket, MSG_TYPE_OIL, TEMP_DATA_PACKET_FIELDS)
+DEFINE_PACKET(FuelDataPacket, MSG_TYPE_FUEL, FUEL_DATA_PACKET_FIELDS)
+DEFINE_PACKET(TimeBeaconPacket, MSG_TYPE_TIME_BEACON, TIME_BEACON_FIELDS)
+DEFINE_PACKET(PairRequestPacket, MSG_TYPE_PAIR_REQUEST, PAIR_REQUEST_FIELDS)
+DEFINE_PACKET(PairAcceptPacket, MSG_TYPE_PAIR_ACCEPT, PAIR_ACCEPT_FIELDS)
+DEFINE_PACKET(NackPacket, MSG_TYPE_NACK, NACK_FIELDS)
+DEFINE_PACKET(TelemetryPacket, MSG_TYPE_TELEMETRY, TELEMETRY_FIELDS)
+
+// Link fields of a valid data packet. Returns false for any other buffer.
+inline bool packetLinkFields(const uint8_t *data, size_t len, uint8_t *flags,
+                             uint8_t *eventSeq, uint16_t *seq) {
+  switch (packetType(data, len)) {
+  case MSG_TYPE_OIL: {
+    TempDataPacketView oil(data, len);
+    if (!oil.valid())
+      return false;
+    *flags = oil.linkFlags();
+    *eventSeq = oil.eventSeq();
+    *seq = oil.sequenceNumber();
+    return true;
+  }
+  case MSG_TYPE_FUEL: {
+    FuelDataPacketView fuel(data, len);
+    if (!fuel.valid())
+      return false;
+    *flags = fuel.linkFlags();
+    *eventSeq = fuel.eventSeq();
+    *seq = fuel.sequence_number();
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+// ============================================================================
+// CARRIED HISTORY
+// ============================================================================
+// prevN fields hold the reading sent N packets ago, aged relative to this
+// packet's timestamp. Age 0 marks an empty slot (just after boot).
+
+#define PACKET_HISTORY_DEPTH 2
+
+inline uint16_t packetHistoryAge(uint32_t ms) {
+  if (ms == 0)
+    return 1; // 0 means empty
+  return ms > 0xFFFF ? 0xFFFF : (uint16_t)ms;
+}
+
+// Older slot's age once another elapsedMs has passed
+inline uint16_t packetHistoryAge(uint16_t ageMs, uint32_t elapsedMs) {
+  return ageMs ? packetHistoryAge(ageMs + elapsedMs) : 0;
+}
+
+// Value in tenths, saturated to the field. NaN (sensor fault) becomes 0, the
+// fault byte beside it says why.
+inline int16_t packetDeci(float value) {
+  if (!(value == value))
+    return 0;
+  const float deci = value * 10.0f + (value < 0 ? -0.5f : 0.5f);
+  return deci >= 32767 ? 32767 : deci <= -32768 ? -32768 : (int16_t)deci;
+}
+
+inline uint16_t packetDeciUnsigned(float value) {
+  if (!(value > 0))
+    return 0;
+  const float deci = value * 10.0f + 0.5f;
+  return deci >= 65535 ? 65535 : (uint16_t)deci;
+}
+
+// Fill pkt's history from prev, the packet sent before it, whose reading was
+// sampled elapsedMs earlier. Call before sealing.
+inline void packetCarryHistory(TempDataPacket *pkt, const TempDataPacket &prev,
+                               uint32_t elapsedMs) {
+  pkt->prev2AgeMs = packetHistoryAge(prev.prev1AgeMs, elapsedMs);
+  pkt->prev2OilTemp = prev.prev1OilTemp;
+  pkt->prev2OilPressure = prev.prev1OilPressure;
+  pkt->prev2OilFault = prev.prev1OilFault;
+  pkt->prev1AgeMs = packetHistoryAge(elapsedMs);
+  pkt->prev1OilTemp = packetDeci(prev.oilTemperature);
+  pkt->prev1OilPressure = packetDeciUnsigned(prev.oilPressure);
+  pkt->prev1OilFault = prev.oilFaultStatus;
+}
+
+inline void packetCarryHistory(FuelDataPacket *pkt, const FuelDataPacket &prev,
+                               uint32_t elapsedMs) {
+  pkt->prev2AgeMs = packetHistoryAge(prev.prev1AgeMs, elapsedMs);
+  pkt->prev2Percent = prev.prev1Percent;
+  pkt->prev2Faults = prev.prev1Faults;
+  pkt->prev1AgeMs = packetHistoryAge(elapsedMs);
+  pkt->prev1Percent = prev.fuel_percent;
+  pkt->prev1Faults = prev.fault_status;
+}
+
+// ============================================================================
+// TRANSMIT WINDOW
+// ============================================================================
+// faultAgeMs: how long before the packet's timestamp the first faulted
+// sample since the last packet was taken, 0 if none was. A fault that
+// cleared before the packet went out shows here and not in the fault byte.
+
+inline uint16_t packetFaultAge(bool faulted, uint32_t ageMs) {
+  return faulted ? packetHistoryAge(ageMs) : 0;
+}
+
+#endif // VEHICLE_PACKETS_H
@@ -0,0 +1,66 @@
+#ifndef WINDOW_STATS_H
+#define WINDOW_STATS_H
+
+#include <stdint.h>
+
+// ============================================================================
+// TRANSMIT WINDOW STATISTICS
+// ============================================================================
+// Min, max and mean of one channel's samples since the last packet, so a
+// spike or dip between transmits reaches the receivers without a higher
+// packet rate. Each sample costs a few compares and an add; the sender
+// sends the result and calls reset() when it transmits.
+//
+// Faulted samples are counted apart and kept out of the statistics; the
+// first one's time is kept so receivers learn of a fault that cleared
+// before the packet went out.
+//
+// No Arduino dependencies.
+
+class WindowStats {
+public:
+  WindowStats() { reset(); }
+
+  void reset() {
+    samples = 0;
+    faults = 0;
+    lo = 0;
+    hi = 0;
+    sum = 0;
+    faultMs = 0;
+  }
+
+  void add(float value) {
+    if (samples == 0 || value < lo)
+      lo = value;
+    if (samples == 0 || value > hi)
+      hi = value;
+    sum += value;
+    samples++;
+  }
+
+  // A sample that couldn't be read, taken at nowMs
+  void fault(uint32_t nowMs) {
+    if (faults == 0)
+      faultMs = nowMs;
+    faults++;
+  }
+
+  // Fault-free and faulted samples, saturated to a packet byte
+  uint8_t count() const { return samples > 0xFF ? 0xFF : samples; }
+  uint8_t faultCount() const { return faults > 0xFF ? 0xFF : faults; }
+  float min() const { return lo; }
+  float max() const { return hi; }
+  float mean() const { return samples ? sum / samples : 0; }
+  uint32_t firstFaultMs() const { return faultMs; } // Valid if faultCount()
+
+private:
+  uint32_t samples;
+  uint32_t faults;
+  float lo;
+  float hi;
+  float sum;
+  uint32_t faultMs;
+};
+
+#endif // WINDOW_STATS_H
@@ -1,7 +1,8 @@
 #include <Arduino.h>
 #include <Preferences.h>
+#include <vehicle_packets.h>
+#include <settings_blob.h>
 #include "fuel_config.h"
-#include "fuel_data_packet.h"
 
 // ============================================================================
 // Fuel Sensor Calibration Implementation
@@ -15,7 +16,27 @@ extern float full_ohms_offset;
 extern int low_fuel_threshold;
 extern FuelDataPacket fuel_packet;
 
-static const char* PREFS_NAMESPACE = "fuel_sender";
+void save_calibration();
+void flush_calibration();
+
+// ============================================================================
+// Calibration Storage
+// ============================================================================
+// One CRC-checked blob under PREFS_CALIBRATION_KEY (settings_blob.h) on the
+// sketch's Preferences handle. Bump CALIBRATION_VERSION when the layout
+// changes and migrate the old one in load_calibration().
+
+#define CALIBRATION_VERSION 1
+
+typedef struct {
+  float empty_ohms_offset;
+  float full_ohms_offset;
+  int32_t low_fuel_threshold;
+} CalibrationSettings;
+
+SettingsBlob<CalibrationSettings> calibration_blob(CALIBRATION_VERSION);
+uint32_t calibration_load_us = 0;
+uint32_t calibration_writes = 0;  // Flash writes this boot
 
 // ============================================================================
 // Calibration Data Structure
@@ -104,6 +125,11 @@ void show_calibration_status() {
   
   Serial.print("Fault flags: 0x");
   Serial.println(fuel_packet.fault_status, HEX);
+  
+  Serial.printf("\nStorage: loaded in %lu us, %lu flash writes this boot, %lu lifetime%s\n",
+                (unsigned long)calibration_load_us, (unsigned long)calibration_writes,
+                (unsigned long)calibration_blob.saves(),
+                calibration_blob.pending() ? " (unsaved changes)" : "");
 }
 
 /**
@@ -159,7 +185,7 @@ void calibrate_two_point() {
   // Save to preferences
   save_calibration();
   
-  Serial.println("Calibration saved to flash.");
+  Serial.println("Calibration updated (saved on leaving this menu).");
 }
 
 /**
@@ -210,7 +236,7 @@ void calibrate_single_point() {
   }
   
   save_calibration();
-  Serial.println("Calibration saved.");
+  Serial.println("Calibration updated (saved on leaving this menu).");
 }
 
 /**
@@ -247,7 +273,7 @@ void adjust_offsets_manual() {
   }
   
   save_calibration();
-  Serial.println("Offsets saved.");
+  Serial.println("Offsets updated (saved on leaving this menu).");
 }
 
 /**
@@ -278,19 +304,109 @@ void configure_low_fuel_threshold() {
   }
 }
 
+// ============================================================================
+// Load / Save
+// ============================================================================
+
+static CalibrationSettings current_calibration() {
+  CalibrationSettings cal;
+  cal.empty_ohms_offset = empty_ohms_offset;
+  cal.full_ohms_offset = full_ohms_offset;
+  cal.low_fuel_threshold = low_fuel_threshold;
+  return cal;
+}
+
 /**
- * Save all calibration data to Preferences (flash)
+ * Calibration from before the blob: one key per value. Copied into the blob,
+ * which is written straight away, then the old keys are removed.
  */
-void save_calibration() {
-  Preferences prefs;
-  prefs.begin(PREFS_NAMESPACE, false);  // false = RW mode
-  
-  prefs.putFloat(PREFS_EMPTY_OFFSET, empty_ohms_offset);
-  prefs.putFloat(PREFS_FULL_OFFSET, full_ohms_offset);
-  prefs.putInt(PREFS_LOW_FUEL_THRESHOLD, low_fuel_threshold);
+static bool migrate_calibration_keys() {
+  if (!prefs.isKey(PREFS_EMPTY_OFFSET) && !prefs.isKey(PREFS_FULL_OFFSET) &&
+      !prefs.isKey(PREFS_LOW_FUEL_THRESHOLD)) {
+    return false;
+  }
+  empty_ohms_offset = prefs.getFloat(PREFS_EMPTY_OFFSET, 0.0);
+  full_ohms_offset = prefs.getFloat(PREFS_FULL_OFFSET, 0.0);
+  low_fuel_threshold = prefs.getInt(PREFS_LOW_FUEL_THRESHOLD, LOW_FUEL_THRESHOLD_PERCENT);
   
-  prefs.end();
-  Serial.println("✓ Calibration saved to flash memory");
+  save_calibration();
+  flush_calibration();
+  if (calibration_blob.pending()) {
+    return true;  // Write failed: keep the old keys for next boot
+  }
+  prefs.remove(PREFS_EMPTY_OFFSET);
+  prefs.remove(PREFS_FULL_OFFSET);
+  prefs.remove(PREFS_LOW_FUEL_THRESHOLD);
+  return true;
+}
+
+/**
+ * Load calibration at boot (prefs must be open)
+ */
+void load_calibration() {
+  uint32_t start = micros();
+  const char* source;
+  CalibrationSettings cal;
+  size_t len = prefs.getBytes(PREFS_CALIBRATION_KEY, calibration_blob.buffer(),
+                              calibration_blob.capacity());
+  switch (calibration_blob.load(len, &cal)) {
+    case SETTINGS_LOADED:
+      empty_ohms_offset = cal.empty_ohms_offset;
+      full_ohms_offset = cal.full_ohms_offset;
+      low_fuel_threshold = cal.low_fuel_threshold;
+      source = "loaded";
+      break;
+    case SETTINGS_MISSING:
+      source = migrate_calibration_keys() ? "migrated from per-value keys" : "defaults";
+      break;
+    case SETTINGS_OTHER_VERSION:
+      // No older layout exists yet; migrate it here when one does
+      source = "unknown layout, defaults";
+      break;
+    default:
+      source = "CRC mismatch, defaults";
+      break;
+  }
+  calibration_load_us = micros() - start;
+  Serial.printf("Calibration: %s in %lu us (%lu lifetime writes)\n", source,
+                (unsigned long)calibration_load_us,
+                (unsigned long)calibration_blob.saves());
+}
+
+/**
+ * Mark calibration changed. The write happens once edits stop
+ * (SETTINGS_SAVE_QUIET_MS), from poll_calibration_save(), or on leaving the
+ * calibration menu.
+ */
+void save_calibration() {
+  calibration_blob.changed(millis());
+}
+
+/**
+ * Write pending calibration now
+ */
+void flush_calibration() {
+  if (!calibration_blob.pending() ||
+      !calibration_blob.prepare(current_calibration())) {
+    return;
+  }
+  if (prefs.putBytes(PREFS_CALIBRATION_KEY, calibration_blob.image(),
+                     calibration_blob.size()) == calibration_blob.size()) {
+    calibration_blob.committed();
+    calibration_writes++;
+    Serial.println("✓ Calibration saved to flash memory");
+  } else {
+    calibration_blob.failed(millis());
+  }
+}
+
+/**
+ * Call from loop(): writes calibration once edits have stopped
+ */
+void poll_calibration_save() {
+  if (calibration_blob.due(millis())) {
+    flush_calibration();
+  }
 }
 
 /**
@@ -347,6 +463,7 @@ void calibration_menu() {
         
       case '7':
         in_menu = false;
+        flush_calibration();
         Serial.println("Exiting calibration menu...\n");
         break;
         
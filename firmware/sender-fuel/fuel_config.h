@@ -49,6 +49,9 @@
 
 // Low Fuel Warning
 #define LOW_FUEL_THRESHOLD_PERCENT 15    // Alert when fuel drops below this %
+#define LOW_FUEL_HYSTERESIS_PERCENT 3    // Clears this far above the threshold
+#define LOW_FUEL_RAISE_MS 15000          // Below the threshold this long (slosh)
+#define LOW_FUEL_CLEAR_MS 15000          // ...and back above it this long
 
 // Serial Configuration
 #define SERIAL_BAUD 115200
@@ -63,15 +66,17 @@
 // ESP-NOW Configuration
 #define ESPNOW_WIFI_CHANNEL 1            // Same channel as oil sender
 #define ESPNOW_TRANSMIT_INTERVAL_MS 1000 // 1 Hz transmission
-#define ESPNOW_RETRY_ATTEMPTS 3
-#define ESPNOW_RETRY_DELAY_MS 50
 
-// CYD Display MAC Address (receiver)
-// This is the MAC of the Cheap Yellow Display that receives fuel packets
-#define CYD_MAC_ADDR {0x08, 0xD1, 0xF9, 0x2A, 0x0B, 0xBC}
+// Link group: packets are broadcast and any receiver (CYD, second display,
+// logger) asking for this group pairs automatically. Same on every unit in
+// the vehicle.
+#define LINK_GROUP_ID 1
 
 // Preferences (Non-volatile storage)
 #define PREFS_NAMESPACE "fuel_sender"
+#define PREFS_CALIBRATION_KEY "cal"                 // Calibration blob (settings_blob.h)
+#define PREFS_RECEIVERS_KEY "rx"                    // Receivers paired last boot
+// Per-value keys from before the blob; migrated and removed on boot
 #define PREFS_EMPTY_OFFSET "fuel_empty_offset"      // Calibration offset for empty
 #define PREFS_FULL_OFFSET "fuel_full_offset"        // Calibration offset for full
 #define PREFS_LOW_FUEL_THRESHOLD "low_fuel_thresh"  // Configurable low fuel alert
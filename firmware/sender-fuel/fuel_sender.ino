@@ -1,8 +1,15 @@
 #include <esp_now.h>
 #include <WiFi.h>
 #include <Preferences.h>
+#include <esp_timer.h>
+#include <vehicle_packets.h>
+#include <clock_sync.h>
+#include <link_espnow.h>
+#include <packet_link.h>
+#include <settings_blob.h>
+#include <alarm_engine.h>
+#include <window_stats.h>
 #include "fuel_config.h"
-#include "fuel_data_packet.h"
 
 // ============================================================================
 // Global Variables
@@ -10,6 +17,8 @@
 
 Preferences prefs;
 FuelDataPacket fuel_packet;
+int64_t fuel_packet_sample_us = 0;  // last_sample_us when fuel_packet was built
+bool fuel_packet_built = false;
 uint16_t sequence_counter = 0;
 float smoothed_resistance = 0.0;
 uint32_t last_sample_time = 0;
@@ -22,8 +31,39 @@ float empty_ohms_offset = 0.0;
 float full_ohms_offset = 0.0;
 int low_fuel_threshold = LOW_FUEL_THRESHOLD_PERCENT;
 
-// MAC address of CYD display (receiver)
-uint8_t cyd_mac[6] = CYD_MAC_ADDR;
+// Broadcast link: receivers in LINK_GROUP_ID pair with us, no MAC config
+LinkSender radio_link;
+uint8_t last_sent_faults = FUEL_FAULT_NONE;  // To send fault changes as events
+
+// Low fuel alarm (alarm_engine.h): hysteresis and a debounce long enough to
+// ride out slosh under braking and cornering. Its bit is FUEL_FAULT_LOW_FUEL.
+AlarmEngine fuel_alarms;
+
+// Every sample since the last packet, sent as its min/max/mean
+WindowStats fuel_window;
+
+// Clock sync with the CYD's time beacon. The receive callback only stores
+// the beacon; loop() feeds it to the filter.
+ClockSync display_clock;
+volatile bool beacon_pending = false;
+volatile uint32_t beacon_display_ms = 0;
+volatile int64_t beacon_local_us = 0;
+int64_t last_sample_us = 0;  // esp_timer time of the latest ADC read
+
+// Receivers paired last boot, kept in NVS so a restart sends at once instead
+// of waiting for their next pair request (up to LINK_ANNOUNCE_MS)
+#define RECEIVERS_VERSION 1
+typedef struct {
+  uint8_t count;
+  uint8_t macs[LINK_MAX_RECEIVERS][6];
+} ReceiverList;
+SettingsBlob<ReceiverList> receiver_blob(RECEIVERS_VERSION);
+ReceiverList known_receivers = {};
+uint32_t last_pair_count = 0;
+
+// Boot timing, ms since reset
+uint32_t boot_setup_ms = 0;
+uint32_t first_transmit_ms = 0;
 
 // ============================================================================
 // Function Declarations
@@ -37,7 +77,15 @@ uint8_t resistance_to_percent(float resistance);
 void update_fuel_packet();
 void transmit_fuel_packet();
 void on_espnow_sent(const uint8_t *mac_addr, esp_now_send_status_t status);
+void on_espnow_recv(const esp_now_recv_info_t *info, const uint8_t *data, int len);
 void process_serial_menu();
+void calibration_menu();  // fuel_calibration.cpp
+void load_calibration();  // fuel_calibration.cpp
+void save_calibration();  // fuel_calibration.cpp
+void poll_calibration_save();  // fuel_calibration.cpp
+void restore_receivers();
+void remember_receivers();
+void check_low_fuel(uint32_t now);
 
 // ============================================================================
 // Setup & Initialization
@@ -46,7 +94,6 @@ void process_serial_menu();
 void setup() {
   // Serial for debugging and calibration menu
   Serial.begin(SERIAL_BAUD);
-  delay(100);
   
   Serial.println("\n\n=== Fuel Sender Initialized ===");
   Serial.println("1972 VW Superbeetle Fuel Level Monitor");
@@ -57,7 +104,13 @@ void setup() {
   init_preferences();
   init_espnow();
   
+  // Sample and transmit on the first loop() pass
+  last_sample_time = millis() - SAMPLE_INTERVAL_MS;
+  last_transmit_time = millis() - ESPNOW_TRANSMIT_INTERVAL_MS;
+  
   Serial.println("Setup complete. Type 'menu' for calibration options.\n");
+  boot_setup_ms = millis();
+  Serial.printf("Boot: setup done at %lu ms\n", (unsigned long)boot_setup_ms);
 }
 
 // ============================================================================
@@ -72,9 +125,28 @@ void loop() {
     process_serial_menu();
   }
   
+  // Write calibration once edits stop
+  poll_calibration_save();
+  
+  // Answer pair requests and repeat NACKed events
+  radio_link.poll(now);
+  if (radio_link.pairCount() != last_pair_count) {
+    // Remember the receiver for next boot, and send it a reading now
+    last_pair_count = radio_link.pairCount();
+    remember_receivers();
+    last_transmit_time = now - ESPNOW_TRANSMIT_INTERVAL_MS;
+  }
+  
+  // Apply a time beacon stored by the receive callback
+  if (beacon_pending) {
+    display_clock.onBeacon(beacon_display_ms, beacon_local_us);
+    beacon_pending = false;
+  }
+  
   // Read ADC and smooth resistance value
   if (now - last_sample_time >= SAMPLE_INTERVAL_MS) {
     last_sample_time = now;
+    last_sample_us = esp_timer_get_time();
     
     float raw_resistance = read_fuel_resistance();
     
@@ -87,6 +159,15 @@ void loop() {
       smoothed_resistance = (FUEL_SMOOTHING_ALPHA * raw_resistance) + 
                            ((1.0 - FUEL_SMOOTHING_ALPHA) * smoothed_resistance);
     }
+    
+    if (smoothed_resistance <= FUEL_FAULT_OPEN_CIRCUIT_OHMS &&
+        smoothed_resistance >= FUEL_FAULT_SHORT_CIRCUIT_OHMS) {
+      fuel_window.add(resistance_to_percent(smoothed_resistance));
+    } else {
+      fuel_window.fault((uint32_t)(last_sample_us / 1000));
+    }
+    
+    check_low_fuel(now);
   }
   
   // Transmit packet at 1 Hz
@@ -94,6 +175,7 @@ void loop() {
     last_transmit_time = now;
     update_fuel_packet();
     transmit_fuel_packet();
+    fuel_window.reset();
   }
   
   // Update local OLED display (if enabled)
@@ -126,17 +208,16 @@ void init_adc() {
 void init_preferences() {
   prefs.begin(PREFS_NAMESPACE, false);  // false = RW mode
   
-  // Load calibration offsets from flash
-  empty_ohms_offset = prefs.getFloat(PREFS_EMPTY_OFFSET, 0.0);
-  full_ohms_offset = prefs.getFloat(PREFS_FULL_OFFSET, 0.0);
-  low_fuel_threshold = prefs.getInt(PREFS_LOW_FUEL_THRESHOLD, LOW_FUEL_THRESHOLD_PERCENT);
+  // Load calibration offsets from flash (one blob, migrating old keys)
+  load_calibration();
   
   Serial.print("Loaded calibration - Empty offset: ");
   Serial.print(empty_ohms_offset);
   Serial.print(" Ω, Full offset: ");
   Serial.print(full_ohms_offset);
   Serial.print(" Ω, Low fuel threshold: ");
-  Serial.println(low_fuel_threshold + "%");
+  Serial.print(low_fuel_threshold);
+  Serial.println("%");
 }
 
 // ============================================================================
@@ -155,27 +236,71 @@ void init_espnow() {
     return;
   }
   
-  // Register send callback
+  // Register send callback, and receive callback for link frames and the
+  // CYD time beacon
   esp_now_register_send_cb(on_espnow_sent);
+  esp_now_register_recv_cb(on_espnow_recv);
   
-  // Add CYD display as peer
-  esp_now_peer_info_t peer_info = {};
-  memcpy(peer_info.peer_addr, cyd_mac, 6);
-  peer_info.channel = ESPNOW_WIFI_CHANNEL;
-  peer_info.encrypt = false;
-  
-  if (esp_now_add_peer(&peer_info) != ESP_OK) {
-    Serial.println("ERROR: Failed to add CYD display peer!");
+  // Broadcast peer; receivers are added as they pair
+  if (!radio_link.begin(&LINK_ESPNOW, LINK_GROUP_ID, MSG_TYPE_FUEL)) {
+    Serial.println("ERROR: Failed to add broadcast peer!");
     return;
   }
   
-  Serial.println("ESP-NOW initialized, CYD display peer added");
-  Serial.print("  CYD MAC: ");
-  for (int i = 0; i < 6; i++) {
-    Serial.printf("%02X", cyd_mac[i]);
-    if (i < 5) Serial.print(":");
+  Serial.print("ESP-NOW initialized, link group ");
+  Serial.print(LINK_GROUP_ID);
+  Serial.println(", waiting for receivers to pair");
+  
+  restore_receivers();
+}
+
+/**
+ * Pair again with the receivers saved last boot (prefs must be open)
+ */
+void restore_receivers() {
+  size_t len = prefs.getBytes(PREFS_RECEIVERS_KEY, receiver_blob.buffer(),
+                              receiver_blob.capacity());
+  if (receiver_blob.load(len, &known_receivers) != SETTINGS_LOADED) {
+    memset(&known_receivers, 0, sizeof(known_receivers));
+    return;
+  }
+  int restored = 0;
+  for (int i = 0; i < known_receivers.count && i < LINK_MAX_RECEIVERS; i++) {
+    if (radio_link.addReceiver(known_receivers.macs[i], 0, millis())) {
+      restored++;
+    }
+  }
+  Serial.printf("%d receiver(s) restored from last boot\n", restored);
+}
+
+/**
+ * Save the paired receivers if a new one joined. Pairings are rare, so this
+ * writes straight away.
+ */
+void remember_receivers() {
+  ReceiverList list = {};
+  for (int i = 0; i < LINK_MAX_RECEIVERS; i++) {
+    if (radio_link.receiver(i).active) {
+      memcpy(list.macs[list.count++], radio_link.receiver(i).mac, 6);
+    }
+  }
+  // Keep remembered receivers that are off right now, after the live ones
+  for (int i = 0; i < known_receivers.count && list.count < LINK_MAX_RECEIVERS; i++) {
+    bool live = false;
+    for (int j = 0; j < list.count && !live; j++) {
+      live = memcmp(list.macs[j], known_receivers.macs[i], 6) == 0;
+    }
+    if (!live) {
+      memcpy(list.macs[list.count++], known_receivers.macs[i], 6);
+    }
+  }
+  known_receivers = list;
+  receiver_blob.changed(millis());
+  if (receiver_blob.prepare(known_receivers) &&
+      prefs.putBytes(PREFS_RECEIVERS_KEY, receiver_blob.image(),
+                     receiver_blob.size()) == receiver_blob.size()) {
+    receiver_blob.committed();
   }
-  Serial.println();
 }
 
 // ============================================================================
@@ -206,8 +331,14 @@ float read_fuel_resistance() {
   // Calculate resistance using voltage divider formula
   float resistance = VOLTAGE_DIVIDER_SERIES * voltage / (VOLTAGE_DIVIDER_VCC - voltage);
   
-  // Clamp to valid range
-  resistance = constrain(resistance, FUEL_CLAMP_MIN_OHMS, FUEL_CLAMP_MAX_OHMS);
+  // Out of range is a wiring fault: keep it past the fault limits rather
+  // than clamping onto them, where the smoothed value would never cross
+  if (resistance > FUEL_CLAMP_MAX_OHMS) {
+    return FUEL_CLAMP_MAX_OHMS * 1.5;
+  }
+  if (resistance < FUEL_CLAMP_MIN_OHMS) {
+    return 0;
+  }
   
   return resistance;
 }
@@ -250,6 +381,47 @@ uint8_t resistance_to_percent(float resistance) {
   return (uint8_t)round(fuel_percent);
 }
 
+// ============================================================================
+// Low Fuel Alarm
+// ============================================================================
+
+/**
+ * Run the low fuel rule on the latest sample. The rule is rebuilt from
+ * low_fuel_threshold each time (it keeps its state), so a threshold changed
+ * in the calibration menu applies at once. A change is sent straight away.
+ */
+void check_low_fuel(uint32_t now) {
+  AlarmRule rule = {};
+  rule.bit = FUEL_FAULT_LOW_FUEL;
+  rule.input = 0;
+  rule.kind = ALARM_BELOW;
+  rule.limit = low_fuel_threshold;
+  rule.hysteresis = LOW_FUEL_HYSTERESIS_PERCENT;
+  rule.raiseMs = LOW_FUEL_RAISE_MS;
+  rule.clearMs = LOW_FUEL_CLEAR_MS;
+  rule.gate = ALARM_NO_GATE;
+  fuel_alarms.set(0, rule);
+  
+  // A wiring fault is reported as such, and holds the alarm where it is
+  float percent = NAN;
+  if (smoothed_resistance <= FUEL_FAULT_OPEN_CIRCUIT_OHMS &&
+      smoothed_resistance >= FUEL_FAULT_SHORT_CIRCUIT_OHMS) {
+    percent = resistance_to_percent(smoothed_resistance);
+  }
+  fuel_alarms.evaluate(&percent, now);
+  if (!fuel_alarms.changed()) {
+    return;
+  }
+  last_transmit_time = now - ESPNOW_TRANSMIT_INTERVAL_MS;
+  if (fuel_alarms.active() & FUEL_FAULT_LOW_FUEL) {
+    Serial.printf("Alarm: LOW FUEL raised, below %d%% for %lu ms\n",
+                  low_fuel_threshold,
+                  (unsigned long)(now - fuel_alarms.state(0).onsetMs));
+  } else {
+    Serial.println("Alarm: LOW FUEL cleared");
+  }
+}
+
 // ============================================================================
 // Packet Update & Transmission
 // ============================================================================
@@ -258,9 +430,18 @@ uint8_t resistance_to_percent(float resistance) {
  * Update fuel_packet with current sensor data and fault status
  */
 void update_fuel_packet() {
-  // Version and timestamp
-  fuel_packet.version = 1;
-  fuel_packet.timestamp = millis();
+  // The reading being replaced goes out again as history, so receivers
+  // rebuild a lost frame from the next one
+  const FuelDataPacket previous = fuel_packet;
+
+  // Timestamp of the latest ADC read, in CYD time once its beacon is heard
+  if (display_clock.synced(esp_timer_get_time())) {
+    fuel_packet.timestamp = display_clock.toDisplayMs(last_sample_us);
+    fuel_packet.timeSource = TIME_SOURCE_DISPLAY;
+  } else {
+    fuel_packet.timestamp = (uint32_t)(last_sample_us / 1000);
+    fuel_packet.timeSource = TIME_SOURCE_SENDER;
+  }
   
   // Raw resistance (clamped to valid range)
   float clamped_resistance = constrain(smoothed_resistance, FUEL_CLAMP_MIN_OHMS, FUEL_CLAMP_MAX_OHMS);
@@ -279,44 +460,54 @@ void update_fuel_packet() {
     fuel_packet.fault_status |= FUEL_FAULT_SHORT_CIRCUIT;
   }
   
-  if (fuel_packet.fuel_percent < low_fuel_threshold) {
-    fuel_packet.fault_status |= FUEL_FAULT_LOW_FUEL;
-  }
   #endif
   
+  // Raised per sample by check_low_fuel()
+  fuel_packet.fault_status |= fuel_alarms.active() & FUEL_FAULT_LOW_FUEL;
+  
+  // Samples taken since the last packet
+  fuel_packet.windowSamples = fuel_window.count();
+  fuel_packet.percentMin = (uint8_t)round(fuel_window.min());
+  fuel_packet.percentMax = (uint8_t)round(fuel_window.max());
+  fuel_packet.percentMean = packetDeciUnsigned(fuel_window.mean());
+  fuel_packet.faultAgeMs = packetFaultAge(
+      fuel_window.faultCount() > 0,
+      (uint32_t)(last_sample_us / 1000) - fuel_window.firstFaultMs());
+  
   // Sequence number
   fuel_packet.sequence_number = sequence_counter++;
   
-  // Calculate checksum
-  const uint8_t* pkt_bytes = (const uint8_t*)&fuel_packet;
-  fuel_packet.checksum = 0;
-  for (size_t i = 0; i < offsetof(FuelDataPacket, checksum); i++) {
-    fuel_packet.checksum ^= pkt_bytes[i];
+  // Previous two readings
+  if (fuel_packet_built) {
+    packetCarryHistory(&fuel_packet, previous,
+                       (uint32_t)((last_sample_us - fuel_packet_sample_us) / 1000));
   }
+  fuel_packet_sample_us = last_sample_us;
+  fuel_packet_built = true;
+  
+  // Link fields, header and checksum. Fault changes (including low fuel)
+  // are events, which receivers NACK if the broadcast is lost.
+  bool event = fuel_packet.fault_status != last_sent_faults;
+  last_sent_faults = fuel_packet.fault_status;
+  radio_link.seal(&fuel_packet, event);
 }
 
 /**
- * Transmit fuel_packet via ESP-NOW with retry logic
+ * Broadcast fuel_packet to paired receivers. Sent once: if it is lost, the
+ * next packet carries its reading, so the loop never blocks on retries.
  */
 void transmit_fuel_packet() {
-  uint8_t retry_count = 0;
-  esp_err_t result = ESP_FAIL;
-  
-  while (retry_count < ESPNOW_RETRY_ATTEMPTS && result != ESP_OK) {
-    result = esp_now_send(cyd_mac, (uint8_t *)&fuel_packet, sizeof(FuelDataPacket));
-    
-    if (result != ESP_OK) {
-      retry_count++;
-      if (retry_count < ESPNOW_RETRY_ATTEMPTS) {
-        delay(ESPNOW_RETRY_DELAY_MS);
-      }
-    }
+  if (radio_link.receiverCount() == 0) {
+    return;  // Nobody paired yet
   }
   
-  if (result != ESP_OK) {
-    Serial.print("ERROR: ESP-NOW send failed (");
-    Serial.print(result);
-    Serial.println(")");
+  if (!radio_link.send(&fuel_packet)) {
+    Serial.println("ERROR: ESP-NOW send failed (radio queue full)");
+    return;
+  }
+  if (first_transmit_ms == 0) {
+    first_transmit_ms = millis();
+    Serial.printf("Boot: first packet sent at %lu ms\n", (unsigned long)first_transmit_ms);
   }
 }
 
@@ -330,6 +521,24 @@ void on_espnow_sent(const uint8_t *mac_addr, esp_now_send_status_t status) {
   }
 }
 
+/**
+ * ESP-NOW receive callback (link frames, CYD time beacon)
+ * Only stores the beacon; loop() feeds it to the clock filter
+ */
+void on_espnow_recv(const esp_now_recv_info_t *info, const uint8_t *data, int len) {
+  const int64_t now_us = esp_timer_get_time();
+  if (radio_link.receive(info->src_addr, data, len)) {
+    return;  // Pair request or NACK, handled in loop()
+  }
+  TimeBeaconPacketView beacon(data, len);
+  if (!beacon.valid() || beacon_pending) {
+    return;
+  }
+  beacon_display_ms = beacon.displayMs();
+  beacon_local_us = now_us;
+  beacon_pending = true;
+}
+
 // ============================================================================
 // Serial Calibration Menu
 // ============================================================================
@@ -355,18 +564,26 @@ void process_serial_menu() {
     Serial.print("% | Faults: 0x");
     Serial.print(fuel_packet.fault_status, HEX);
     Serial.print(" | Seq: ");
-    Serial.println(fuel_packet.sequence_number);
+    Serial.print(fuel_packet.sequence_number);
+    Serial.print(" | Receivers: ");
+    Serial.println(radio_link.receiverCount());
+    if (display_clock.synced(esp_timer_get_time())) {
+      Serial.printf("Clock: offset %.1f ms, drift %.1f ppm\n",
+                    display_clock.offset(), display_clock.drift());
+    } else {
+      Serial.println("Clock: waiting for display beacon");
+    }
+    Serial.printf("Boot: setup done at %lu ms, first packet at %lu ms\n",
+                  (unsigned long)boot_setup_ms, (unsigned long)first_transmit_ms);
     
   } else if (input == "cal") {
     calibration_menu();
     
   } else if (input == "reset") {
-    prefs.remove(PREFS_EMPTY_OFFSET);
-    prefs.remove(PREFS_FULL_OFFSET);
-    prefs.remove(PREFS_LOW_FUEL_THRESHOLD);
     empty_ohms_offset = 0.0;
     full_ohms_offset = 0.0;
     low_fuel_threshold = LOW_FUEL_THRESHOLD_PERCENT;
+    save_calibration();
     Serial.println("Calibration reset to defaults");
     
   } else if (input == "help" || input == "menu") {
@@ -374,20 +591,4 @@ void process_serial_menu() {
   }
 }
 
-/**
- * Interactive calibration menu
- */
-void calibration_menu() {
-  Serial.println("\n--- Calibration Mode ---");
-  Serial.println("Measure fuel sender resistance at known levels:");
-  Serial.println();
-  
-  Serial.println("1. Empty tank test:");
-  Serial.println("   Connect fuel sender when tank is EMPTY (73 Ω nominal)");
-  Serial.println("   Resistance reading: ");
-  // TODO: Implement interactive calibration
-  
-  Serial.println("\nNote: Use 'status' to monitor live resistance readings");
-  Serial.println("Type 'exit' to return to main menu");
-}
 
@@ -0,0 +1,128 @@
+#include "alarms.h"
+#include "config.h"
+#include "settings.h"
+#include <vehicle_packets.h>
+
+AlarmEngine oilAlarms;
+
+static uint32_t rulesRevision = 0;
+static bool haveRules = false;
+
+// Clear bands, so a reading sitting on a limit doesn't flicker
+#define TEMP_HYSTERESIS_C 3.0f
+#define PRESS_HYSTERESIS_PSI 2.0f
+#define HEAD_HYSTERESIS_C 5.0f
+
+// Smoothing of the rate rules: long for temperature (a slow trend), short
+// for a pressure drop (a failing pump or pickup loses it in one sample)
+#define TEMP_RISE_RATE_MS 30000
+#define PRESS_DROP_RATE_MS 250
+
+static AlarmRule rule(uint16_t bit, uint8_t input, AlarmKind kind,
+                      float limit, float hysteresis) {
+  AlarmRule r = {};
+  r.bit = bit;
+  r.input = input;
+  r.kind = kind;
+  r.limit = limit;
+  r.hysteresis = hysteresis;
+  r.raiseMs = ALARM_RAISE_MS;
+  r.clearMs = ALARM_CLEAR_MS;
+  r.gate = ALARM_NO_GATE;
+  return r;
+}
+
+static AlarmRule gated(AlarmRule r, uint8_t gate, float gateMin,
+                       float gateMax = INFINITY) {
+  r.gate = gate;
+  r.gateMin = gateMin;
+  r.gateMax = gateMax;
+  return r;
+}
+
+void updateAlarmRules() {
+  if (haveRules && rulesRevision == SystemSettings.revision())
+    return;
+  rulesRevision = SystemSettings.revision();
+  haveRules = true;
+
+  const float oilLimitC = (SystemSettings.oilTempAlarmHigh - 32.0f) / 1.8f;
+  const float risePerS = ALARM_TEMP_RISE_C_MIN / 60.0f;
+  AlarmRule tempRising =
+      gated(rule(OIL_ALARM_TEMP_RISING, ALARM_IN_OIL_TEMP, ALARM_RISING,
+                 risePerS, risePerS / 2),
+            ALARM_IN_OIL_TEMP, ALARM_TEMP_RISE_FROM_C);
+  tempRising.rateMs = TEMP_RISE_RATE_MS;
+  // A pump or pickup failing is caught by the rate before the level. An
+  // upshift off the relief valve falls as fast, but lands well above
+  // ALARM_PRESS_DROP_TO_PSI. The smoothing is its debounce.
+  AlarmRule pressDrop =
+      gated(rule(OIL_ALARM_PRESS_DROP, ALARM_IN_OIL_PRESS, ALARM_FALLING,
+                 ALARM_PRESS_DROP_PSI_S, ALARM_PRESS_DROP_PSI_S / 2),
+            ALARM_IN_OIL_PRESS, -INFINITY, ALARM_PRESS_DROP_TO_PSI);
+  pressDrop.rateMs = PRESS_DROP_RATE_MS;
+  pressDrop.raiseMs = 0;
+
+  const AlarmRule rules[] = {
+      rule(OIL_ALARM_TEMP_HIGH, ALARM_IN_OIL_TEMP, ALARM_ABOVE, oilLimitC,
+           TEMP_HYSTERESIS_C),
+      tempRising,
+      // Hot oil at idle runs below the low limit, so it only applies moving
+      gated(rule(OIL_ALARM_PRESS_LOW, ALARM_IN_OIL_PRESS, ALARM_BELOW,
+                 SystemSettings.oilPressAlarmLow, PRESS_HYSTERESIS_PSI),
+            ALARM_IN_SPEED, ALARM_MOVING_MPH),
+      rule(OIL_ALARM_PRESS_CRITICAL, ALARM_IN_OIL_PRESS, ALARM_BELOW,
+           ALARM_PRESS_CRITICAL_PSI, PRESS_HYSTERESIS_PSI / 2),
+      rule(OIL_ALARM_PRESS_HIGH, ALARM_IN_OIL_PRESS, ALARM_ABOVE,
+           SystemSettings.oilPressAlarmHigh, PRESS_HYSTERESIS_PSI),
+      pressDrop,
+      rule(OIL_ALARM_HEAD_HIGH, ALARM_IN_HEAD_TEMP, ALARM_ABOVE,
+           TEMP_WARNING_THRESHOLD, HEAD_HYSTERESIS_C),
+      rule(OIL_ALARM_HEAD_CRITICAL, ALARM_IN_HEAD_TEMP, ALARM_ABOVE,
+           TEMP_CRITICAL_THRESHOLD, HEAD_HYSTERESIS_C),
+  };
+  for (size_t i = 0; i < sizeof(rules) / sizeof(rules[0]); i++)
+    oilAlarms.set(i, rules[i]);
+}
+
+const char *alarmName(uint16_t bit) {
+  switch (bit) {
+  case OIL_ALARM_TEMP_HIGH:
+    return "TEMP HIGH";
+  case OIL_ALARM_TEMP_RISING:
+    return "TEMP RISING";
+  case OIL_ALARM_PRESS_LOW:
+    return "PRESS LOW";
+  case OIL_ALARM_PRESS_CRITICAL:
+    return "NO PRESSURE";
+  case OIL_ALARM_PRESS_HIGH:
+    return "PRESS HIGH";
+  case OIL_ALARM_PRESS_DROP:
+    return "PRESS DROP";
+  case OIL_ALARM_HEAD_HIGH:
+    return "HEAD HOT";
+  case OIL_ALARM_HEAD_CRITICAL:
+    return "HEAD CRITICAL";
+  default:
+    return "?";
+  }
+}
+
+void reportAlarms(uint16_t changes, uint32_t nowMs, uint32_t sendUs) {
+  for (int i = 0; i < oilAlarms.size(); i++) {
+    const AlarmRule &r = oilAlarms.rule(i);
+    if (!(changes & r.bit))
+      continue;
+    const AlarmState &s = oilAlarms.state(i);
+    if (s.active && sendUs == ALARM_NOT_SENT)
+      Serial.printf("Alarm: %s raised, condition held %lu ms, no receiver\n",
+                    alarmName(r.bit), (unsigned long)(nowMs - s.onsetMs));
+    else if (s.active)
+      Serial.printf("Alarm: %s raised, condition held %lu ms, sent %lu us "
+                    "after the sample\n",
+                    alarmName(r.bit), (unsigned long)(nowMs - s.onsetMs),
+                    (unsigned long)sendUs);
+    else
+      Serial.printf("Alarm: %s cleared\n", alarmName(r.bit));
+  }
+}
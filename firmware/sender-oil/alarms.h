@@ -0,0 +1,33 @@
+#ifndef ALARMS_H
+#define ALARMS_H
+
+#include <Arduino.h>
+#include <alarm_engine.h>
+
+// The oil sender's alarm rules (alarm_engine.h): oil temperature and
+// pressure limits from Settings, the rest from config.h. loop() evaluates
+// them on every sample and sends a change at once, as an event.
+//
+// Inputs, one float each per sample; NaN when there is no reading:
+#define ALARM_IN_OIL_TEMP 0  // C
+#define ALARM_IN_OIL_PRESS 1 // PSI
+#define ALARM_IN_HEAD_TEMP 2 // C (no head sensor fitted yet: always NaN)
+#define ALARM_IN_SPEED 3     // mph, from the display's time beacon
+#define ALARM_INPUTS 4
+
+extern AlarmEngine oilAlarms;
+
+// (Re)build the rules if Settings were edited since the last call. Alarm
+// state is kept, so changing a limit doesn't re-raise what is already on.
+void updateAlarmRules();
+
+// Short name of one OIL_ALARM_* bit ("PRESS LOW")
+const char *alarmName(uint16_t bit);
+
+// Log the alarms in changes as raised or cleared. sendUs is how long after
+// the sample the packet carrying them was handed to the radio, or
+// ALARM_NOT_SENT if nobody is paired.
+#define ALARM_NOT_SENT 0xFFFFFFFF
+void reportAlarms(uint16_t changes, uint32_t nowMs, uint32_t sendUs);
+
+#endif
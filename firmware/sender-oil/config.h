@@ -39,29 +39,44 @@
 #define DISPLAY_UPDATE_INTERVAL_MS 100 // Update display every 100ms
 
 // ============================================================================
-// ESP-NOW CONFIGURATION
+// BOOT
 // ============================================================================
-#define ESPNOW_CHANNEL 1  // Wi-Fi channel (1-13)
-#define MAX_RETRY_COUNT 3 // Maximum retries for failed transmissions
+// 1: radio and sensors first, the first reading goes out on the first loop()
+// pass and the I2C scan runs in the background. 0: the old bench boot that
+// waits for a serial monitor, shows a splash and scans before starting.
+#define FAST_BOOT 1
 
 // ============================================================================
-// RECEIVER MAC ADDRESS
-// ============================================================================
-// IMPORTANT: You must update this with your receiver's MAC address
-// To get the receiver MAC address:
-// 1. Flash and run the receiver code first
-// 2. Open Serial Monitor on the receiver
-// 3. Copy the MAC address displayed on boot
-// 4. Replace the values below
-// Example: If MAC is AA:BB:CC:DD:EE:FF, use {0xAA, 0xBB, 0xCC, 0xDD, 0xEE,
-// 0xFF}
-extern uint8_t receiverMAC[6]; // Defined in sender_arduino.ino
+// ESP-NOW CONFIGURATION
+// ============================================================================
+#define ESPNOW_CHANNEL 1 // Wi-Fi channel (1-13)
 
 // ============================================================================
-// TEMPERATURE THRESHOLDS (Optional - for future use)
+// LINK GROUP
+// ============================================================================
+// Packets are broadcast; any receiver (CYD, second display, logger) that
+// asks for this group is paired automatically, so no MAC address is needed.
+// Use the same group on every unit in the vehicle, and a different one if
+// another car with this system parks nearby.
+#define LINK_GROUP_ID 1
+
 // ============================================================================
-#define TEMP_WARNING_THRESHOLD 150.0f  // Celsius - warn when exceeded
-#define TEMP_CRITICAL_THRESHOLD 200.0f // Celsius - critical alert
+// ALARMS
+// ============================================================================
+// Evaluated on every sample (alarms.cpp) and sent in the packet's alarms
+// field. The oil temperature and pressure limits are in Settings (console
+// menu); these are the rest.
+#define TEMP_WARNING_THRESHOLD 150.0f  // Celsius - head temp warning
+#define TEMP_CRITICAL_THRESHOLD 200.0f // Celsius - head temp critical
+#define ALARM_RAISE_MS 1000 // A condition must hold this long to raise
+#define ALARM_CLEAR_MS 3000 // ...and be gone this long to clear
+#define ALARM_MOVING_MPH 10.0f      // Low pressure limit applies above this
+#define ALARM_PRESS_CRITICAL_PSI 4.0f // Critical at any speed, idle included
+#define ALARM_PRESS_DROP_PSI_S 30.0f  // Falling faster than this...
+#define ALARM_PRESS_DROP_TO_PSI 20.0f // ...to below this (not a gear change)
+#define ALARM_TEMP_RISE_C_MIN 6.0f    // Climbing faster than this...
+#define ALARM_TEMP_RISE_FROM_C 110.0f // ...once the oil is this hot
+#define SPEED_TIMEOUT_MS 3000 // Beacon speed older than this is unknown
 
 // ============================================================================
 // STATUS LED (Optional)
@@ -1,16 +1,21 @@
 #include "console_menu.h"
+#include "alarms.h"
 #include "config.h"
+#include "i2c_bus.h"
 #include "settings.h"
 #include <Adafruit_ADS1X15.h>
 #include <Adafruit_MAX31856.h>
 #include <WiFi.h>
 #include <Wire.h>
 #include <esp_now.h>
+#include <packet_link.h>
 
 extern Adafruit_MAX31856 max_oil; // Oil Temperature
 extern Adafruit_ADS1115 ads;
 extern Adafruit_ADS1115 ads;
-extern uint8_t receiverMAC[];
+extern LinkSender radioLink;
+extern unsigned long bootSetupMs;
+extern unsigned long firstTransmitMs;
 
 // Helper to clear serial buffer
 void clearSerialInput() {
@@ -55,13 +60,23 @@ void showESPNowMenu() {
   Serial.println("\n--- ESP-NOW SETTINGS ---");
   Serial.print("MAC Address: ");
   Serial.println(WiFi.macAddress());
-  Serial.print("Peer MAC: ");
-  for (int i = 0; i < 6; i++)
-    Serial.printf("%02X%s", receiverMAC[i], (i < 5) ? ":" : "");
-  Serial.println();
   Serial.print("Channel: ");
   Serial.println(ESPNOW_CHANNEL);
-  Serial.println("\n(Editing MAC/Channel requires code rebuild currently)");
+  Serial.print("Link group: ");
+  Serial.println(LINK_GROUP_ID);
+  Serial.printf("Paired receivers: %d\n", radioLink.receiverCount());
+  for (int i = 0; i < LINK_MAX_RECEIVERS; i++) {
+    const LinkPeer &rx = radioLink.receiver(i);
+    if (!rx.active)
+      continue;
+    Serial.print("  ");
+    for (int j = 0; j < 6; j++)
+      Serial.printf("%02X%s", rx.mac[j], (j < 5) ? ":" : "");
+    Serial.println(rx.kind == LINK_ROLE_LOGGER ? " (logger)" : " (display)");
+  }
+  Serial.printf("Event repeats sent: %lu\n",
+                (unsigned long)radioLink.repeatCount());
+  Serial.println("\n(Editing Channel/Group requires code rebuild currently)");
   Serial.println("Press any key to return...");
   while (!Serial.available())
     delay(10);
@@ -103,6 +118,22 @@ void showDeviceStatus() {
 
   // Oil Check Removed
 
+  Serial.printf("Settings: v%d blob, loaded in %lu us, %lu flash writes "
+                "this boot, %lu lifetime%s\n",
+                SETTINGS_VERSION, (unsigned long)SystemSettings.loadMicros(),
+                (unsigned long)SystemSettings.writesThisBoot(),
+                (unsigned long)SystemSettings.lifetimeWrites(),
+                SystemSettings.pending() ? " (edit pending)" : "");
+  Serial.printf("Boot: setup done at %lu ms, first packet at %lu ms\n",
+                bootSetupMs, firstTransmitMs);
+  Serial.printf("Alarms: %d rules, active 0x%04X\n", oilAlarms.size(),
+                oilAlarms.active());
+  Serial.printf("I2C: %lu Hz, %.1f%% busy last second (adc %.1f%%, oled "
+                "%.1f%%, scan %.1f%%)\n",
+                (unsigned long)Wire.getClock(), i2cBus.busyPercent(),
+                i2cBus.busyPercent(I2C_ADC), i2cBus.busyPercent(I2C_OLED),
+                i2cBus.busyPercent(I2C_SCAN));
+
   Serial.println("\nPress any key to return...");
   while (!Serial.available())
     delay(10);
@@ -155,6 +186,8 @@ void showPressureMenu() {
   bool inSubMenu = true;
   while (inSubMenu) {
     int16_t adc = ads.readADC_SingleEnded(0);
+    i2cBus.account(I2C_ADC, I2C_ADS1115_READ_BYTES,
+                   I2C_ADS1115_READ_TRANSACTIONS);
     float volts = ads.computeVolts(adc);
 
     // Voltage Divider Logic Re-calc for display
@@ -272,6 +305,7 @@ void handleConsole() {
     case 'q':
     case 'x':
       Serial.println("Exiting Menu. Resuming Data Log...");
+      SystemSettings.flush(); // Don't leave edits waiting on the timer
       menuMode = false;
       break;
     case 'm':
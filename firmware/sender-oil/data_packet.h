@@ -3,58 +3,9 @@
 
 #include <stdint.h>
 
-// ============================================================================
-// PROTOCOL CONFIGURATION
-// ============================================================================
-// Protocol version for future compatibility
-#define PROTOCOL_VERSION 3
-
-// Maximum ESP-NOW payload: 250 bytes (v1.0) or 1470 bytes (v2.0+)
-// Using conservative size for v1.0 compatibility
-#define MAX_ESPNOW_DATA_LEN 250
-
-// ============================================================================
-// DATA PACKET STRUCTURE
-// ============================================================================
-// Data packet structure for temperature transmission
-// CRITICAL: This structure MUST be IDENTICAL on both sender and receiver!
-typedef struct __attribute__((packed)) {
-  uint8_t version;     // Protocol version (should be PROTOCOL_VERSION)
-  uint32_t timestamp;  // Milliseconds since boot (from millis())
-  float temperature;   // Head Temperature in Celsius
-  float coldJunction;  // Head Cold junction temperature in Celsius
-  uint8_t faultStatus; // Head MAX31856 fault register
-
-  float oilTemperature;   // Oil Temperature in Celsius
-  float oilColdJunction;  // Oil Cold junction temperature in Celsius
-  uint8_t oilFaultStatus; // Oil MAX31856 fault register
-
-  float oilPressure;       // Oil Pressure in PSI
-  uint8_t sensorsStatus;   // Bitmask: Bit 0=Head, 1=Oil Temp, 2=Oil Press
-  uint16_t sequenceNumber; // Packet sequence number (increments each send)
-  uint8_t batteryLevel;    // Battery percentage 0-100 (future use, currently 0)
-  uint8_t checksum;        // Simple XOR checksum for data integrity validation
-} TempDataPacket;
-
-// ============================================================================
-// CHECKSUM FUNCTIONS
-// ============================================================================
-
-// Calculate simple XOR checksum for packet integrity
-inline uint8_t calculateChecksum(const TempDataPacket *packet) {
-  uint8_t checksum = 0;
-  const uint8_t *data = (const uint8_t *)packet;
-  // XOR all bytes except the checksum field itself (last byte)
-  for (size_t i = 0; i < sizeof(TempDataPacket) - 1; i++) {
-    checksum ^= data[i];
-  }
-  return checksum;
-}
-
-// Validate packet checksum
-inline bool validatePacket(const TempDataPacket *packet) {
-  return (packet->checksum == calculateChecksum(packet));
-}
+// TempDataPacket, its checksum and the protocol version are defined in the
+// shared VehiclePackets library so the CYD decodes exactly what is sent.
+#include <vehicle_packets.h>
 
 // ============================================================================
 // MAX31855 FAULT BIT DEFINITIONS
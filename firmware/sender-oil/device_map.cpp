@@ -0,0 +1,110 @@
+#include "device_map.h"
+#include "i2c_bus.h"
+#include "settings.h"
+#include <Wire.h>
+
+DeviceMap deviceMap;
+
+bool DeviceMap::begin() {
+  memset((DeviceMapValues *)this, 0, sizeof(DeviceMapValues));
+  prefs.begin(SETTINGS_NAMESPACE, false);
+  size_t len = prefs.getBytes(DEVICE_MAP_KEY, blob.buffer(), blob.capacity());
+  haveMap = blob.load(len, this) == SETTINGS_LOADED;
+  if (!haveMap)
+    memset((DeviceMapValues *)this, 0, sizeof(DeviceMapValues));
+  return haveMap;
+}
+
+bool DeviceMap::expectI2c(uint8_t address) const {
+  return !haveMap || (i2c[address >> 3] & (1 << (address & 7)));
+}
+
+bool DeviceMap::expectSpi(uint8_t device) const {
+  return !haveMap || (spi & device);
+}
+
+void DeviceMap::setSpi(uint8_t device, bool present) {
+  uint8_t next = present ? (spi | device) : (spi & ~device);
+  if (next != spi) {
+    spi = next;
+    changed();
+  }
+}
+
+void DeviceMap::startScan() {
+  memset(scanFound, 0, sizeof(scanFound));
+  nextAddress = 1;
+}
+
+bool DeviceMap::scanStep() {
+  if (!scanning())
+    return false;
+  for (int i = 0; i < DEVICE_SCAN_PER_LOOP && nextAddress < 127; i++) {
+    Wire.beginTransmission(nextAddress);
+    if (Wire.endTransmission() == 0)
+      scanFound[nextAddress >> 3] |= 1 << (nextAddress & 7);
+    i2cBus.account(I2C_SCAN, 0, 1);
+    nextAddress++;
+  }
+  if (nextAddress < 127)
+    return false;
+
+  nextAddress = 0;
+  memcpy(lastScan, scanFound, sizeof(lastScan));
+  haveScan = true;
+  if (memcmp(i2c, scanFound, sizeof(i2c)) != 0) {
+    memcpy(i2c, scanFound, sizeof(i2c));
+    changed();
+  }
+  return true;
+}
+
+bool DeviceMap::found(uint8_t address) const {
+  return haveScan && (lastScan[address >> 3] & (1 << (address & 7)));
+}
+
+int DeviceMap::foundCount() const {
+  int n = 0;
+  for (int address = 1; address < 127; address++)
+    n += found(address);
+  return n;
+}
+
+int DeviceMap::restoreReceivers(LinkSender &link, uint32_t nowMs) const {
+  int n = 0;
+  for (int i = 0; i < receiverCount && i < LINK_MAX_RECEIVERS; i++)
+    n += link.addReceiver(receivers[i], 0, nowMs) != NULL;
+  return n;
+}
+
+void DeviceMap::noteReceivers(const LinkSender &link) {
+  uint8_t next[LINK_MAX_RECEIVERS][6];
+  int n = 0;
+  for (int i = 0; i < LINK_MAX_RECEIVERS; i++) {
+    if (link.receiver(i).active)
+      memcpy(next[n++], link.receiver(i).mac, 6);
+  }
+  // Keep remembered receivers that are off right now, after the live ones
+  for (int i = 0; i < receiverCount && n < LINK_MAX_RECEIVERS; i++) {
+    bool live = false;
+    for (int j = 0; j < n && !live; j++)
+      live = memcmp(next[j], receivers[i], 6) == 0;
+    if (!live)
+      memcpy(next[n++], receivers[i], 6);
+  }
+  if (n == receiverCount && memcmp(next, receivers, n * 6) == 0)
+    return;
+  memcpy(receivers, next, n * 6);
+  receiverCount = n;
+  changed();
+}
+
+void DeviceMap::poll() {
+  if (!blob.due(millis()) || !blob.prepare(*this))
+    return;
+  if (prefs.putBytes(DEVICE_MAP_KEY, blob.image(), blob.size()) ==
+      blob.size())
+    blob.committed();
+  else
+    blob.failed(millis());
+}
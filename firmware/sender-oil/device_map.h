@@ -0,0 +1,72 @@
+#ifndef DEVICE_MAP_H
+#define DEVICE_MAP_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <packet_link.h>
+#include <settings_blob.h>
+
+// What was on the buses and who was listening at the last boot, kept in NVS
+// next to the settings (settings_blob.h) so the next boot can skip probing
+// and start sending at once. setup() only initialises parts the map lists
+// (everything on first boot); the full I2C scan runs a few addresses per
+// loop() pass and corrects the map. Bump DEVICE_MAP_VERSION if the layout
+// changes: an unknown layout is treated as no map.
+#define DEVICE_MAP_VERSION 1
+#define DEVICE_MAP_KEY "devmap"
+#define DEVICE_SCAN_PER_LOOP 8 // I2C addresses probed per loop() pass
+
+// SPI parts
+#define DEVICE_SPI_MAX31856 0x01
+
+typedef struct {
+  uint8_t i2c[16]; // Bit per 7-bit address that answered the last scan
+  uint8_t spi;     // DEVICE_SPI_* found at the last boot
+  uint8_t receiverCount;
+  uint8_t receivers[LINK_MAX_RECEIVERS][6]; // Paired receivers, newest first
+} DeviceMapValues;
+
+class DeviceMap : public DeviceMapValues {
+public:
+  DeviceMap() : blob(DEVICE_MAP_VERSION) {}
+
+  // Read the map saved at the last boot. False if there is none.
+  bool begin();
+  bool cached() const { return haveMap; }
+
+  // Whether a part is worth initialising at boot: listed in the map, or
+  // there is no map yet
+  bool expectI2c(uint8_t address) const;
+  bool expectSpi(uint8_t device) const;
+  void setSpi(uint8_t device, bool present);
+
+  // Background I2C scan. scanStep() probes DEVICE_SCAN_PER_LOOP addresses
+  // and returns true on the call that finishes the scan.
+  void startScan();
+  bool scanStep();
+  bool scanning() const { return nextAddress != 0; }
+  bool found(uint8_t address) const; // Result of the last finished scan
+  int foundCount() const;
+
+  // Receivers remembered from the last boot are paired straight away;
+  // noteReceivers() records new ones after a pairing
+  int restoreReceivers(LinkSender &link, uint32_t nowMs) const;
+  void noteReceivers(const LinkSender &link);
+
+  void poll(); // Call from loop(): writes the map once it settles
+
+private:
+  void changed() { blob.changed(millis()); }
+
+  Preferences prefs;
+  SettingsBlob<DeviceMapValues> blob;
+  bool haveMap = false;
+  uint8_t scanFound[16] = {};
+  uint8_t lastScan[16] = {};
+  bool haveScan = false;
+  uint8_t nextAddress = 0; // 0 = not scanning
+};
+
+extern DeviceMap deviceMap;
+
+#endif
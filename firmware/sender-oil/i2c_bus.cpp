@@ -0,0 +1,52 @@
+#include "i2c_bus.h"
+#include <Wire.h>
+
+I2cBus i2cBus;
+
+uint32_t I2cBus::busMicros(size_t bytes, int transactions) const {
+  // Each transaction also sends its address byte
+  const uint64_t clocks = (uint64_t)(bytes + transactions) * 9 +
+                          (uint64_t)transactions * 2;
+  return (uint32_t)((clocks * 1000000ULL + Wire.getClock() - 1) /
+                    Wire.getClock());
+}
+
+bool I2cBus::mayStart(I2cClient client, size_t bytes, int transactions,
+                      uint32_t nowMs) {
+  if (client == I2C_ADC)
+    return true;
+  // Round up: a transfer that ends inside the ADC's millisecond is late
+  const uint32_t doneMs =
+      nowMs + (busMicros(bytes, transactions) + 999) / 1000;
+  if ((int32_t)(nextPriorityMs - doneMs) >= 0)
+    return true;
+  current.deferred[client]++;
+  return false;
+}
+
+void I2cBus::account(I2cClient client, size_t bytes, int transactions) {
+  current.busyUs[client] += busMicros(bytes, transactions);
+}
+
+void I2cBus::poll(uint32_t nowMs) {
+  if (nowMs - windowStartMs < I2C_WINDOW_MS)
+    return;
+  last = current;
+  last.lengthMs = nowMs - windowStartMs;
+  memset(&current, 0, sizeof(current));
+  windowStartMs = nowMs;
+  windows++;
+}
+
+float I2cBus::busyPercent(I2cClient client) const {
+  if (last.lengthMs == 0)
+    return 0;
+  return last.busyUs[client] * 100.0f / (last.lengthMs * 1000.0f);
+}
+
+float I2cBus::busyPercent() const {
+  float total = 0;
+  for (int i = 0; i < I2C_CLIENTS; i++)
+    total += busyPercent((I2cClient)i);
+  return total;
+}
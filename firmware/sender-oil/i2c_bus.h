@@ -0,0 +1,71 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+
+// The ADS1115 and the OLED share one I2C bus. loop() is the only user, so
+// "scheduling" is deciding what may go on the bus this pass: the pressure
+// read always runs when it is due, and display pages and scan probes only
+// start if they will be off the bus before it. What is deferred goes on a
+// later pass.
+//
+// Bus time is worked out from the bytes each client moves at the bus clock
+// (9 clocks a byte plus start and stop), so the ADS1115's conversion wait
+// doesn't count as traffic. Every second the totals are kept as the last
+// window for the log and the console.
+
+typedef enum {
+  I2C_ADC,  // ADS1115 pressure reads: never deferred
+  I2C_OLED, // Display pages
+  I2C_SCAN, // Background device scan
+  I2C_CLIENTS,
+} I2cClient;
+
+// One single-shot ADS1115 read: config write, pointer write, 2-byte read
+// (data bytes; busMicros() adds each transaction's address byte)
+#define I2C_ADS1115_READ_BYTES 6
+#define I2C_ADS1115_READ_TRANSACTIONS 3
+
+#define I2C_WINDOW_MS 1000
+
+typedef struct {
+  uint32_t lengthMs;
+  uint32_t busyUs[I2C_CLIENTS];
+  uint32_t deferred[I2C_CLIENTS]; // Transfers held back for the ADC
+} I2cWindow;
+
+class I2cBus {
+public:
+  // When the next priority transfer is due (millis)
+  void reserve(uint32_t dueMs) { nextPriorityMs = dueMs; }
+
+  // Whether a transfer of this size may start now. Always true for the
+  // ADC; for the others, false if it would still be on the bus when the
+  // ADC read is due.
+  bool mayStart(I2cClient client, size_t bytes, int transactions,
+                uint32_t nowMs);
+
+  // Charge a finished transfer to client
+  void account(I2cClient client, size_t bytes, int transactions);
+
+  // Bus time of a transfer at the current clock
+  uint32_t busMicros(size_t bytes, int transactions) const;
+
+  void poll(uint32_t nowMs); // Call from loop(): rolls the window
+
+  const I2cWindow &lastWindow() const { return last; }
+  bool haveWindow() const { return windows > 0; }
+  float busyPercent(I2cClient client) const;
+  float busyPercent() const; // All clients
+
+private:
+  I2cWindow current = {};
+  I2cWindow last = {};
+  uint32_t windowStartMs = 0;
+  uint32_t windows = 0;
+  uint32_t nextPriorityMs = 0;
+};
+
+extern I2cBus i2cBus;
+
+#endif
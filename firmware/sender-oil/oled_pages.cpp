@@ -0,0 +1,76 @@
+#include "oled_pages.h"
+#include "i2c_bus.h"
+#include <Wire.h>
+
+// SSD1306 control bytes and addressing commands (horizontal mode, set by
+// the library's init)
+#define SSD1306_CONTROL_COMMANDS 0x00
+#define SSD1306_CONTROL_DATA 0x40
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_WINDOW_BYTES 7 // Control byte + both commands with args
+
+void OledPages::invalidate() {
+  dirty = 0xFF;
+  full = 0xFF;
+}
+
+int OledPages::flush(const uint8_t *buffer) {
+  int sent = 0;
+  for (int page = 0; page < OLED_PAGES && dirty; page++) {
+    const uint8_t bit = 1 << page;
+    if (!(dirty & bit))
+      continue;
+    const uint8_t *src = buffer + page * OLED_COLUMNS;
+    int first = 0;
+    int last = OLED_COLUMNS - 1;
+    if (!(full & bit)) {
+      while (first < OLED_COLUMNS && src[first] == shown[page][first])
+        first++;
+      if (first == OLED_COLUMNS) {
+        dirty &= ~bit; // Unchanged
+        continue;
+      }
+      while (src[last] == shown[page][last])
+        last--;
+    }
+
+    const int len = last - first + 1;
+    const int chunks = (len + OLED_CHUNK_BYTES - 1) / OLED_CHUNK_BYTES;
+    const size_t bytes = SSD1306_WINDOW_BYTES + chunks + len;
+    // Stop at the first page that has to wait, so the panel still fills
+    // top to bottom
+    if (!i2cBus.mayStart(I2C_OLED, bytes, 1 + chunks, millis()))
+      break;
+    sendPage(page, first, src + first, len);
+    i2cBus.account(I2C_OLED, bytes, 1 + chunks);
+    memcpy(&shown[page][first], src + first, len);
+    dirty &= ~bit;
+    full &= ~bit;
+    pages++;
+    sent++;
+  }
+  return sent;
+}
+
+void OledPages::sendPage(int page, int column, const uint8_t *data,
+                         int len) {
+  // Window: the changed columns of this page
+  Wire.beginTransmission(address);
+  Wire.write((uint8_t)SSD1306_CONTROL_COMMANDS);
+  Wire.write((uint8_t)SSD1306_COLUMNADDR);
+  Wire.write((uint8_t)column);
+  Wire.write((uint8_t)(column + len - 1));
+  Wire.write((uint8_t)SSD1306_PAGEADDR);
+  Wire.write((uint8_t)page);
+  Wire.write((uint8_t)page);
+  Wire.endTransmission();
+
+  for (int i = 0; i < len; i += OLED_CHUNK_BYTES) {
+    const int n = len - i < OLED_CHUNK_BYTES ? len - i : OLED_CHUNK_BYTES;
+    Wire.beginTransmission(address);
+    Wire.write((uint8_t)SSD1306_CONTROL_DATA);
+    Wire.write(data + i, n);
+    Wire.endTransmission();
+  }
+}
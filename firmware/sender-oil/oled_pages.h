@@ -0,0 +1,44 @@
+#ifndef OLED_PAGES_H
+#define OLED_PAGES_H
+
+#include <Arduino.h>
+
+// Sends the SSD1306 framebuffer a page (8 rows) at a time, and of each page
+// only the columns that differ from what the panel already shows. Drawing
+// still goes through the display library into its buffer; flush() replaces
+// display.display(). Pages go out through i2cBus, so one that would still
+// be on the bus when a pressure read is due waits for a later pass.
+#define OLED_PAGES 8
+#define OLED_COLUMNS 128
+#define OLED_CHUNK_BYTES 32 // Data bytes per I2C write, inside the Wire buffer
+
+class OledPages {
+public:
+  explicit OledPages(uint8_t addr) : address(addr) {}
+
+  // The panel's contents are unknown (init, or the library drew the whole
+  // frame itself): the next flush sends every page in full
+  void invalidate();
+
+  // The buffer was redrawn: check every page on the next flush
+  void redrawn() { dirty = 0xFF; }
+
+  bool pending() const { return dirty != 0; }
+
+  // Send changed pages, top down, until done or the bus is needed for the
+  // ADC. Returns the pages sent.
+  int flush(const uint8_t *buffer);
+
+  uint32_t pagesSent() const { return pages; }
+
+private:
+  void sendPage(int page, int column, const uint8_t *data, int len);
+
+  uint8_t address;
+  uint8_t shown[OLED_PAGES][OLED_COLUMNS] = {};
+  uint8_t dirty = 0; // Pages to compare with shown[]
+  uint8_t full = 0;  // Pages whose panel contents are unknown
+  uint32_t pages = 0;
+};
+
+#endif
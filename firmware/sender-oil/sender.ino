@@ -10,15 +10,20 @@
  * Functionality:
  * - Reads temperature from MAX31856 via SPI
  * - Displays temperature locally on OLED (for engine bay work)
- * - Transmits temperature data via ESP-NOW to dash-mounted receiver
+ * - Broadcasts temperature data via ESP-NOW to every paired receiver
  * - Monitors for thermocouple faults
- * - Implements retry logic for failed transmissions
+ * - Raises oil temperature and pressure alarms on every sample
+ * - Sends fault and alarm changes as events that receivers can NACK if missed
  */
 
 #include "SSD1306Wire.h"
+#include "alarms.h"
 #include "config.h"
 #include "console_menu.h"
 #include "data_packet.h"
+#include "device_map.h"
+#include "i2c_bus.h"
+#include "oled_pages.h"
 #include "settings.h"
 #include <Adafruit_ADS1X15.h>
 #include <Adafruit_MAX31856.h>
@@ -26,7 +31,12 @@
 #include <SPI.h>
 #include <WiFi.h>
 #include <Wire.h>
+#include <clock_sync.h>
 #include <esp_now.h>
+#include <esp_timer.h>
+#include <link_espnow.h>
+#include <packet_link.h>
+#include <window_stats.h>
 
 // ============================================================================
 // GLOBAL OBJECTS AND VARIABLES
@@ -43,10 +53,20 @@ Adafruit_MAX31856 max_oil(MAX31856_CS_PIN); // Oil Temperature
 
 Adafruit_ADS1115 ads;
 SSD1306Wire display(OLED_ADDR, OLED_SDA_PIN, OLED_SCL_PIN);
+OledPages oledPages(OLED_ADDR); // Sends only the pages that changed
 
-// Receiver MAC Address - CYD-1 (the receiver/display)
-// CYD-1 MAC: 08:D1:F9:2A:08:BC
-uint8_t receiverMAC[] = {0x08, 0xD1, 0xF9, 0x2A, 0x08, 0xBC};
+// Text the OLED shows, so an unchanged frame isn't redrawn or sent
+char shownOilText[16] = "";
+char shownPressText[16] = "";
+char shownAlarmText[24] = "";
+int8_t shownSendSuccess = -1;
+
+// Broadcast link: receivers in LINK_GROUP_ID pair with us, no MAC config
+LinkSender radioLink;
+uint8_t lastSentFaults = 0; // Fault bytes of the last packet, to spot changes
+uint8_t lastSentStatus = 0;
+uint16_t lastSentAlarms = 0;
+uint16_t unsentAlarmChanges = 0; // Raised or cleared since the last send
 
 // Packet tracking
 uint16_t sequenceNumber = 0;
@@ -66,10 +86,37 @@ bool dataValid = false;
 // Sensor Detection
 bool oilTempSensorFound = false;
 bool pressureSensorFound = false;
+bool displayFound = false;
+
+// Boot timing (ms since reset) and receivers paired so far
+unsigned long bootSetupMs = 0;
+unsigned long firstTransmitMs = 0;
+uint32_t lastPairCount = 0;
 
 // ESP-NOW send status tracking
 bool sendSuccess = false;
-int sendAttempts = 0;
+
+// Last packet sent, whose reading the next one carries as history
+TempDataPacket lastPacket;
+int64_t lastPacketSampleUs = 0;
+bool haveLastPacket = false;
+
+// Every sample since the last packet, sent as its min/max/mean
+WindowStats oilTempWindow;
+WindowStats oilPressWindow;
+
+// Clock sync with the CYD's time beacon. The receive callback only stores
+// the beacon; loop() feeds it to the filter.
+ClockSync displayClock;
+volatile bool beaconPending = false;
+volatile uint32_t beaconDisplayMs = 0;
+volatile int64_t beaconLocalUs = 0;
+volatile uint16_t beaconSpeedMph10 = BEACON_SPEED_UNKNOWN;
+int64_t lastSampleUs = 0; // esp_timer time of the latest sensor read
+
+// Road speed from the beacon, for the alarm rules that only apply moving
+float roadSpeedMph = NAN;
+unsigned long roadSpeedMs = 0;
 
 // ============================================================================
 // ESP-NOW CALLBACK: Called when data is sent
@@ -86,6 +133,23 @@ void onDataSent(const esp_now_send_info_t *info, esp_now_send_status_t status) {
   }
 }
 
+// ============================================================================
+// ESP-NOW CALLBACK: Called when data is received (link frames, time beacon)
+// ============================================================================
+void onDataRecv(const esp_now_recv_info_t *info, const uint8_t *data,
+                int len) {
+  const int64_t nowUs = esp_timer_get_time();
+  if (radioLink.receive(info->src_addr, data, len))
+    return; // Pair request or NACK, handled in loop()
+  TimeBeaconPacketView beacon(data, len);
+  if (!beacon.valid() || beaconPending)
+    return;
+  beaconDisplayMs = beacon.displayMs();
+  beaconSpeedMph10 = beacon.speedMph10();
+  beaconLocalUs = nowUs;
+  beaconPending = true;
+}
+
 // ============================================================================
 // INITIALIZE ESP-NOW
 // ============================================================================
@@ -104,20 +168,17 @@ bool initESPNow() {
   }
   Serial.println("✓ ESP-NOW initialized");
 
-  // Register send callback
+  // Register send and receive callbacks
   esp_now_register_send_cb(onDataSent);
+  esp_now_register_recv_cb(onDataRecv);
 
-  // Register peer (receiver)
-  esp_now_peer_info_t peerInfo = {};
-  memcpy(peerInfo.peer_addr, receiverMAC, 6);
-  peerInfo.channel = ESPNOW_CHANNEL;
-  peerInfo.encrypt = false; // No encryption for simplicity
-
-  if (esp_now_add_peer(&peerInfo) != ESP_OK) {
-    Serial.println("✗ Failed to add peer");
+  // Broadcast peer; receivers are added as they pair
+  if (!radioLink.begin(&LINK_ESPNOW, LINK_GROUP_ID, MSG_TYPE_OIL)) {
+    Serial.println("✗ Failed to add broadcast peer");
     return false;
   }
-  Serial.println("✓ Peer added successfully");
+  Serial.printf("✓ Link group %d, waiting for receivers to pair\n",
+                LINK_GROUP_ID);
 
   return true;
 }
@@ -126,6 +187,36 @@ bool initESPNow() {
 // UPDATE DISPLAY
 // ============================================================================
 void updateDisplay() {
+  char oilText[sizeof(shownOilText)];
+  char pressText[sizeof(shownPressText)];
+  char alarmText[sizeof(shownAlarmText)] = "";
+  if (hasFault(currentOilFaultStatus)) {
+    snprintf(oilText, sizeof(oilText), "ERR: %u", currentOilFaultStatus);
+  } else {
+    float tempF = (currentOilTemperature * 9.0 / 5.0) + 32.0;
+    snprintf(oilText, sizeof(oilText), "%.1f F", tempF);
+  }
+  snprintf(pressText, sizeof(pressText), "%.1f PSI", currentOilPressure);
+
+  // Most serious active alarm
+  uint16_t alarms = oilAlarms.active();
+  if (alarms) {
+    uint16_t critical = alarms & OIL_ALARM_CRITICAL_MASK;
+    uint16_t shown = critical ? critical : alarms;
+    snprintf(alarmText, sizeof(alarmText), "ALARM: %s",
+             alarmName(shown & -shown));
+  }
+
+  if (strcmp(oilText, shownOilText) == 0 &&
+      strcmp(pressText, shownPressText) == 0 &&
+      strcmp(alarmText, shownAlarmText) == 0 &&
+      shownSendSuccess == (int8_t)sendSuccess)
+    return; // Same frame as on the panel
+  strcpy(shownOilText, oilText);
+  strcpy(shownPressText, pressText);
+  strcpy(shownAlarmText, alarmText);
+  shownSendSuccess = sendSuccess;
+
   display.clear();
 
   int yOil = 0;
@@ -137,19 +228,19 @@ void updateDisplay() {
   display.drawString(0, yOil + 3, "Oil");
 
   display.setFont(ArialMT_Plain_16);
-  if (hasFault(currentOilFaultStatus)) {
-    display.drawString(40, yOil, "ERR: " + String(currentOilFaultStatus));
-  } else {
-    float tempF = (currentOilTemperature * 9.0 / 5.0) + 32.0;
-    display.drawString(40, yOil, String(tempF, 1) + " F");
-  }
+  display.drawString(40, yOil, oilText);
 
   // Oil Pressure
   display.setFont(ArialMT_Plain_10);
   display.drawString(0, yPress + 3, "Oil P");
 
   display.setFont(ArialMT_Plain_16);
-  display.drawString(40, yPress, String(currentOilPressure, 1) + " PSI");
+  display.drawString(40, yPress, pressText);
+
+  if (alarmText[0]) {
+    display.setFont(ArialMT_Plain_10);
+    display.drawString(0, 48, alarmText);
+  }
 
   // TX Status Indicator (Bottom Right)
   // Filled circle = Success, Empty circle = Fail/Retry
@@ -159,17 +250,23 @@ void updateDisplay() {
     display.drawCircle(124, 60, 3);
   }
 
-  display.display();
+  // Pages go out from loop(), between pressure reads
+  oledPages.redrawn();
 }
 
 // ============================================================================
 // SEND TEMPERATURE DATA VIA ESP-NOW
 // ============================================================================
 bool sendTemperatureData(float oilTemp, float oilCJ, uint8_t oilFault) {
-  // Build data packet
-  TempDataPacket packet;
-  packet.version = PROTOCOL_VERSION;
-  packet.timestamp = millis();
+  // Build data packet (history slots start empty)
+  TempDataPacket packet = {};
+  if (displayClock.synced(esp_timer_get_time())) {
+    packet.timestamp = displayClock.toDisplayMs(lastSampleUs);
+    packet.timeSource = TIME_SOURCE_DISPLAY;
+  } else {
+    packet.timestamp = (uint32_t)(lastSampleUs / 1000);
+    packet.timeSource = TIME_SOURCE_SENDER;
+  }
   
   // Head temp fields - unused (reserved for future head temp sensor)
   packet.temperature = 0;
@@ -188,105 +285,75 @@ bool sendTemperatureData(float oilTemp, float oilCJ, uint8_t oilFault) {
 
   packet.sequenceNumber = sequenceNumber++;
   packet.batteryLevel = 0; // Future use
-  packet.checksum = calculateChecksum(&packet);
+  packet.alarms = oilAlarms.active();
+
+  // Samples taken since the last packet
+  packet.oilTempSamples = oilTempWindow.count();
+  packet.oilTempMin = packetDeci(oilTempWindow.min());
+  packet.oilTempMax = packetDeci(oilTempWindow.max());
+  packet.oilTempMean = packetDeci(oilTempWindow.mean());
+  packet.oilPressSamples = oilPressWindow.count();
+  packet.oilPressMin = packetDeciUnsigned(oilPressWindow.min());
+  packet.oilPressMax = packetDeciUnsigned(oilPressWindow.max());
+  packet.oilPressMean = packetDeciUnsigned(oilPressWindow.mean());
+  packet.faultAgeMs = packetFaultAge(
+      oilTempWindow.faultCount() > 0,
+      (uint32_t)(lastSampleUs / 1000) - oilTempWindow.firstFaultMs());
+
+  // Previous two readings, so receivers rebuild lost frames without a resend
+  if (haveLastPacket)
+    packetCarryHistory(&packet, lastPacket,
+                       (uint32_t)((lastSampleUs - lastPacketSampleUs) / 1000));
+
+  // Fault and alarm changes are events: receivers NACK them if the
+  // broadcast is lost
+  const bool event = oilFault != lastSentFaults ||
+                     packet.sensorsStatus != lastSentStatus ||
+                     packet.alarms != lastSentAlarms;
+  lastSentFaults = oilFault;
+  lastSentStatus = packet.sensorsStatus;
+  lastSentAlarms = packet.alarms;
+  radioLink.seal(&packet, event); // Link fields, header and checksum
+
+  lastPacket = packet;
+  lastPacketSampleUs = lastSampleUs;
+  haveLastPacket = true;
 
-  // Attempt to send with retries
   sendSuccess = false;
-  for (sendAttempts = 0; sendAttempts < MAX_RETRY_COUNT; sendAttempts++) {
-    esp_err_t result =
-        esp_now_send(receiverMAC, (uint8_t *)&packet, sizeof(packet));
-
-    if (result == ESP_OK) {
-      // Wait briefly for callback
-      delay(10);
-      if (sendSuccess) {
-        return true;
-      }
-    } else {
-      if (!isConsoleActive())
-        Serial.printf("✗ Send error (attempt %d/%d)\n", sendAttempts + 1,
-                      MAX_RETRY_COUNT);
-    }
+  if (radioLink.receiverCount() == 0)
+    return false; // Nobody paired yet, nothing to send
 
-    delay(50); // Brief delay before retry
+  // One shot: the next packet carries this reading if the frame is lost, so
+  // never block the loop retrying
+  if (!radioLink.send(&packet)) {
+    if (!isConsoleActive())
+      Serial.println("✗ Send error (radio queue full)");
+    return false;
   }
-
-  if (!isConsoleActive())
-    Serial.println("✗ All send attempts failed");
-  return false;
+  return true;
 }
 
 // ============================================================================
-// SETUP
+// SENSOR AND DISPLAY INIT
 // ============================================================================
-void setup() {
-  // Initialize Serial
-  Serial.begin(115200);
-  delay(2000); // Wait for Serial to be ready
-
-  Serial.println("\n\n========================================");
-  Serial.println("ESP32C6 Temperature Sender (Engine Bay)");
-  Serial.println("========================================\n");
-
-  // Load Settings
-  SystemSettings.begin();
-
-  // Initialize I2C and OLED display
-  Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
-  Serial.println("I2C initialized on SDA=" + String(OLED_SDA_PIN) +
-                 ", SCL=" + String(OLED_SCL_PIN));
-
-  // Scan for I2C devices
-  Serial.println("Scanning I2C bus...");
-  byte error, address;
-  int nDevices = 0;
-  for (address = 1; address < 127; address++) {
-    Wire.beginTransmission(address);
-    error = Wire.endTransmission();
-    if (error == 0) {
-      Serial.printf("I2C device found at address 0x%02X\n", address);
-      nDevices++;
-    }
-  }
-  if (nDevices == 0) {
-    Serial.println("✗ No I2C devices found!");
-    Serial.println("  Check OLED wiring:");
-    Serial.println("    SDA -> D4 (GPIO6)");
-    Serial.println("    SCL -> D5 (GPIO7)");
-    Serial.println("    VCC -> 3.3V");
-    Serial.println("    GND -> GND");
-  } else {
-    Serial.printf("✓ Found %d I2C device(s)\n", nDevices);
-  }
-
-  // Try to initialize display
+void initDisplay() {
   if (!display.init()) {
     Serial.println("✗ OLED display init failed!");
     Serial.println("  Try address 0x3D if 0x3C doesn't work");
-  } else {
-    display.flipScreenVertically(); // Adjust if needed based on mounting
-    display.setContrast(255);       // Maximum brightness
-    Serial.println("✓ OLED display initialized");
+    return;
   }
+  display.flipScreenVertically(); // Adjust if needed based on mounting
+  display.setContrast(255);       // Maximum brightness
+  oledPages.invalidate();
+  displayFound = true;
+  Serial.println("✓ OLED display initialized");
+}
 
-  // Show splash screen
-  display.clear();
-  display.setFont(ArialMT_Plain_16);
-  display.setTextAlignment(TEXT_ALIGN_CENTER);
-  display.drawString(64, 10, "Engine Bay");
-  display.drawString(64, 30, "Temp Monitor");
-  display.setFont(ArialMT_Plain_10);
-  display.drawString(64, 50, "Initializing...");
-  display.display();
-  delay(2000);
-
-  // Initialize MAX31856 (Oil Temp)
-  // Init Hardware SPI first
-  SPI.begin(19, SPI_MISO_PIN, SPI_MOSI_PIN, 21); // SCK, MISO, MOSI, CS
-
+void initOilTempSensor() {
   if (!max_oil.begin()) {
     Serial.println("✗ MAX31856 (Oil Temp) init failed!");
-    // (Wiring check omitted but same as before)
+    if (deviceMap.cached() && deviceMap.expectSpi(DEVICE_SPI_MAX31856))
+      Serial.println("  It answered last boot: check the SPI wiring");
   } else {
     Serial.print("Checking MAX31856 Oil Temp: ");
     float t1 = max_oil.readCJTemperature();
@@ -296,8 +363,10 @@ void setup() {
     max_oil.setConversionMode(MAX31856_CONTINUOUS);
     oilTempSensorFound = true;
   }
+  deviceMap.setSpi(DEVICE_SPI_MAX31856, oilTempSensorFound);
+}
 
-  // Initialize ADS1115 (Oil Pressure)
+void initPressureSensor() {
   if (!ads.begin(ADS1115_ADDR)) {
     Serial.println("✗ ADS1115 (Pressure) init failed! (Addr: 0x48)");
     pressureSensorFound = false;
@@ -306,56 +375,159 @@ void setup() {
     ads.setGain(GAIN_TWOTHIRDS); // +/- 6.144V
     pressureSensorFound = true;
   }
+}
 
-  // Initialize ESP-NOW
+// A finished I2C scan: report it and bring up parts the device map left out
+void reportI2cScan() {
+  int nDevices = deviceMap.foundCount();
+  for (int address = 1; address < 127; address++) {
+    if (deviceMap.found(address))
+      Serial.printf("I2C device found at address 0x%02X\n", address);
+  }
+  if (nDevices == 0) {
+    Serial.println("✗ No I2C devices found!");
+    Serial.println("  Check OLED wiring:");
+    Serial.println("    SDA -> D4 (GPIO6)");
+    Serial.println("    SCL -> D5 (GPIO7)");
+    Serial.println("    VCC -> 3.3V");
+    Serial.println("    GND -> GND");
+  } else {
+    Serial.printf("✓ Found %d I2C device(s)\n", nDevices);
+  }
+
+  if (deviceMap.found(ADS1115_ADDR) && !pressureSensorFound)
+    initPressureSensor();
+  if (deviceMap.found(OLED_ADDR) && !displayFound)
+    initDisplay();
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+void setup() {
+  // Initialize Serial
+  Serial.begin(115200);
+#if !FAST_BOOT
+  delay(2000); // Wait for Serial to be ready
+#endif
+
+  Serial.println("\n\n========================================");
+  Serial.println("ESP32C6 Temperature Sender (Engine Bay)");
+  Serial.println("========================================\n");
+
+  // Load Settings, and what was fitted and paired last boot
+  SystemSettings.begin();
+  updateAlarmRules();
+  if (deviceMap.begin())
+    Serial.printf("Device map: cached, %d receiver(s)\n",
+                  deviceMap.receiverCount);
+  else
+    Serial.println("Device map: none yet, probing everything");
+
+  // Radio first: receivers from last boot are paired again so the first
+  // reading goes out without waiting for their next pair request
   if (!initESPNow()) {
     Serial.println("\n✗ ESP-NOW initialization failed!");
     while (1)
       delay(1000); // Halt
   }
+  int restored = deviceMap.restoreReceivers(radioLink, millis());
+  if (restored > 0)
+    Serial.printf("✓ %d receiver(s) restored from last boot\n", restored);
 
-  // Check receiver MAC address configuration
-  bool macIsDefault = true;
-  for (int i = 0; i < 6; i++) {
-    if (receiverMAC[i] != 0xFF) {
-      macIsDefault = false;
-      break;
-    }
-  }
+  // Initialize MAX31856 (Oil Temp)
+  // Init Hardware SPI first
+  SPI.begin(19, SPI_MISO_PIN, SPI_MOSI_PIN, 21); // SCK, MISO, MOSI, CS
+  initOilTempSensor();
 
-  if (macIsDefault) {
-    Serial.println("\n⚠ WARNING: Receiver MAC address not configured!");
-    Serial.println("  1. Flash the receiver code first");
-    Serial.println("  2. Copy its MAC address from Serial Monitor");
-    Serial.println("  3. Update receiverMAC[] in config.h");
-    Serial.println("  4. Re-flash this sender code\n");
-  } else {
-    Serial.print("Receiver MAC: ");
-    for (int i = 0; i < 6; i++) {
-      Serial.printf("%02X", receiverMAC[i]);
-      if (i < 5)
-        Serial.print(":");
-    }
-    Serial.println();
-  }
+  // Initialize I2C; only parts in the device map are brought up now, the
+  // rest once the background scan finds them
+  Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
+  Serial.println("I2C initialized on SDA=" + String(OLED_SDA_PIN) +
+                 ", SCL=" + String(OLED_SCL_PIN));
+  if (deviceMap.expectI2c(ADS1115_ADDR))
+    initPressureSensor();
+  if (deviceMap.expectI2c(OLED_ADDR))
+    initDisplay();
+  deviceMap.startScan();
+
+#if !FAST_BOOT
+  // Scan for I2C devices
+  Serial.println("Scanning I2C bus...");
+  while (!deviceMap.scanStep())
+    ;
+  reportI2cScan();
+
+  // Show splash screen
+  display.clear();
+  display.setFont(ArialMT_Plain_16);
+  display.setTextAlignment(TEXT_ALIGN_CENTER);
+  display.drawString(64, 10, "Engine Bay");
+  display.drawString(64, 30, "Temp Monitor");
+  display.setFont(ArialMT_Plain_10);
+  display.drawString(64, 50, "Initializing...");
+  display.display();
+  oledPages.invalidate();
+  delay(2000);
+#endif
+
+  // Sample and transmit on the first loop() pass
+  lastSampleTime = millis() - SAMPLE_INTERVAL_MS;
+  lastTransmitTime = millis() - TRANSMIT_INTERVAL_MS;
 
   Serial.println("\n========================================");
   Serial.println("Starting temperature monitoring...");
   Serial.println("========================================\n");
 
   initConsole();
+  bootSetupMs = millis();
+  Serial.printf("Boot: setup done at %lu ms\n", bootSetupMs);
 }
 
 // ============================================================================
 // MAIN LOOP
 // ============================================================================
 void loop() {
-  handleConsole(); // Check for menu input
+  handleConsole();       // Check for menu input
+  SystemSettings.poll(); // Write settings once edits stop
   unsigned long currentTime = millis();
 
+  radioLink.poll(currentTime); // Pairing and event repeats
+  if (radioLink.pairCount() != lastPairCount) {
+    // Remember the receiver for next boot, and send it a reading now
+    lastPairCount = radioLink.pairCount();
+    deviceMap.noteReceivers(radioLink);
+    lastTransmitTime = currentTime - TRANSMIT_INTERVAL_MS;
+  }
+
+  // Pressure reads come first on the I2C bus: scan probes and display
+  // pages that would still be running when the next one is due wait
+  i2cBus.poll(currentTime);
+  i2cBus.reserve(pressureSensorFound ? lastSampleTime + SAMPLE_INTERVAL_MS
+                                     : currentTime + SAMPLE_INTERVAL_MS);
+
+  // Background diagnostics: a few I2C addresses per pass
+  if ((!deviceMap.scanning() ||
+       i2cBus.mayStart(I2C_SCAN, 0, DEVICE_SCAN_PER_LOOP, currentTime)) &&
+      deviceMap.scanStep())
+    reportI2cScan();
+  deviceMap.poll(); // Write the map once it settles
+
+  if (beaconPending) {
+    displayClock.onBeacon(beaconDisplayMs, beaconLocalUs);
+    roadSpeedMph = beaconSpeedMph10 == BEACON_SPEED_UNKNOWN
+                       ? NAN
+                       : beaconSpeedMph10 / 10.0f;
+    roadSpeedMs = currentTime;
+    beaconPending = false;
+  }
+  if (currentTime - roadSpeedMs > SPEED_TIMEOUT_MS)
+    roadSpeedMph = NAN; // Display gone or no GPS fix
+
   // Check if it's time to sample
   if (currentTime - lastSampleTime >= SAMPLE_INTERVAL_MS) {
     lastSampleTime = currentTime;
+    lastSampleUs = esp_timer_get_time();
 
     // Read Oil Temperature
     float oilTemp = 0;
@@ -384,6 +556,8 @@ void loop() {
     float pressurePSI = 0.0f;
     if (pressureSensorFound) {
       int16_t adc0 = ads.readADC_SingleEnded(0);
+      i2cBus.account(I2C_ADC, I2C_ADS1115_READ_BYTES,
+                     I2C_ADS1115_READ_TRANSACTIONS);
       float voltage = ads.computeVolts(adc0);
 
       // Clamp voltage to expected range (0.34V - 3.07V)
@@ -409,10 +583,40 @@ void loop() {
 
     dataValid = true;
 
+    if (oilTempSensorFound) {
+      if (hasFault(oilFault) || isnan(oilTemp))
+        oilTempWindow.fault((uint32_t)(lastSampleUs / 1000));
+      else
+        oilTempWindow.add(oilTemp);
+    }
+    if (pressureSensorFound)
+      oilPressWindow.add(pressurePSI);
+
+    // Alarm rules on this sample; a change is sent now rather than on the
+    // next transmit slot
+    updateAlarmRules();
+    float alarmInputs[ALARM_INPUTS];
+    alarmInputs[ALARM_IN_OIL_TEMP] =
+        oilTempSensorFound && !hasFault(oilFault) ? oilTemp : NAN;
+    alarmInputs[ALARM_IN_OIL_PRESS] = pressureSensorFound ? pressurePSI : NAN;
+    alarmInputs[ALARM_IN_HEAD_TEMP] = NAN; // No head sensor fitted
+    alarmInputs[ALARM_IN_SPEED] = roadSpeedMph;
+    oilAlarms.evaluate(alarmInputs, currentTime);
+    if (oilAlarms.changed()) {
+      unsentAlarmChanges |= oilAlarms.changed();
+      lastTransmitTime = currentTime - TRANSMIT_INTERVAL_MS;
+    }
+
     // Print to Serial only if menu is not active
     if (!isConsoleActive()) {
       Serial.println("----------------------------------------");
-      Serial.printf("Seq: %d | Time: %lu ms\n", sequenceNumber, currentTime);
+      Serial.printf("Seq: %d | Time: %lu ms | Receivers: %d\n",
+                    sequenceNumber, currentTime, radioLink.receiverCount());
+      if (displayClock.synced(lastSampleUs))
+        Serial.printf("Clock: offset %.1f ms, drift %.1f ppm\n",
+                      displayClock.offset(), displayClock.drift());
+      else
+        Serial.println("Clock: waiting for display beacon");
       Serial.printf("Oil: %.1f F | Press: %.1f PSI\n",
                     (currentOilTemperature * 1.8 + 32), currentOilPressure);
 
@@ -434,21 +638,48 @@ void loop() {
     // Send via ESP-NOW using current values
     bool sent = sendTemperatureData(
         currentOilTemperature, currentOilColdJunction, currentOilFaultStatus);
-    if (!sent) {
+    if (!sent && radioLink.receiverCount() > 0) {
       if (!isConsoleActive())
         Serial.println("⚠ Failed to transmit data");
     }
+    oilTempWindow.reset();
+    oilPressWindow.reset();
+    if (sent && firstTransmitMs == 0) {
+      firstTransmitMs = millis();
+      Serial.printf("Boot: first packet sent at %lu ms\n", firstTransmitMs);
+    }
+    if (unsentAlarmChanges && !isConsoleActive())
+      reportAlarms(unsentAlarmChanges, lastSampleTime,
+                   sent ? (uint32_t)(esp_timer_get_time() - lastSampleUs)
+                        : ALARM_NOT_SENT);
+    unsentAlarmChanges = 0;
+
+    if (i2cBus.haveWindow() && !isConsoleActive()) {
+      const I2cWindow &w = i2cBus.lastWindow();
+      Serial.printf("I2C: %.1f%% busy (adc %.1f%%, oled %.1f%%, scan %.1f%%), "
+                    "%lu deferred for the adc\n",
+                    i2cBus.busyPercent(), i2cBus.busyPercent(I2C_ADC),
+                    i2cBus.busyPercent(I2C_OLED), i2cBus.busyPercent(I2C_SCAN),
+                    (unsigned long)(w.deferred[I2C_OLED] + w.deferred[I2C_SCAN]));
+    }
 
     if (!isConsoleActive())
       Serial.println("----------------------------------------\n");
   }
 
   // Update display periodically
-  if (currentTime - lastDisplayUpdate >= DISPLAY_UPDATE_INTERVAL_MS) {
+  if (displayFound &&
+      currentTime - lastDisplayUpdate >= DISPLAY_UPDATE_INTERVAL_MS) {
     lastDisplayUpdate = currentTime;
     updateDisplay();
   }
-
-  // Small delay to prevent tight looping
-  delay(10);
+  if (displayFound && oledPages.pending())
+    oledPages.flush(display.buffer);
+
+  // Small delay to prevent tight looping, cut short for a due pressure read
+  uint32_t idleMs = 10;
+  uint32_t untilSample = lastSampleTime + SAMPLE_INTERVAL_MS - millis();
+  if ((int32_t)untilSample >= 0 && untilSample < idleMs)
+    idleMs = untilSample;
+  delay(idleMs);
 }
@@ -3,42 +3,96 @@
 Settings SystemSettings;
 
 void Settings::begin() {
-  prefs.begin("car_mon", false); // "car_mon" is the namespace
+  prefs.begin(SETTINGS_NAMESPACE, false);
   load();
 }
 
 void Settings::load() {
-  headTempOffset = prefs.getFloat("h_off", 0.0f);
-  headTempAlarmHigh = prefs.getFloat("h_lim", 220.0f); // Default 220F
+  const uint32_t start = micros();
+  const char *source;
+  size_t len = prefs.getBytes(SETTINGS_KEY, blob.buffer(), blob.capacity());
+  switch (blob.load(len, this)) {
+  case SETTINGS_LOADED:
+    source = "loaded";
+    break;
+  case SETTINGS_MISSING:
+    source = migrateKeys() ? "migrated from per-field keys" : "defaults";
+    break;
+  case SETTINGS_OTHER_VERSION:
+    // No older layout exists yet; migrate it here when one does
+    setDefaults();
+    source = "unknown layout, defaults";
+    break;
+  default:
+    setDefaults();
+    source = "CRC mismatch, defaults";
+    break;
+  }
+  loadUs = micros() - start;
+  Serial.printf("Settings: %s in %lu us (%lu lifetime writes)\n", source,
+                (unsigned long)loadUs, (unsigned long)blob.saves());
+}
 
-  oilTempOffset = prefs.getFloat("o_off", 0.0f);
-  oilTempAlarmHigh = prefs.getFloat("o_lim", 250.0f); // Default 250F
+// Settings from before the blob: one key per field. Copied into the blob,
+// which is written straight away, then the old keys are removed.
+bool Settings::migrateKeys() {
+  setDefaults();
+  if (!prefs.isKey("h_off"))
+    return false;
+  headTempOffset = prefs.getFloat("h_off", headTempOffset);
+  headTempAlarmHigh = prefs.getFloat("h_lim", headTempAlarmHigh);
+  oilTempOffset = prefs.getFloat("o_off", oilTempOffset);
+  oilTempAlarmHigh = prefs.getFloat("o_lim", oilTempAlarmHigh);
+  oilPressOffset = prefs.getFloat("p_off", oilPressOffset);
+  oilPressAlarmLow = prefs.getFloat("p_lo_lim", oilPressAlarmLow);
+  oilPressAlarmHigh = prefs.getFloat("p_hi_lim", oilPressAlarmHigh);
 
-  oilPressOffset = prefs.getFloat("p_off", 0.0f);
-  // Defaults: Warn if below 10 PSI or above 90 PSI
-  oilPressAlarmLow = prefs.getFloat("p_lo_lim", 10.0f);
-  oilPressAlarmHigh = prefs.getFloat("p_hi_lim", 90.0f);
+  save();
+  flush();
+  if (blob.pending())
+    return true; // Write failed: keep the old keys for next boot
+  static const char *const OLD_KEYS[] = {"h_off", "h_lim",    "o_off",
+                                         "o_lim", "p_off",    "p_lo_lim",
+                                         "p_hi_lim"};
+  for (const char *key : OLD_KEYS)
+    prefs.remove(key);
+  return true;
 }
 
 void Settings::save() {
-  prefs.putFloat("h_off", headTempOffset);
-  prefs.putFloat("h_lim", headTempAlarmHigh);
+  blob.changed(millis());
+  edits++;
+}
 
-  prefs.putFloat("o_off", oilTempOffset);
-  prefs.putFloat("o_lim", oilTempAlarmHigh);
+void Settings::poll() {
+  if (blob.due(millis()))
+    flush();
+}
 
-  prefs.putFloat("p_off", oilPressOffset);
-  prefs.putFloat("p_lo_lim", oilPressAlarmLow);
-  prefs.putFloat("p_hi_lim", oilPressAlarmHigh);
+void Settings::flush() {
+  if (!blob.pending() || !blob.prepare(*this))
+    return;
+  if (prefs.putBytes(SETTINGS_KEY, blob.image(), blob.size()) ==
+      blob.size()) {
+    blob.committed();
+    writes++;
+  } else {
+    blob.failed(millis());
+  }
 }
 
-void Settings::resetDefaults() {
+void Settings::setDefaults() {
   headTempOffset = 0.0f;
-  headTempAlarmHigh = 220.0f;
+  headTempAlarmHigh = 220.0f; // Default 220F
   oilTempOffset = 0.0f;
-  oilTempAlarmHigh = 250.0f;
+  oilTempAlarmHigh = 250.0f; // Default 250F
   oilPressOffset = 0.0f;
+  // Warn if below 10 PSI or above 90 PSI
   oilPressAlarmLow = 10.0f;
   oilPressAlarmHigh = 90.0f;
+}
+
+void Settings::resetDefaults() {
+  setDefaults();
   save();
 }
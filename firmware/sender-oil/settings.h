@@ -3,9 +3,15 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include <settings_blob.h>
 
-class Settings {
-public:
+// Stored as one CRC-checked blob (settings_blob.h). Bump SETTINGS_VERSION
+// when this layout changes and migrate the old one in Settings::load().
+#define SETTINGS_VERSION 1
+#define SETTINGS_NAMESPACE "car_mon"
+#define SETTINGS_KEY "cfg"
+
+typedef struct {
   float headTempOffset;
   float headTempAlarmHigh;
 
@@ -17,14 +23,37 @@ public:
   float oilPressAlarmHigh;
 
   // ESP-NOW settings could be stored here too, but for now we focus on sensors
+} SettingsValues;
+
+class Settings : public SettingsValues {
+public:
+  Settings() : blob(SETTINGS_VERSION) {}
 
   void begin();
   void load();
+  // Edits are written once they stop (SETTINGS_SAVE_QUIET_MS), from poll()
   void save();
+  void poll();  // Call from loop()
+  void flush(); // Write any pending edit now
+  bool pending() const { return blob.pending(); }
   void resetDefaults();
+  // Bumped by every save(), so users of the values can spot an edit
+  uint32_t revision() const { return edits; }
+
+  // Boot load time, and flash writes this boot and over the unit's life
+  uint32_t loadMicros() const { return loadUs; }
+  uint32_t writesThisBoot() const { return writes; }
+  uint32_t lifetimeWrites() const { return blob.saves(); }
 
 private:
+  void setDefaults();
+  bool migrateKeys();
+
   Preferences prefs;
+  SettingsBlob<SettingsValues> blob;
+  uint32_t loadUs = 0;
+  uint32_t writes = 0;
+  uint32_t edits = 0;
 };
 
 extern Settings SystemSettings;
@@ -0,0 +1,85 @@
+#ifndef HOST_ADAFRUIT_ADS1X15_H
+#define HOST_ADAFRUIT_ADS1X15_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+// ADS1115 ADC on the host I2C bus. Register it with hostWireAddDevice() so
+// begin() finds it; the host driver sets the input voltage per channel, or
+// installs a read hook to produce a fresh voltage on every conversion.
+// Each single-shot read costs its bus transfers plus the conversion time.
+
+typedef enum {
+  GAIN_TWOTHIRDS = 0x0000,
+  GAIN_ONE = 0x0200,
+  GAIN_TWO = 0x0400,
+  GAIN_FOUR = 0x0600,
+  GAIN_EIGHT = 0x0800,
+  GAIN_SIXTEEN = 0x0A00,
+} adsGain_t;
+
+#define ADS1115_CONVERSION_MS 8 // 128 samples/s, the library default
+
+typedef float (*HostAdsReadHook)(uint8_t channel);
+
+class Adafruit_ADS1115 {
+public:
+  bool begin(uint8_t addr = 0x48, TwoWire *wire = &Wire) {
+    address = addr;
+    bus = wire;
+    bus->beginTransmission(address);
+    return bus->endTransmission() == 0;
+  }
+  void setGain(adsGain_t g) { gain = g; }
+  adsGain_t getGain() { return gain; }
+
+  int16_t readADC_SingleEnded(uint8_t channel) {
+    bus->beginTransmission(address); // Config register: start conversion
+    bus->write((const uint8_t *)"\x01\x00\x00", 3);
+    bus->endTransmission();
+    delay(ADS1115_CONVERSION_MS);
+    bus->beginTransmission(address); // Point at the conversion register
+    bus->write((uint8_t)0x00);
+    bus->endTransmission();
+    bus->requestFrom(address, (uint8_t)2);
+    bus->read();
+    bus->read();
+    const float volts = hostReadHook ? hostReadHook(channel & 3)
+                                     : hostVolts[channel & 3];
+    float counts = volts / fullScale() * 32768.0f;
+    if (counts > 32767)
+      counts = 32767;
+    if (counts < -32768)
+      counts = -32768;
+    return (int16_t)counts;
+  }
+
+  float computeVolts(int16_t counts) { return counts * fullScale() / 32768; }
+
+  static float hostVolts[4];
+  static HostAdsReadHook hostReadHook;
+
+private:
+  float fullScale() const {
+    switch (gain) {
+    case GAIN_ONE:
+      return 4.096f;
+    case GAIN_TWO:
+      return 2.048f;
+    case GAIN_FOUR:
+      return 1.024f;
+    case GAIN_EIGHT:
+      return 0.512f;
+    case GAIN_SIXTEEN:
+      return 0.256f;
+    default:
+      return 6.144f;
+    }
+  }
+
+  uint8_t address = 0x48;
+  TwoWire *bus = &Wire;
+  adsGain_t gain = GAIN_TWOTHIRDS;
+};
+
+#endif // HOST_ADAFRUIT_ADS1X15_H
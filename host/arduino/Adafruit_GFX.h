@@ -0,0 +1,8 @@
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+// Included by the CYD sketch but not used; TFT_eSPI provides the drawing API
+
+#include "Arduino.h"
+
+#endif // HOST_ADAFRUIT_GFX_H
@@ -0,0 +1,51 @@
+#ifndef HOST_ADAFRUIT_MAX31856_H
+#define HOST_ADAFRUIT_MAX31856_H
+
+#include "Arduino.h"
+#include "SPI.h"
+
+// Thermocouple amplifier. The host driver sets what every instance reads.
+
+typedef enum {
+  MAX31856_TCTYPE_B = 0,
+  MAX31856_TCTYPE_E,
+  MAX31856_TCTYPE_J,
+  MAX31856_TCTYPE_K,
+  MAX31856_TCTYPE_N,
+  MAX31856_TCTYPE_R,
+  MAX31856_TCTYPE_S,
+  MAX31856_TCTYPE_T,
+} max31856_thermocoupletype_t;
+
+typedef enum {
+  MAX31856_ONESHOT,
+  MAX31856_ONESHOT_NOWAIT,
+  MAX31856_CONTINUOUS,
+} max31856_conversion_modes_t;
+
+#define MAX31856_FAULT_CJRANGE 0x80
+#define MAX31856_FAULT_TCRANGE 0x40
+#define MAX31856_FAULT_CJHIGH 0x20
+#define MAX31856_FAULT_CJLOW 0x10
+#define MAX31856_FAULT_TCHIGH 0x08
+#define MAX31856_FAULT_TCLOW 0x04
+#define MAX31856_FAULT_OVUV 0x02
+#define MAX31856_FAULT_OPEN 0x01
+
+class Adafruit_MAX31856 {
+public:
+  Adafruit_MAX31856(int8_t, SPIClass * = &SPI) {}
+  bool begin() { return hostPresent; }
+  void setThermocoupleType(max31856_thermocoupletype_t) {}
+  void setConversionMode(max31856_conversion_modes_t) {}
+  float readThermocoupleTemperature() { return hostThermocoupleC; }
+  float readCJTemperature() { return hostColdJunctionC; }
+  uint8_t readFault() { return hostFault; }
+
+  static bool hostPresent;
+  static float hostThermocoupleC;
+  static float hostColdJunctionC;
+  static uint8_t hostFault;
+};
+
+#endif // HOST_ADAFRUIT_MAX31856_H
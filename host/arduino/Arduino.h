@@ -0,0 +1,145 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// ============================================================================
+// HOST ARDUINO SHIM
+// ============================================================================
+// Just enough of the Arduino-ESP32 core to compile the firmware sketches on
+// Linux. Time is virtual: it only moves when the sketch calls delay() or the
+// host driver calls hostAdvanceMicros(), so runs are deterministic.
+//
+// A multi-node simulator installs a sleep hook: every advance of the clock
+// then goes through it, so the simulator can run other nodes and deliver
+// radio frames until this node's time comes round again.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "WString.h"
+
+using std::abs;
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+using std::round;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PI 3.1415926535897932384626433832795
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define HEX 16
+#define DEC 10
+#define F(s) (s)
+#define PROGMEM
+#define IRAM_ATTR
+
+#define constrain(amt, low, high)                                              \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ===== Virtual clock =====
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void hostAdvanceMicros(uint64_t us);
+uint64_t hostMicros64();
+// Set the clock directly, bypassing the sleep hook (simulator use)
+void hostSetMicros64(uint64_t us);
+// Called with the target time instead of moving the clock; returns once the
+// simulator has set the clock to it
+typedef void (*HostSleepHook)(uint64_t untilUs);
+void hostSetSleepHook(HostSleepHook hook);
+
+// ===== GPIO / ADC =====
+// analogRead() is routed through a hook so a simulator can drive it
+typedef int (*HostAnalogReadHook)(uint8_t pin);
+void hostSetAnalogReadHook(HostAnalogReadHook hook);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+
+typedef enum {
+  ADC_ATTEN_DB_0,
+  ADC_ATTEN_DB_2_5,
+  ADC_ATTEN_DB_6,
+  ADC_ATTEN_DB_11
+} adc_attenuation_t;
+void analogSetAttenuation(adc_attenuation_t atten);
+
+#define GPIO_NUM_1 1
+#define GPIO_NUM_2 2
+#define GPIO_NUM_3 3
+#define GPIO_NUM_20 20
+#define GPIO_NUM_21 21
+#define ADC_CHANNEL_3 3
+
+// ===== Serial =====
+class HardwareSerial {
+public:
+  void begin(unsigned long) {}
+  operator bool() const { return true; }
+
+  int available();
+  int read();
+  int peek();
+  // Queue input as if typed on the serial monitor
+  void hostFeed(const char *text);
+  // Silence output (soak tests print far too much)
+  void hostSetQuiet(bool q) { quiet = q; }
+  // Send output here instead of stdout
+  typedef void (*Output)(const uint8_t *buf, size_t len);
+  void hostSetOutput(Output out) { output = out; }
+
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buf, size_t len);
+  size_t print(const char *s);
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t print(char c);
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) {
+    return print((unsigned long)v, base);
+  }
+  size_t print(long v, int base = DEC);
+  size_t print(unsigned long v, int base = DEC);
+  size_t print(double v, int digits = 2);
+  template <typename T> size_t println(const T &v) {
+    size_t n = print(v);
+    return n + print("\n");
+  }
+  template <typename T> size_t println(const T &v, int fmt) {
+    size_t n = print(v, fmt);
+    return n + print("\n");
+  }
+  size_t println() { return print("\n"); }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+  float parseFloat();
+  long parseInt();
+  String readStringUntil(char terminator);
+  size_t readBytes(uint8_t *buf, size_t len);
+
+private:
+  String input;
+  size_t inputPos = 0;
+  bool quiet = false;
+  Output output = nullptr;
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_ARDUINO_H
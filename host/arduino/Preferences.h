@@ -0,0 +1,56 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+// NVS Preferences backed by an in-process key/value store. Every put counts
+// as one flash write and every get as one lookup, so wear and boot cost can
+// be compared between storage layouts on the host.
+
+#include "Arduino.h"
+
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false);
+  void end();
+
+  bool clear();
+  bool remove(const char *key);
+  bool isKey(const char *key);
+
+  size_t putUChar(const char *key, uint8_t value);
+  size_t putInt(const char *key, int32_t value);
+  size_t putUInt(const char *key, uint32_t value);
+  size_t putFloat(const char *key, float value);
+  size_t putString(const char *key, const String &value);
+  size_t putBytes(const char *key, const void *value, size_t len);
+
+  uint8_t getUChar(const char *key, uint8_t defaultValue = 0);
+  int32_t getInt(const char *key, int32_t defaultValue = 0);
+  uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+  float getFloat(const char *key, float defaultValue = NAN);
+  String getString(const char *key, const String &defaultValue = String());
+  size_t getBytesLength(const char *key);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+
+private:
+  size_t put(const char *key, const void *value, size_t len);
+  bool get(const char *key, void *buf, size_t len);
+
+  String ns;
+  bool opened = false;
+  bool readOnly = false;
+};
+
+// ===== Host statistics =====
+typedef struct {
+  uint32_t writes;       // put*/remove/clear calls that reached "flash"
+  uint32_t bytesWritten; // Payload bytes written
+  uint32_t reads;        // get* lookups
+  uint32_t opens;        // begin() calls
+} HostPreferencesStats;
+
+HostPreferencesStats hostPreferencesStats();
+void hostPreferencesResetStats();
+// Wipe every namespace (simulates a freshly erased NVS partition)
+void hostPreferencesErase();
+
+#endif // HOST_PREFERENCES_H
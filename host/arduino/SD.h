@@ -0,0 +1,14 @@
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include "Arduino.h"
+
+// No card in the host build
+class SDClass {
+public:
+  bool begin(uint8_t = 0) { return false; }
+};
+
+extern SDClass SD;
+
+#endif // HOST_SD_H
@@ -0,0 +1,95 @@
+#ifndef HOST_SSD1306WIRE_H
+#define HOST_SSD1306WIRE_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+// 128x64 I2C OLED. Drawing doesn't render glyphs, but marks the pixels a
+// string or shape covers with a pattern that depends on the text, so a
+// changed digit changes the same framebuffer bytes it would on the device.
+// display() costs the full 1 KB frame on the host I2C bus. init() sets the
+// bus clock the real driver uses.
+
+typedef enum {
+  TEXT_ALIGN_LEFT,
+  TEXT_ALIGN_RIGHT,
+  TEXT_ALIGN_CENTER,
+  TEXT_ALIGN_CENTER_BOTH,
+} OLEDDISPLAY_TEXT_ALIGNMENT;
+
+extern const uint8_t ArialMT_Plain_10[];
+extern const uint8_t ArialMT_Plain_16[];
+extern const uint8_t ArialMT_Plain_24[];
+
+#define HOST_OLED_WIDTH 128
+#define HOST_OLED_HEIGHT 64
+#define HOST_OLED_I2C_HZ 700000 // SSD1306Wire's default
+
+class SSD1306Wire {
+public:
+  SSD1306Wire(uint8_t addr, int, int) : buffer(pixels), address(addr) {}
+  bool init() {
+    Wire.setClock(HOST_OLED_I2C_HZ);
+    Wire.beginTransmission(address);
+    return Wire.endTransmission() == 0;
+  }
+  void flipScreenVertically() {}
+  void setContrast(uint8_t) {}
+  void clear() { memset(pixels, 0, sizeof(pixels)); }
+  void setFont(const uint8_t *f) { font = f; }
+  void setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT a) { align = a; }
+  void drawString(int16_t x, int16_t y, const String &text) {
+    const int cw = charWidth();
+    const int w = (int)text.length() * cw;
+    if (align == TEXT_ALIGN_CENTER || align == TEXT_ALIGN_CENTER_BOTH)
+      x -= w / 2;
+    else if (align == TEXT_ALIGN_RIGHT)
+      x -= w;
+    for (int c = 0; c < w; c++) {
+      const uint8_t ch = (uint8_t)text.c_str()[c / cw];
+      mark(x + c, y, charHeight(), (uint8_t)(ch * 31 + (c % cw) * 7 + 1));
+    }
+  }
+  void drawCircle(int16_t x, int16_t y, int16_t r) { shape(x, y, r, 0x81); }
+  void fillCircle(int16_t x, int16_t y, int16_t r) { shape(x, y, r, 0xFF); }
+  void drawRect(int16_t, int16_t, int16_t, int16_t) {}
+  void fillRect(int16_t, int16_t, int16_t, int16_t) {}
+  void drawHorizontalLine(int16_t, int16_t, int16_t) {}
+  void display() {
+    Wire.beginTransmission(address);
+    for (int i = 0; i < HOST_OLED_WIDTH * HOST_OLED_HEIGHT / 8 + 1; i++)
+      Wire.write((uint8_t)0);
+    Wire.endTransmission();
+  }
+
+  uint8_t *buffer; // Page-major, like the real driver: byte = 8 rows
+
+private:
+  int charWidth() const {
+    return font == ArialMT_Plain_24 ? 13 : font == ArialMT_Plain_16 ? 9 : 6;
+  }
+  int charHeight() const {
+    return font == ArialMT_Plain_24 ? 28 : font == ArialMT_Plain_16 ? 19 : 13;
+  }
+  void shape(int16_t x, int16_t y, int16_t r, uint8_t pattern) {
+    for (int c = x - r; c <= x + r; c++)
+      mark(c, y - r, 2 * r + 1, pattern);
+  }
+  // OR pattern into column x, rows [y, y + h)
+  void mark(int x, int y, int h, uint8_t pattern) {
+    if (x < 0 || x >= HOST_OLED_WIDTH)
+      return;
+    for (int row = y < 0 ? 0 : y; row < y + h && row < HOST_OLED_HEIGHT;
+         row++) {
+      if (pattern & (1 << (row & 7)))
+        pixels[(row / 8) * HOST_OLED_WIDTH + x] |= 1 << (row & 7);
+    }
+  }
+
+  uint8_t pixels[HOST_OLED_WIDTH * HOST_OLED_HEIGHT / 8] = {};
+  const uint8_t *font = ArialMT_Plain_10;
+  OLEDDISPLAY_TEXT_ALIGNMENT align = TEXT_ALIGN_LEFT;
+  uint8_t address;
+};
+
+#endif // HOST_SSD1306WIRE_H
@@ -0,0 +1,108 @@
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+// Arduino String on top of std::string (host builds only)
+
+#include <string>
+
+class String {
+public:
+  String() {}
+  String(const char *s) : s(s ? s : "") {}
+  String(const std::string &str) : s(str) {}
+  String(char c) : s(1, c) {}
+  String(int v, unsigned char base = 10) : s(fromLong(v, base)) {}
+  String(unsigned int v, unsigned char base = 10)
+      : s(fromULong(v, base)) {}
+  String(long v, unsigned char base = 10) : s(fromLong(v, base)) {}
+  String(unsigned long v, unsigned char base = 10)
+      : s(fromULong(v, base)) {}
+  String(unsigned char v, unsigned char base = 10)
+      : s(fromULong(v, base)) {}
+  String(float v, unsigned int decimals = 2) : s(fromDouble(v, decimals)) {}
+  String(double v, unsigned int decimals = 2) : s(fromDouble(v, decimals)) {}
+
+  unsigned int length() const { return (unsigned int)s.size(); }
+  const char *c_str() const { return s.c_str(); }
+  char operator[](unsigned int i) const { return i < s.size() ? s[i] : 0; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+
+  String substring(unsigned int from) const {
+    return from >= s.size() ? String() : String(s.substr(from));
+  }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to)
+      std::swap(from, to);
+    if (from >= s.size())
+      return String();
+    return String(s.substr(from, to - from));
+  }
+  int indexOf(const String &str) const {
+    size_t p = s.find(str.s);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  int indexOf(char c) const {
+    size_t p = s.find(c);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  bool startsWith(const String &str) const { return s.rfind(str.s, 0) == 0; }
+
+  void trim() {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    size_t e = s.find_last_not_of(" \t\r\n");
+    s = b == std::string::npos ? "" : s.substr(b, e - b + 1);
+  }
+  void toLowerCase() {
+    for (auto &c : s)
+      c = (char)tolower((unsigned char)c);
+  }
+  void toUpperCase() {
+    for (auto &c : s)
+      c = (char)toupper((unsigned char)c);
+  }
+  float toFloat() const { return (float)atof(s.c_str()); }
+  long toInt() const { return atol(s.c_str()); }
+
+  String &operator+=(const String &o) {
+    s += o.s;
+    return *this;
+  }
+  friend String operator+(const String &a, const String &b) {
+    return String(a.s + b.s);
+  }
+  friend String operator+(const char *a, const String &b) {
+    return String(std::string(a) + b.s);
+  }
+  friend String operator+(const String &a, const char *b) {
+    return String(a.s + b);
+  }
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator!=(const String &o) const { return s != o.s; }
+  bool operator==(const char *o) const { return s == o; }
+  bool operator!=(const char *o) const { return s != o; }
+
+private:
+  static std::string fromLong(long v, unsigned char base) {
+    if (v < 0 && base == 10)
+      return "-" + fromULong((unsigned long)(-v), base);
+    return fromULong((unsigned long)v, base);
+  }
+  static std::string fromULong(unsigned long v, unsigned char base) {
+    const char *digits = "0123456789ABCDEF";
+    std::string out;
+    do {
+      out.insert(out.begin(), digits[v % base]);
+      v /= base;
+    } while (v);
+    return out;
+  }
+  static std::string fromDouble(double v, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    return buf;
+  }
+
+  std::string s;
+};
+
+#endif // HOST_WSTRING_H
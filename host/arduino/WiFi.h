@@ -0,0 +1,32 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+#include "esp_wifi.h"
+
+typedef enum { WIFI_OFF = 0, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) {
+    currentMode = m;
+    return true;
+  }
+  bool disconnect(bool = false) { return true; }
+  bool setChannel(uint8_t ch) {
+    return esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE) == ESP_OK;
+  }
+  String macAddress();
+
+private:
+  wifi_mode_t currentMode = WIFI_OFF;
+};
+
+extern WiFiClass WiFi;
+
+// Station MAC reported by WiFi.macAddress() / esp_wifi_get_mac()
+void hostSetMacAddress(const uint8_t mac[6]);
+// Channel set by WiFi.setChannel() / esp_wifi_set_channel()
+uint8_t hostWifiChannel();
+
+#endif // HOST_WIFI_H
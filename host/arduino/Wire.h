@@ -0,0 +1,36 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+// I2C bus. Devices present on the bus are registered by the host driver so
+// scans and begin() probes find them.
+class TwoWire {
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t freq = 0);
+  void setClock(uint32_t freq) { clockHz = freq; }
+  uint32_t getClock() { return clockHz; }
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t data);
+  size_t write(const uint8_t *data, size_t len);
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t len, bool sendStop = true);
+  int available();
+  int read();
+
+  uint32_t clockHz = 100000;
+
+private:
+  uint8_t txAddress = 0;
+  size_t txLen = 0;
+  size_t rxLen = 0;
+};
+
+extern TwoWire Wire;
+
+// Make an address ACK on scans/probes
+void hostWireAddDevice(uint8_t address);
+// Total time spent on the bus so far (address + data bytes at clockHz)
+uint64_t hostWireBusyMicros();
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,17 @@
+#ifndef HOST_XPT2046_TOUCHSCREEN_H
+#define HOST_XPT2046_TOUCHSCREEN_H
+
+#include "Arduino.h"
+
+// Touch controller; the host driver presses and releases it
+class XPT2046_Touchscreen {
+public:
+  XPT2046_Touchscreen(uint8_t, uint8_t = 255) {}
+  bool begin() { return true; }
+  void setRotation(uint8_t) {}
+  bool touched() { return hostTouched; }
+
+  static bool hostTouched;
+};
+
+#endif // HOST_XPT2046_TOUCHSCREEN_H
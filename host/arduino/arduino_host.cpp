@@ -0,0 +1,135 @@
+// Host implementation of the Arduino shim: virtual clock, GPIO and Serial
+
+#include "Arduino.h"
+
+HardwareSerial Serial;
+
+static uint64_t nowUs = 0;
+static HostSleepHook sleepHook = nullptr;
+static HostAnalogReadHook analogHook = nullptr;
+static uint8_t pinLevels[64];
+
+// ===== Virtual clock =====
+static void advanceTo(uint64_t untilUs) {
+  if (sleepHook)
+    sleepHook(untilUs);
+  if (nowUs < untilUs)
+    nowUs = untilUs;
+}
+
+unsigned long millis() { return (unsigned long)(uint32_t)(nowUs / 1000); }
+unsigned long micros() { return (unsigned long)(uint32_t)nowUs; }
+void delay(uint32_t ms) { advanceTo(nowUs + (uint64_t)ms * 1000); }
+void delayMicroseconds(uint32_t us) { advanceTo(nowUs + us); }
+void hostAdvanceMicros(uint64_t us) { advanceTo(nowUs + us); }
+uint64_t hostMicros64() { return nowUs; }
+void hostSetMicros64(uint64_t us) { nowUs = us; }
+void hostSetSleepHook(HostSleepHook hook) { sleepHook = hook; }
+
+// ===== GPIO / ADC =====
+void hostSetAnalogReadHook(HostAnalogReadHook hook) { analogHook = hook; }
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t pin, uint8_t val) { pinLevels[pin & 63] = val; }
+int digitalRead(uint8_t pin) { return pinLevels[pin & 63]; }
+int analogRead(uint8_t pin) { return analogHook ? analogHook(pin) : 0; }
+void analogReadResolution(uint8_t) {}
+void analogSetAttenuation(adc_attenuation_t) {}
+
+// ===== Serial =====
+void HardwareSerial::hostFeed(const char *text) {
+  input += String(text);
+}
+
+int HardwareSerial::available() {
+  return (int)(input.length() - inputPos);
+}
+
+int HardwareSerial::read() {
+  if (inputPos >= input.length())
+    return -1;
+  int c = (unsigned char)input[inputPos++];
+  if (inputPos == input.length()) {
+    input = String();
+    inputPos = 0;
+  }
+  return c;
+}
+
+int HardwareSerial::peek() {
+  return inputPos < input.length() ? (unsigned char)input[inputPos] : -1;
+}
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t len) {
+  if (quiet)
+    return len;
+  if (output)
+    output(buf, len);
+  else
+    fwrite(buf, 1, len, stdout);
+  return len;
+}
+
+size_t HardwareSerial::print(const char *s) {
+  return write((const uint8_t *)s, strlen(s));
+}
+
+size_t HardwareSerial::print(char c) { return write((uint8_t)c); }
+
+size_t HardwareSerial::print(long v, int base) {
+  return print(String(v, (unsigned char)base));
+}
+
+size_t HardwareSerial::print(unsigned long v, int base) {
+  return print(String(v, (unsigned char)base));
+}
+
+size_t HardwareSerial::print(double v, int digits) {
+  return print(String(v, (unsigned int)digits));
+}
+
+size_t HardwareSerial::printf(const char *fmt, ...) {
+  char buf[512];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  return print(buf);
+}
+
+float HardwareSerial::parseFloat() {
+  while (available() && !(isdigit(peek()) || peek() == '-' || peek() == '.'))
+    read();
+  String num;
+  while (available() && (isdigit(peek()) || peek() == '-' || peek() == '.'))
+    num += String((char)read());
+  return num.toFloat();
+}
+
+long HardwareSerial::parseInt() {
+  while (available() && !(isdigit(peek()) || peek() == '-'))
+    read();
+  String num;
+  while (available() && (isdigit(peek()) || peek() == '-'))
+    num += String((char)read());
+  return num.toInt();
+}
+
+String HardwareSerial::readStringUntil(char terminator) {
+  String out;
+  while (available()) {
+    char c = (char)read();
+    if (c == terminator)
+      break;
+    out += String(c);
+  }
+  return out;
+}
+
+size_t HardwareSerial::readBytes(uint8_t *buf, size_t len) {
+  size_t n = 0;
+  while (n < len && available())
+    buf[n++] = (uint8_t)read();
+  return n;
+}
@@ -0,0 +1,93 @@
+#ifndef HOST_ESP_NOW_H
+#define HOST_ESP_NOW_H
+
+// ESP-NOW API surface used by the sketches. Frames are handed to a pluggable
+// backend; with none installed, sends succeed and go nowhere.
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_ESPNOW_NOT_INIT 0x3065
+#define ESP_ERR_ESPNOW_ARG 0x3066
+#define ESP_ERR_ESPNOW_NO_MEM 0x3067
+#define ESP_ERR_ESPNOW_FULL 0x3068
+#define ESP_ERR_ESPNOW_NOT_FOUND 0x3069
+#define ESP_ERR_ESPNOW_EXIST 0x306A
+
+#define ESP_NOW_ETH_ALEN 6
+#define ESP_NOW_MAX_DATA_LEN 250
+#define ESP_NOW_MAX_TOTAL_PEER_NUM 20
+
+typedef enum { WIFI_IF_STA = 0, WIFI_IF_AP } wifi_interface_t;
+
+typedef enum {
+  ESP_NOW_SEND_SUCCESS = 0,
+  ESP_NOW_SEND_FAIL,
+} esp_now_send_status_t;
+
+typedef struct {
+  uint8_t peer_addr[ESP_NOW_ETH_ALEN];
+  uint8_t lmk[16];
+  uint8_t channel;
+  wifi_interface_t ifidx;
+  bool encrypt;
+  void *priv;
+} esp_now_peer_info_t;
+
+typedef struct {
+  signed rssi : 8;
+  unsigned channel : 4;
+} wifi_pkt_rx_ctrl_t;
+
+typedef struct esp_now_recv_info {
+  uint8_t *src_addr;
+  uint8_t *des_addr;
+  wifi_pkt_rx_ctrl_t *rx_ctrl;
+} esp_now_recv_info_t;
+
+typedef struct {
+  const uint8_t *des_addr;
+  const uint8_t *src_addr;
+} esp_now_send_info_t;
+
+typedef void (*esp_now_recv_cb_t)(const esp_now_recv_info_t *info,
+                                  const uint8_t *data, int len);
+// Arduino-ESP32 3.3+ signature
+typedef void (*esp_now_send_cb_t)(const esp_now_send_info_t *info,
+                                  esp_now_send_status_t status);
+// Older signature still used by some sketches
+typedef void (*esp_now_send_cb_legacy_t)(const uint8_t *mac,
+                                         esp_now_send_status_t status);
+
+esp_err_t esp_now_init();
+esp_err_t esp_now_deinit();
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb);
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb);
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_legacy_t cb);
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t *peer);
+esp_err_t esp_now_del_peer(const uint8_t *peer_addr);
+bool esp_now_is_peer_exist(const uint8_t *peer_addr);
+esp_err_t esp_now_send(const uint8_t *peer_addr, const uint8_t *data,
+                       size_t len);
+
+// ===== Host backend =====
+// A radio model implements this to carry frames between simulated nodes.
+class HostEspNowBackend {
+public:
+  virtual ~HostEspNowBackend() {}
+  // Called from esp_now_send() after argument/peer checks. Return ESP_OK if
+  // the frame was queued; the backend later calls hostEspNowSendDone().
+  virtual esp_err_t transmit(const uint8_t *dest, const uint8_t *data,
+                             size_t len) = 0;
+};
+
+void hostEspNowSetBackend(HostEspNowBackend *backend);
+// Deliver a received frame to this node's registered recv callback
+void hostEspNowDeliver(const uint8_t *src, const uint8_t *dest,
+                       const uint8_t *data, int len, int rssi);
+// Report the MAC-level outcome of an earlier transmit to the send callback
+void hostEspNowSendDone(const uint8_t *dest, esp_now_send_status_t status);
+
+#endif // HOST_ESP_NOW_H
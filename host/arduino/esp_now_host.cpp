@@ -0,0 +1,139 @@
+// Host ESP-NOW stack: peer table, callbacks and a pluggable radio backend
+
+#include "Arduino.h"
+#include "WiFi.h"
+#include "esp_now.h"
+
+WiFiClass WiFi;
+
+static uint8_t stationMac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static uint8_t wifiChannel = 1;
+static bool espNowReady = false;
+static esp_now_recv_cb_t recvCb = nullptr;
+static esp_now_send_cb_t sendCb = nullptr;
+static esp_now_send_cb_legacy_t sendCbLegacy = nullptr;
+static HostEspNowBackend *backend = nullptr;
+
+static esp_now_peer_info_t peers[ESP_NOW_MAX_TOTAL_PEER_NUM];
+static int peerCount = 0;
+
+void hostSetMacAddress(const uint8_t mac[6]) { memcpy(stationMac, mac, 6); }
+uint8_t hostWifiChannel() { return wifiChannel; }
+
+String WiFiClass::macAddress() {
+  char buf[18];
+  snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", stationMac[0],
+           stationMac[1], stationMac[2], stationMac[3], stationMac[4],
+           stationMac[5]);
+  return String(buf);
+}
+
+esp_err_t esp_wifi_set_channel(uint8_t primary, wifi_second_chan_t) {
+  if (primary < 1 || primary > 14)
+    return ESP_FAIL;
+  wifiChannel = primary;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mac(wifi_interface_t, uint8_t mac[6]) {
+  memcpy(mac, stationMac, 6);
+  return ESP_OK;
+}
+
+esp_err_t esp_now_init() {
+  espNowReady = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_now_deinit() {
+  espNowReady = false;
+  peerCount = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) {
+  recvCb = cb;
+  return ESP_OK;
+}
+
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) {
+  sendCb = cb;
+  return ESP_OK;
+}
+
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_legacy_t cb) {
+  sendCbLegacy = cb;
+  return ESP_OK;
+}
+
+static int findPeer(const uint8_t *addr) {
+  for (int i = 0; i < peerCount; i++) {
+    if (memcmp(peers[i].peer_addr, addr, 6) == 0)
+      return i;
+  }
+  return -1;
+}
+
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t *peer) {
+  if (!espNowReady)
+    return ESP_ERR_ESPNOW_NOT_INIT;
+  if (findPeer(peer->peer_addr) >= 0)
+    return ESP_ERR_ESPNOW_EXIST;
+  if (peerCount >= ESP_NOW_MAX_TOTAL_PEER_NUM)
+    return ESP_ERR_ESPNOW_FULL;
+  peers[peerCount++] = *peer;
+  return ESP_OK;
+}
+
+esp_err_t esp_now_del_peer(const uint8_t *peer_addr) {
+  int i = findPeer(peer_addr);
+  if (i < 0)
+    return ESP_ERR_ESPNOW_NOT_FOUND;
+  peers[i] = peers[--peerCount];
+  return ESP_OK;
+}
+
+bool esp_now_is_peer_exist(const uint8_t *peer_addr) {
+  return findPeer(peer_addr) >= 0;
+}
+
+esp_err_t esp_now_send(const uint8_t *peer_addr, const uint8_t *data,
+                       size_t len) {
+  if (!espNowReady)
+    return ESP_ERR_ESPNOW_NOT_INIT;
+  if (data == nullptr || len == 0 || len > ESP_NOW_MAX_DATA_LEN)
+    return ESP_ERR_ESPNOW_ARG;
+  if (peer_addr != nullptr && findPeer(peer_addr) < 0)
+    return ESP_ERR_ESPNOW_NOT_FOUND;
+
+  if (backend == nullptr) {
+    hostEspNowSendDone(peer_addr, ESP_NOW_SEND_SUCCESS);
+    return ESP_OK;
+  }
+  return backend->transmit(peer_addr, data, len);
+}
+
+void hostEspNowSetBackend(HostEspNowBackend *b) { backend = b; }
+
+void hostEspNowDeliver(const uint8_t *src, const uint8_t *dest,
+                       const uint8_t *data, int len, int rssi) {
+  if (!espNowReady || recvCb == nullptr)
+    return;
+  uint8_t srcCopy[6], destCopy[6];
+  memcpy(srcCopy, src, 6);
+  memcpy(destCopy, dest, 6);
+  wifi_pkt_rx_ctrl_t ctrl = {};
+  ctrl.rssi = rssi;
+  ctrl.channel = wifiChannel;
+  esp_now_recv_info_t info = {srcCopy, destCopy, &ctrl};
+  recvCb(&info, data, len);
+}
+
+void hostEspNowSendDone(const uint8_t *dest, esp_now_send_status_t status) {
+  if (sendCb) {
+    esp_now_send_info_t info = {dest, stationMac};
+    sendCb(&info, status);
+  }
+  if (sendCbLegacy)
+    sendCbLegacy(dest, status);
+}
@@ -0,0 +1,9 @@
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include "Arduino.h"
+
+// Microseconds since boot on the virtual clock
+inline int64_t esp_timer_get_time() { return (int64_t)hostMicros64(); }
+
+#endif // HOST_ESP_TIMER_H
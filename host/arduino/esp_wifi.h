@@ -0,0 +1,11 @@
+#ifndef HOST_ESP_WIFI_H
+#define HOST_ESP_WIFI_H
+
+#include "esp_now.h"
+
+typedef enum { WIFI_SECOND_CHAN_NONE = 0 } wifi_second_chan_t;
+
+esp_err_t esp_wifi_set_channel(uint8_t primary, wifi_second_chan_t second);
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6]);
+
+#endif // HOST_ESP_WIFI_H
@@ -0,0 +1,79 @@
+// Host stand-ins for SPI, SD, touch, I2C and the sender sensor chips
+
+#include "Adafruit_ADS1X15.h"
+#include "Adafruit_MAX31856.h"
+#include "SD.h"
+#include "SSD1306Wire.h"
+#include "SPI.h"
+#include "Wire.h"
+#include "XPT2046_Touchscreen_TT.h"
+
+SPIClass SPI;
+SDClass SD;
+TwoWire Wire;
+bool XPT2046_Touchscreen::hostTouched = false;
+
+bool Adafruit_MAX31856::hostPresent = true;
+float Adafruit_MAX31856::hostThermocoupleC = 90.0f;
+float Adafruit_MAX31856::hostColdJunctionC = 25.0f;
+uint8_t Adafruit_MAX31856::hostFault = 0;
+float Adafruit_ADS1115::hostVolts[4] = {0, 0, 0, 0};
+HostAdsReadHook Adafruit_ADS1115::hostReadHook = nullptr;
+
+const uint8_t ArialMT_Plain_10[] = {0};
+const uint8_t ArialMT_Plain_16[] = {0};
+const uint8_t ArialMT_Plain_24[] = {0};
+
+static bool i2cPresent[128];
+static uint64_t i2cBusyUs = 0;
+
+void hostWireAddDevice(uint8_t address) { i2cPresent[address & 0x7F] = true; }
+uint64_t hostWireBusyMicros() { return i2cBusyUs; }
+
+// 9 clocks per byte (8 data + ACK) plus start/stop
+static void chargeBus(size_t bytes, uint32_t clockHz) {
+  uint64_t us = ((bytes * 9 + 2) * 1000000ULL) / clockHz;
+  i2cBusyUs += us;
+  hostAdvanceMicros(us);
+}
+
+bool TwoWire::begin(int, int, uint32_t freq) {
+  if (freq)
+    clockHz = freq;
+  return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  txAddress = address;
+  txLen = 0;
+}
+
+size_t TwoWire::write(uint8_t) {
+  txLen++;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *, size_t len) {
+  txLen += len;
+  return len;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  chargeBus(1 + txLen, clockHz);
+  return i2cPresent[txAddress & 0x7F] ? 0 : 2; // 2 = NACK on address
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t len, bool) {
+  chargeBus(1 + len, clockHz);
+  rxLen = i2cPresent[address & 0x7F] ? len : 0;
+  return (uint8_t)rxLen;
+}
+
+int TwoWire::available() { return (int)rxLen; }
+
+int TwoWire::read() {
+  if (rxLen == 0)
+    return -1;
+  rxLen--;
+  return 0;
+}
@@ -0,0 +1,134 @@
+// In-process NVS store for the Preferences shim
+
+#include "Preferences.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+static std::map<std::string, std::vector<uint8_t>> store;
+static HostPreferencesStats stats;
+
+static std::string fullKey(const String &ns, const char *key) {
+  return std::string(ns.c_str()) + "/" + key;
+}
+
+HostPreferencesStats hostPreferencesStats() { return stats; }
+void hostPreferencesResetStats() { stats = HostPreferencesStats(); }
+void hostPreferencesErase() { store.clear(); }
+
+bool Preferences::begin(const char *name, bool ro) {
+  ns = String(name);
+  opened = true;
+  readOnly = ro;
+  stats.opens++;
+  return true;
+}
+
+void Preferences::end() { opened = false; }
+
+bool Preferences::clear() {
+  if (!opened || readOnly)
+    return false;
+  std::string prefix = std::string(ns.c_str()) + "/";
+  for (auto it = store.begin(); it != store.end();) {
+    if (it->first.compare(0, prefix.size(), prefix) == 0)
+      it = store.erase(it);
+    else
+      ++it;
+  }
+  stats.writes++;
+  return true;
+}
+
+bool Preferences::remove(const char *key) {
+  if (!opened || readOnly)
+    return false;
+  stats.writes++;
+  return store.erase(fullKey(ns, key)) > 0;
+}
+
+bool Preferences::isKey(const char *key) {
+  stats.reads++;
+  return opened && store.count(fullKey(ns, key)) > 0;
+}
+
+size_t Preferences::put(const char *key, const void *value, size_t len) {
+  if (!opened || readOnly)
+    return 0;
+  const uint8_t *p = (const uint8_t *)value;
+  store[fullKey(ns, key)] = std::vector<uint8_t>(p, p + len);
+  stats.writes++;
+  stats.bytesWritten += len;
+  return len;
+}
+
+bool Preferences::get(const char *key, void *buf, size_t len) {
+  stats.reads++;
+  if (!opened)
+    return false;
+  auto it = store.find(fullKey(ns, key));
+  if (it == store.end() || it->second.size() != len)
+    return false;
+  memcpy(buf, it->second.data(), len);
+  return true;
+}
+
+size_t Preferences::putUChar(const char *key, uint8_t v) {
+  return put(key, &v, sizeof(v));
+}
+size_t Preferences::putInt(const char *key, int32_t v) {
+  return put(key, &v, sizeof(v));
+}
+size_t Preferences::putUInt(const char *key, uint32_t v) {
+  return put(key, &v, sizeof(v));
+}
+size_t Preferences::putFloat(const char *key, float v) {
+  return put(key, &v, sizeof(v));
+}
+size_t Preferences::putString(const char *key, const String &v) {
+  return put(key, v.c_str(), v.length() + 1);
+}
+size_t Preferences::putBytes(const char *key, const void *v, size_t len) {
+  return put(key, v, len);
+}
+
+uint8_t Preferences::getUChar(const char *key, uint8_t d) {
+  uint8_t v;
+  return get(key, &v, sizeof(v)) ? v : d;
+}
+int32_t Preferences::getInt(const char *key, int32_t d) {
+  int32_t v;
+  return get(key, &v, sizeof(v)) ? v : d;
+}
+uint32_t Preferences::getUInt(const char *key, uint32_t d) {
+  uint32_t v;
+  return get(key, &v, sizeof(v)) ? v : d;
+}
+float Preferences::getFloat(const char *key, float d) {
+  float v;
+  return get(key, &v, sizeof(v)) ? v : d;
+}
+
+String Preferences::getString(const char *key, const String &d) {
+  stats.reads++;
+  auto it = store.find(fullKey(ns, key));
+  if (!opened || it == store.end() || it->second.empty())
+    return d;
+  return String((const char *)it->second.data());
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  stats.reads++;
+  auto it = store.find(fullKey(ns, key));
+  return (opened && it != store.end()) ? it->second.size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+  stats.reads++;
+  auto it = store.find(fullKey(ns, key));
+  if (!opened || it == store.end() || it->second.size() > maxLen)
+    return 0;
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
@@ -0,0 +1,102 @@
+#!/bin/sh
+# Build the host emulators into host/build/.
+#
+# Usage: host/build.sh
+set -e
+
+HOST_DIR=$(cd "$(dirname "$0")" && pwd)
+FW_DIR="$HOST_DIR/../firmware"
+OUT="$HOST_DIR/build"
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:-"-std=gnu++17 -O1 -g -Wall -Wno-format -Wno-unused"}
+LIBS="-I $FW_DIR/libraries/VehiclePackets/src"
+
+mkdir -p "$OUT"
+
+ARDUINO_SRCS="$HOST_DIR/arduino/arduino_host.cpp \
+  $HOST_DIR/arduino/esp_now_host.cpp \
+  $HOST_DIR/arduino/preferences_host.cpp \
+  $HOST_DIR/arduino/peripherals_host.cpp"
+
+# CYD display
+CYD_SKETCH="$FW_DIR/display/CYD_Speedo_Modern2"
+python3 "$HOST_DIR/ino2cpp.py" "$CYD_SKETCH/CYD_Speedo_Modern2.ino" \
+  "$OUT/CYD_Speedo_Modern2.cpp"
+$CXX $CXXFLAGS $LIBS \
+  -I "$HOST_DIR/cyd_emulator" -I "$HOST_DIR/arduino" -I "$CYD_SKETCH" \
+  "$OUT/CYD_Speedo_Modern2.cpp" \
+  "$HOST_DIR/cyd_emulator/tft_emulator.cpp" \
+  "$HOST_DIR/cyd_emulator/cyd_emulator.cpp" \
+  $ARDUINO_SRCS \
+  -o "$OUT/cyd_emulator"
+
+echo "Built $OUT/cyd_emulator"
+
+# Packet codec benchmark
+$CXX $CXXFLAGS -O2 $LIBS "$HOST_DIR/packet_bench/packet_bench.cpp" \
+  -o "$OUT/packet_bench"
+echo "Built $OUT/packet_bench"
+
+# Lost-frame recovery simulator
+$CXX $CXXFLAGS $LIBS "$HOST_DIR/loss_sim/loss_sim.cpp" -o "$OUT/loss_sim"
+echo "Built $OUT/loss_sim"
+
+# Settings storage bench: the oil sender's settings.cpp on the Preferences shim
+$CXX $CXXFLAGS $LIBS -I "$HOST_DIR/arduino" -I "$FW_DIR/sender-oil" \
+  "$HOST_DIR/settings_bench/settings_bench.cpp" \
+  "$FW_DIR/sender-oil/settings.cpp" $ARDUINO_SRCS -o "$OUT/settings_bench"
+echo "Built $OUT/settings_bench"
+
+# Trip computer replay: the CYD's trip_computer.h on vehicle simulator drives
+$CXX $CXXFLAGS $LIBS -I "$CYD_SKETCH" -I "$FW_DIR/sender-fuel" \
+  -I "$HOST_DIR/vehicle_sim" "$HOST_DIR/trip_replay/trip_replay.cpp" \
+  "$HOST_DIR/vehicle_sim/vehicle_sim.cpp" -o "$OUT/trip_replay"
+echo "Built $OUT/trip_replay"
+
+# ESP-NOW soak test, optionally driven by the vehicle simulator: each sketch becomes a node shared object with its own
+# copy of the Arduino shim, loaded side by side by the radio medium
+NODE_DIR="$OUT/nodes"
+NODE_FLAGS="-fPIC -shared -fvisibility=hidden -Wl,-Bsymbolic \
+  -I $HOST_DIR/arduino -I $HOST_DIR/radio_medium"
+NODE_SRCS="$ARDUINO_SRCS $HOST_DIR/radio_medium/node_api.cpp"
+mkdir -p "$NODE_DIR"
+
+$CXX $CXXFLAGS $LIBS $NODE_FLAGS \
+  -I "$HOST_DIR/cyd_emulator" -I "$CYD_SKETCH" \
+  "$OUT/CYD_Speedo_Modern2.cpp" \
+  "$HOST_DIR/cyd_emulator/tft_emulator.cpp" \
+  $NODE_SRCS -o "$NODE_DIR/cyd.so"
+
+OIL_SKETCH="$FW_DIR/sender-oil"
+python3 "$HOST_DIR/ino2cpp.py" "$OIL_SKETCH/sender.ino" "$OUT/sender.cpp"
+$CXX $CXXFLAGS $LIBS $NODE_FLAGS -I "$OIL_SKETCH" \
+  "$OUT/sender.cpp" "$OIL_SKETCH/console_menu.cpp" "$OIL_SKETCH/settings.cpp" \
+  "$OIL_SKETCH/device_map.cpp" "$OIL_SKETCH/alarms.cpp" \
+  "$OIL_SKETCH/i2c_bus.cpp" "$OIL_SKETCH/oled_pages.cpp" \
+  $NODE_SRCS -o "$NODE_DIR/oil.so"
+
+FUEL_SKETCH="$FW_DIR/sender-fuel"
+python3 "$HOST_DIR/ino2cpp.py" "$FUEL_SKETCH/fuel_sender.ino" \
+  "$OUT/fuel_sender.cpp"
+$CXX $CXXFLAGS $LIBS $NODE_FLAGS -I "$FUEL_SKETCH" \
+  "$OUT/fuel_sender.cpp" "$FUEL_SKETCH/fuel_calibration.cpp" \
+  $NODE_SRCS -o "$NODE_DIR/fuel.so"
+
+$CXX $CXXFLAGS -I "$HOST_DIR/arduino" -I "$HOST_DIR/vehicle_sim" $LIBS \
+  "$HOST_DIR/radio_medium/radio_medium.cpp" \
+  "$HOST_DIR/radio_medium/espnow_soak.cpp" \
+  "$HOST_DIR/vehicle_sim/vehicle_sim.cpp" \
+  -o "$OUT/espnow_soak" -ldl -pthread
+echo "Built $OUT/espnow_soak"
+
+# Laptop telemetry recorder and query tool, and the store bench
+TLM_DIR="$HOST_DIR/../laptop/telemetry"
+$CXX $CXXFLAGS $LIBS -I "$TLM_DIR" "$TLM_DIR/telemetry_rec.cpp" \
+  "$TLM_DIR/telemetry_store.cpp" -o "$OUT/telemetry_rec"
+$CXX $CXXFLAGS $LIBS -I "$TLM_DIR" "$TLM_DIR/telemetry_query.cpp" \
+  "$TLM_DIR/telemetry_store.cpp" -o "$OUT/telemetry_query"
+echo "Built $OUT/telemetry_rec, $OUT/telemetry_query"
+$CXX $CXXFLAGS -O2 $LIBS -I "$TLM_DIR" \
+  "$HOST_DIR/telemetry_bench/telemetry_bench.cpp" \
+  "$TLM_DIR/telemetry_store.cpp" -o "$OUT/telemetry_bench"
+echo "Built $OUT/telemetry_bench"
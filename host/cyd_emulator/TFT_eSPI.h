@@ -0,0 +1,146 @@
+#ifndef HOST_TFT_ESPI_H
+#define HOST_TFT_ESPI_H
+
+// ============================================================================
+// HOST TFT_eSPI
+// ============================================================================
+// Draws into an in-memory RGB565 framebuffer and charges every call the SPI
+// bytes it would cost on the real ILI9341, following the same decomposition
+// TFT_eSPI uses (round rects and circles become fast lines, scaled GLCD text
+// becomes one fillRect per font pixel, and so on).
+//
+// Transfer time at TFT_SPI_HZ is added to the virtual clock, so micros()
+// measurements inside the sketch reflect bus time.
+
+#include "Arduino.h"
+
+#define TFT_SPI_HZ 40000000 // SPI_FREQUENCY in the CYD User_Setup.h
+#define TFT_NATIVE_W 240
+#define TFT_NATIVE_H 320
+
+// Bytes to address a window: CASET + 4, RASET + 4, RAMWR
+#define TFT_WINDOW_BYTES 11
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_MAROON 0x7800
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_ORANGE 0xFDA0
+#define TFT_WHITE 0xFFFF
+#define TFT_DARKGREY 0x7BEF
+#define TFT_LIGHTGREY 0xD69A
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+typedef struct {
+  uint64_t bytes;       // Bytes clocked over SPI (commands + pixel data)
+  uint64_t pixelBytes;  // Of which pixel data
+  uint32_t windows;     // Address windows set (one per primitive/run)
+  uint32_t calls;       // Public drawing calls made by the sketch
+  uint64_t busyMicros;  // Bus time at TFT_SPI_HZ
+} TftTraffic;
+
+class TFT_eSPI {
+public:
+  TFT_eSPI(int16_t w = TFT_NATIVE_W, int16_t h = TFT_NATIVE_H);
+
+  void init();
+  void begin() { init(); }
+  void setRotation(uint8_t r);
+  int16_t width() const { return w; }
+  int16_t height() const { return h; }
+
+  void startWrite() {}
+  void endWrite() {}
+  bool initDMA(bool = false) { return true; }
+  void dmaWait();
+  bool dmaBusy();
+  void setSwapBytes(bool swap) { swapBytes = swap; }
+
+  void fillScreen(uint16_t color);
+  void drawPixel(int32_t x, int32_t y, uint16_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t len, uint16_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t len, uint16_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+  void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r,
+                     uint16_t color);
+  void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r,
+                     uint16_t color);
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint16_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint16_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                uint16_t color);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h,
+                 const uint16_t *data);
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h,
+                    uint16_t *data, uint16_t *buffer = nullptr);
+
+  // GLCD (font 1) text only; free fonts are not emulated
+  void setTextDatum(uint8_t d) { datum = d; }
+  void setTextSize(uint8_t s) { textSize = s ? s : 1; }
+  void setTextFont(uint8_t) {}
+  void setFreeFont(const void *) {}
+  void setTextColor(uint16_t fg) {
+    textFg = fg;
+    textBg = fg; // Same colour = transparent background
+  }
+  void setTextColor(uint16_t fg, uint16_t bg) {
+    textFg = fg;
+    textBg = bg;
+  }
+  int16_t textWidth(const String &s) const {
+    return (int16_t)(s.length() * 6 * textSize);
+  }
+  int16_t fontHeight() const { return (int16_t)(8 * textSize); }
+  int16_t drawString(const String &s, int32_t x, int32_t y);
+  int16_t drawString(const char *s, int32_t x, int32_t y) {
+    return drawString(String(s), x, y);
+  }
+  int16_t drawChar(uint16_t c, int32_t x, int32_t y);
+
+  // ===== Host API =====
+  const uint16_t *framebuffer() const { return fb; }
+  uint16_t pixel(int32_t x, int32_t y) const;
+  TftTraffic traffic() const { return stats; }
+  void resetTraffic() { stats = TftTraffic(); }
+  bool writePNG(const char *path) const;
+
+private:
+  void chargeWindow(uint64_t pixels);
+  void chargeBytes(uint64_t bytes, bool dma);
+  void plot(int32_t x, int32_t y, uint16_t color);
+  void fillCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t corners,
+                        int32_t delta, uint16_t color);
+  void drawCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t corners,
+                        uint16_t color);
+
+  int16_t w, h;
+  uint8_t rotation = 0;
+  uint16_t fb[TFT_NATIVE_W * TFT_NATIVE_H];
+
+  uint8_t datum = TL_DATUM;
+  uint8_t textSize = 1;
+  uint16_t textFg = TFT_WHITE;
+  uint16_t textBg = TFT_BLACK;
+  bool swapBytes = false;
+
+  uint64_t dmaDoneUs = 0;
+  TftTraffic stats;
+};
+
+#endif // HOST_TFT_ESPI_H
@@ -0,0 +1,248 @@
+// ============================================================================
+// CYD DISPLAY EMULATOR
+// ============================================================================
+// Runs CYD_Speedo_Modern2.ino on Linux against the host TFT_eSPI, feeding it
+// a scripted sequence of GPS lines, ESP-NOW packets and touches. Reports the
+// SPI traffic of every rendered frame and can dump PNG frames.
+//
+// Usage: cyd_emulator SCRIPT [--png-dir DIR] [--every-frame]
+//                            [--max-frame-bytes N] [--max-total-bytes N]
+//
+// Script lines (times in ms since boot, '#' starts a comment):
+//   <ms> gps <speed|fix|lat|lon|alt|heading|sats>
+//   <ms> oil <oil temp C> <oil pressure PSI>
+//   <ms> fuel <percent> [fault flags]
+//   <ms> touch <down|up>
+//   <ms> png <name>
+//   <ms> end
+//
+// oil and fuel lines before the CYD's first pair request (its first loop())
+// are skipped, as a real sender with no receivers would skip them.
+//
+// Exit status is 1 if a --max-* budget is exceeded, so CI can catch
+// rendering regressions.
+
+#include "Arduino.h"
+#include "TFT_eSPI.h"
+#include "XPT2046_Touchscreen_TT.h"
+#include "esp_now.h"
+#include <packet_link.h>
+#include <vehicle_packets.h>
+
+#include <string>
+#include <vector>
+
+void setup();
+void loop();
+extern TFT_eSPI tft;
+
+static const uint8_t OIL_MAC[6] = {0x98, 0xA3, 0x16, 0x8E, 0x6A, 0xE4};
+static const uint8_t FUEL_MAC[6] = {0x98, 0xA3, 0x16, 0x8E, 0x6A, 0xE5};
+static const uint8_t CYD_MAC[6] = {0x08, 0xD1, 0xF9, 0x2A, 0x08, 0xBC};
+
+// Senders are treated as synced to the display's beacon, with each reading
+// taken this long before its packet arrives
+#define SAMPLE_AGE_MS 40
+
+// Plays both senders' side of the link: answers the CYD's pair requests
+// straight away. Like the real senders, nothing is sent before it asks.
+class SenderRadio : public HostEspNowBackend {
+public:
+  bool paired = false;
+
+  esp_err_t transmit(const uint8_t *dest, const uint8_t *data,
+                     size_t len) override {
+    PairRequestPacketView request(data, len);
+    if (request.valid()) {
+      accept(OIL_MAC, MSG_TYPE_OIL, request.groupId());
+      accept(FUEL_MAC, MSG_TYPE_FUEL, request.groupId());
+      paired = true;
+    }
+    hostEspNowSendDone(dest, ESP_NOW_SEND_SUCCESS);
+    return ESP_OK;
+  }
+
+private:
+  static void accept(const uint8_t *mac, uint8_t type, uint8_t group) {
+    PairAcceptPacket pkt = {};
+    pkt.groupId = group;
+    pkt.dataType = type;
+    packetSeal(&pkt);
+    hostEspNowDeliver(mac, CYD_MAC, (const uint8_t *)&pkt, sizeof(pkt), -50);
+  }
+};
+
+static SenderRadio senderRadio;
+
+struct Event {
+  uint32_t ms;
+  std::string kind;
+  std::string arg;
+};
+
+static void deliverOil(float tempC, float psi) {
+  static uint16_t seq = 0;
+  if (!senderRadio.paired)
+    return;
+  TempDataPacket pkt = {};
+  pkt.timestamp = millis() - SAMPLE_AGE_MS;
+  pkt.timeSource = TIME_SOURCE_DISPLAY;
+  pkt.oilTemperature = tempC;
+  pkt.oilPressure = psi;
+  pkt.sensorsStatus = 0x05;
+  pkt.sequenceNumber = seq++;
+  packetSeal(&pkt);
+  hostEspNowDeliver(OIL_MAC, CYD_MAC, (const uint8_t *)&pkt, sizeof(pkt), -50);
+}
+
+static void deliverFuel(int percent, int faults) {
+  static uint16_t seq = 0;
+  if (!senderRadio.paired)
+    return;
+  FuelDataPacket pkt = {};
+  pkt.fuel_percent = (uint8_t)percent;
+  pkt.fault_status = (uint8_t)faults;
+  pkt.timestamp = millis() - SAMPLE_AGE_MS;
+  pkt.timeSource = TIME_SOURCE_DISPLAY;
+  pkt.sequence_number = seq++;
+  packetSeal(&pkt);
+  hostEspNowDeliver(FUEL_MAC, CYD_MAC, (const uint8_t *)&pkt, sizeof(pkt),
+                    -55);
+}
+
+static bool loadScript(const char *path, std::vector<Event> &events) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+  char line[512];
+  while (fgets(line, sizeof(line), f)) {
+    std::string s(line);
+    size_t hash = s.find('#');
+    if (hash != std::string::npos)
+      s = s.substr(0, hash);
+    while (!s.empty() && (s.back() == '\n' || s.back() == '\r' ||
+                          s.back() == ' '))
+      s.pop_back();
+    if (s.empty())
+      continue;
+
+    char kind[16] = {0};
+    unsigned ms = 0;
+    int consumed = 0;
+    if (sscanf(s.c_str(), "%u %15s %n", &ms, kind, &consumed) < 2)
+      continue;
+    Event e = {ms, kind, s.substr(consumed)};
+    events.push_back(e);
+  }
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *scriptPath = nullptr;
+  std::string pngDir;
+  bool everyFrame = false;
+  uint64_t maxFrameBytes = 0, maxTotalBytes = 0;
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    if (a == "--png-dir" && i + 1 < argc)
+      pngDir = argv[++i];
+    else if (a == "--every-frame")
+      everyFrame = true;
+    else if (a == "--max-frame-bytes" && i + 1 < argc)
+      maxFrameBytes = strtoull(argv[++i], nullptr, 10);
+    else if (a == "--max-total-bytes" && i + 1 < argc)
+      maxTotalBytes = strtoull(argv[++i], nullptr, 10);
+    else
+      scriptPath = argv[i];
+  }
+  if (!scriptPath) {
+    fprintf(stderr, "usage: %s SCRIPT [--png-dir DIR] [--every-frame] "
+                    "[--max-frame-bytes N] [--max-total-bytes N]\n",
+            argv[0]);
+    return 2;
+  }
+
+  std::vector<Event> events;
+  if (!loadScript(scriptPath, events)) {
+    fprintf(stderr, "cannot read %s\n", scriptPath);
+    return 2;
+  }
+
+  Serial.hostSetQuiet(true);
+  hostEspNowSetBackend(&senderRadio);
+  setup();
+  TftTraffic boot = tft.traffic();
+  printf("boot: %llu bytes, %u windows, %.1f ms bus\n",
+         (unsigned long long)boot.bytes, boot.windows,
+         boot.busyMicros / 1000.0);
+  tft.resetTraffic();
+
+  uint32_t endMs = events.empty() ? 10000 : events.back().ms;
+  size_t next = 0;
+  int frame = 0;
+  uint64_t totalBytes = 0, worstFrame = 0;
+  bool overBudget = false;
+
+  printf("%8s %6s %9s %7s %6s %8s\n", "t_ms", "frame", "bytes", "windows",
+         "calls", "bus_us");
+  while (millis() <= endMs) {
+    while (next < events.size() && events[next].ms <= millis()) {
+      const Event &e = events[next++];
+      if (e.kind == "gps") {
+        Serial.hostFeed((e.arg + "\n").c_str());
+      } else if (e.kind == "oil") {
+        float t = 0, p = 0;
+        sscanf(e.arg.c_str(), "%f %f", &t, &p);
+        deliverOil(t, p);
+      } else if (e.kind == "fuel") {
+        int pct = 0, faults = 0;
+        sscanf(e.arg.c_str(), "%d %d", &pct, &faults);
+        deliverFuel(pct, faults);
+      } else if (e.kind == "touch") {
+        XPT2046_Touchscreen::hostTouched = e.arg == "down";
+      } else if (e.kind == "png" && !pngDir.empty()) {
+        std::string path = pngDir + "/" + e.arg + ".png";
+        tft.writePNG(path.c_str());
+      }
+    }
+
+    tft.resetTraffic();
+    loop();
+    TftTraffic t = tft.traffic();
+    if (t.bytes == 0)
+      continue;
+
+    frame++;
+    totalBytes += t.bytes;
+    if (t.bytes > worstFrame)
+      worstFrame = t.bytes;
+    printf("%8lu %6d %9llu %7u %6u %8llu\n", millis(), frame,
+           (unsigned long long)t.bytes, t.windows, t.calls,
+           (unsigned long long)t.busyMicros);
+    if (maxFrameBytes && t.bytes > maxFrameBytes) {
+      printf("  ^ exceeds --max-frame-bytes %llu\n",
+             (unsigned long long)maxFrameBytes);
+      overBudget = true;
+    }
+    if (everyFrame && !pngDir.empty()) {
+      char path[512];
+      snprintf(path, sizeof(path), "%s/frame_%05d.png", pngDir.c_str(),
+               frame);
+      tft.writePNG(path);
+    }
+  }
+
+  printf("\nframes: %d  total: %llu bytes  avg/frame: %llu  worst frame: "
+         "%llu\n",
+         frame, (unsigned long long)totalBytes,
+         (unsigned long long)(frame ? totalBytes / frame : 0),
+         (unsigned long long)worstFrame);
+  if (maxTotalBytes && totalBytes > maxTotalBytes) {
+    printf("total exceeds --max-total-bytes %llu\n",
+           (unsigned long long)maxTotalBytes);
+    overBudget = true;
+  }
+  return overBudget ? 1 : 0;
+}
@@ -0,0 +1,491 @@
+// Host TFT_eSPI: RGB565 framebuffer plus ILI9341 SPI traffic accounting
+
+#include "TFT_eSPI.h"
+#include "glcd_font.h"
+
+#include <vector>
+
+// Counts a public call once even when it is built from other primitives
+struct CallScope {
+  static int depth;
+  CallScope(TftTraffic &stats) {
+    if (depth++ == 0)
+      stats.calls++;
+  }
+  ~CallScope() { depth--; }
+};
+int CallScope::depth = 0;
+
+TFT_eSPI::TFT_eSPI(int16_t width, int16_t height) : w(width), h(height) {
+  memset(fb, 0, sizeof(fb));
+}
+
+void TFT_eSPI::init() {
+  // Init sequence is ~100 bytes of commands plus the panel's reset delays
+  chargeBytes(100, false);
+  hostAdvanceMicros(120000);
+}
+
+void TFT_eSPI::setRotation(uint8_t r) {
+  rotation = r & 3;
+  chargeBytes(2, false); // MADCTL
+  bool landscape = rotation & 1;
+  w = landscape ? TFT_NATIVE_H : TFT_NATIVE_W;
+  h = landscape ? TFT_NATIVE_W : TFT_NATIVE_H;
+}
+
+// ===== Bus accounting =====
+
+void TFT_eSPI::chargeBytes(uint64_t bytes, bool dma) {
+  uint64_t us = (bytes * 8 * 1000000ULL + TFT_SPI_HZ - 1) / TFT_SPI_HZ;
+  stats.bytes += bytes;
+  stats.busyMicros += us;
+
+  uint64_t now = hostMicros64();
+  if (dma) {
+    // Queued behind any transfer in flight; the CPU carries on
+    uint64_t start = dmaDoneUs > now ? dmaDoneUs : now;
+    dmaDoneUs = start + us;
+  } else {
+    // Blocking transfers wait for DMA to drain first
+    if (dmaDoneUs > now)
+      hostAdvanceMicros(dmaDoneUs - now);
+    hostAdvanceMicros(us);
+  }
+}
+
+void TFT_eSPI::chargeWindow(uint64_t pixels) {
+  stats.windows++;
+  stats.pixelBytes += pixels * 2;
+  chargeBytes(TFT_WINDOW_BYTES + pixels * 2, false);
+}
+
+void TFT_eSPI::dmaWait() {
+  uint64_t now = hostMicros64();
+  if (dmaDoneUs > now)
+    hostAdvanceMicros(dmaDoneUs - now);
+}
+
+bool TFT_eSPI::dmaBusy() { return dmaDoneUs > hostMicros64(); }
+
+// ===== Framebuffer =====
+
+void TFT_eSPI::plot(int32_t x, int32_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= w || y >= h)
+    return;
+  fb[y * w + x] = color;
+}
+
+uint16_t TFT_eSPI::pixel(int32_t x, int32_t y) const {
+  if (x < 0 || y < 0 || x >= w || y >= h)
+    return 0;
+  return fb[y * w + x];
+}
+
+// ===== Primitives =====
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t rw, int32_t rh,
+                        uint16_t color) {
+  CallScope scope(stats);
+  // Clip as TFT_eSPI does before opening the window
+  if (x < 0) {
+    rw += x;
+    x = 0;
+  }
+  if (y < 0) {
+    rh += y;
+    y = 0;
+  }
+  if (x + rw > w)
+    rw = w - x;
+  if (y + rh > h)
+    rh = h - y;
+  if (rw <= 0 || rh <= 0)
+    return;
+
+  for (int32_t j = y; j < y + rh; j++) {
+    uint16_t *row = fb + j * w;
+    for (int32_t i = x; i < x + rw; i++)
+      row[i] = color;
+  }
+  chargeWindow((uint64_t)rw * rh);
+}
+
+void TFT_eSPI::fillScreen(uint16_t color) {
+  CallScope scope(stats);
+  fillRect(0, 0, w, h, color);
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint16_t color) {
+  CallScope scope(stats);
+  if (x < 0 || y < 0 || x >= w || y >= h)
+    return;
+  plot(x, y, color);
+  chargeWindow(1);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t len,
+                             uint16_t color) {
+  CallScope scope(stats);
+  fillRect(x, y, len, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t len,
+                             uint16_t color) {
+  CallScope scope(stats);
+  fillRect(x, y, 1, len, color);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t rw, int32_t rh,
+                        uint16_t color) {
+  CallScope scope(stats);
+  drawFastHLine(x, y, rw, color);
+  drawFastHLine(x, y + rh - 1, rw, color);
+  drawFastVLine(x, y + 1, rh - 2, color);
+  drawFastVLine(x + rw - 1, y + 1, rh - 2, color);
+}
+
+// Same scanline decomposition as TFT_eSPI: corners 1 = bottom, 2 = top
+void TFT_eSPI::fillCircleHelper(int32_t x0, int32_t y0, int32_t r,
+                                uint8_t corners, int32_t delta,
+                                uint16_t color) {
+  int32_t f = 1 - r;
+  int32_t ddF_x = 1;
+  int32_t ddF_y = -r - r;
+  int32_t y = 0;
+  delta++;
+  while (y < r) {
+    if (f >= 0) {
+      if (corners & 0x1)
+        drawFastHLine(x0 - y, y0 + r, y + y + delta, color);
+      if (corners & 0x2)
+        drawFastHLine(x0 - y, y0 - r, y + y + delta, color);
+      r--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    y++;
+    ddF_x += 2;
+    f += ddF_x;
+    if (corners & 0x1)
+      drawFastHLine(x0 - r, y0 + y, r + r + delta, color);
+    if (corners & 0x2)
+      drawFastHLine(x0 - r, y0 - y, r + r + delta, color);
+  }
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t rw, int32_t rh,
+                             int32_t r, uint16_t color) {
+  CallScope scope(stats);
+  int32_t maxR = (rw < rh ? rw : rh) / 2;
+  if (r > maxR)
+    r = maxR;
+  fillRect(x, y + r, rw, rh - r - r, color);
+  fillCircleHelper(x + r, y + rh - r - 1, r, 1, rw - r - r - 1, color);
+  fillCircleHelper(x + r, y + r, r, 2, rw - r - r - 1, color);
+}
+
+void TFT_eSPI::drawCircleHelper(int32_t x0, int32_t y0, int32_t r,
+                                uint8_t corners, uint16_t color) {
+  int32_t f = 1 - r;
+  int32_t ddF_x = 1;
+  int32_t ddF_y = -2 * r;
+  int32_t x = 0;
+  while (x < r) {
+    if (f >= 0) {
+      r--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    if (corners & 0x4) {
+      drawPixel(x0 + x, y0 + r, color);
+      drawPixel(x0 + r, y0 + x, color);
+    }
+    if (corners & 0x2) {
+      drawPixel(x0 + x, y0 - r, color);
+      drawPixel(x0 + r, y0 - x, color);
+    }
+    if (corners & 0x8) {
+      drawPixel(x0 - r, y0 + x, color);
+      drawPixel(x0 - x, y0 + r, color);
+    }
+    if (corners & 0x1) {
+      drawPixel(x0 - r, y0 - x, color);
+      drawPixel(x0 - x, y0 - r, color);
+    }
+  }
+}
+
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t rw, int32_t rh,
+                             int32_t r, uint16_t color) {
+  CallScope scope(stats);
+  drawFastHLine(x + r, y, rw - r - r, color);
+  drawFastHLine(x + r, y + rh - 1, rw - r - r, color);
+  drawFastVLine(x, y + r, rh - r - r, color);
+  drawFastVLine(x + rw - 1, y + r, rh - r - r, color);
+  drawCircleHelper(x + r, y + r, r, 1, color);
+  drawCircleHelper(x + rw - r - 1, y + r, r, 2, color);
+  drawCircleHelper(x + rw - r - 1, y + rh - r - 1, r, 4, color);
+  drawCircleHelper(x + r, y + rh - r - 1, r, 8, color);
+}
+
+void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint16_t color) {
+  CallScope scope(stats);
+  drawPixel(x0, y0 + r, color);
+  drawPixel(x0, y0 - r, color);
+  drawPixel(x0 + r, y0, color);
+  drawPixel(x0 - r, y0, color);
+  drawCircleHelper(x0, y0, r, 0xF, color);
+}
+
+void TFT_eSPI::fillCircle(int32_t x0, int32_t y0, int32_t r, uint16_t color) {
+  CallScope scope(stats);
+  int32_t x = 0;
+  int32_t dx = 1;
+  int32_t dy = r + r;
+  int32_t p = -(r >> 1);
+
+  drawFastHLine(x0 - r, y0, dy + 1, color);
+  while (x < r) {
+    if (p >= 0) {
+      drawFastHLine(x0 - x, y0 + r, 2 * x + 1, color);
+      drawFastHLine(x0 - x, y0 - r, 2 * x + 1, color);
+      dy -= 2;
+      p -= dy;
+      r--;
+    }
+    dx += 2;
+    p += dx;
+    x++;
+    drawFastHLine(x0 - r, y0 + x, 2 * r + 1, color);
+    drawFastHLine(x0 - r, y0 - x, 2 * r + 1, color);
+  }
+}
+
+// Bresenham, emitting one window per straight run like TFT_eSPI
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                        uint16_t color) {
+  CallScope scope(stats);
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+
+  int32_t dx = x1 - x0;
+  int32_t dy = abs(y1 - y0);
+  int32_t err = dx >> 1;
+  int32_t ystep = (y0 < y1) ? 1 : -1;
+  int32_t runStart = x0;
+
+  for (int32_t x = x0; x <= x1; x++) {
+    err -= dy;
+    if (err < 0 || x == x1) {
+      int32_t len = x - runStart + 1;
+      if (steep)
+        drawFastVLine(y0, runStart, len, color);
+      else
+        drawFastHLine(runStart, y0, len, color);
+      runStart = x + 1;
+      if (err < 0) {
+        y0 += ystep;
+        err += dx;
+      }
+    }
+  }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t iw, int32_t ih,
+                         const uint16_t *data) {
+  CallScope scope(stats);
+  uint64_t pixels = 0;
+  for (int32_t j = 0; j < ih; j++) {
+    for (int32_t i = 0; i < iw; i++) {
+      uint16_t v = data[j * iw + i];
+      // Without swapBytes the buffer must already be big-endian
+      uint16_t c = swapBytes ? v : (uint16_t)((v >> 8) | (v << 8));
+      if (x + i >= 0 && x + i < w && y + j >= 0 && y + j < h) {
+        plot(x + i, y + j, c);
+        pixels++;
+      }
+    }
+  }
+  chargeWindow(pixels);
+}
+
+void TFT_eSPI::pushImageDMA(int32_t x, int32_t y, int32_t iw, int32_t ih,
+                            uint16_t *data, uint16_t *) {
+  CallScope scope(stats);
+  // A new DMA transfer waits for the previous one to finish
+  dmaWait();
+  uint64_t pixels = 0;
+  for (int32_t j = 0; j < ih; j++) {
+    for (int32_t i = 0; i < iw; i++) {
+      uint16_t v = data[j * iw + i];
+      uint16_t c = swapBytes ? v : (uint16_t)((v >> 8) | (v << 8));
+      if (x + i >= 0 && x + i < w && y + j >= 0 && y + j < h) {
+        plot(x + i, y + j, c);
+        pixels++;
+      }
+    }
+  }
+  stats.windows++;
+  stats.pixelBytes += pixels * 2;
+  chargeBytes(TFT_WINDOW_BYTES, false); // Window setup is done by the CPU
+  chargeBytes(pixels * 2, true);
+}
+
+// ===== Text (GLCD font 1) =====
+
+int16_t TFT_eSPI::drawChar(uint16_t c, int32_t x, int32_t y) {
+  CallScope scope(stats);
+  if (c < 0x20 || c > 0x7E)
+    c = '?';
+  const uint8_t *glyph = GLCD_FONT[c - 0x20];
+  bool fillBg = textFg != textBg;
+  int32_t s = textSize;
+
+  if (s == 1 && fillBg) {
+    // Single window with all 6x8 pixels
+    for (int32_t i = 0; i < 6; i++) {
+      uint8_t line = i < 5 ? glyph[i] : 0;
+      for (int32_t j = 0; j < 8; j++)
+        plot(x + i, y + j, (line >> j) & 1 ? textFg : textBg);
+    }
+    chargeWindow(48);
+    return 6;
+  }
+
+  // Scaled or transparent: one rect per font pixel
+  for (int32_t i = 0; i < 6; i++) {
+    uint8_t line = i < 5 ? glyph[i] : 0;
+    for (int32_t j = 0; j < 8; j++) {
+      if ((line >> j) & 1) {
+        if (s == 1)
+          drawPixel(x + i, y + j, textFg);
+        else
+          fillRect(x + i * s, y + j * s, s, s, textFg);
+      } else if (fillBg) {
+        fillRect(x + i * s, y + j * s, s, s, textBg);
+      }
+    }
+  }
+  return (int16_t)(6 * s);
+}
+
+int16_t TFT_eSPI::drawString(const String &str, int32_t x, int32_t y) {
+  CallScope scope(stats);
+  int32_t tw = textWidth(str);
+  int32_t th = fontHeight();
+  switch (datum) {
+  case TC_DATUM: x -= tw / 2; break;
+  case TR_DATUM: x -= tw; break;
+  case ML_DATUM: y -= th / 2; break;
+  case MC_DATUM: x -= tw / 2; y -= th / 2; break;
+  case MR_DATUM: x -= tw; y -= th / 2; break;
+  case BL_DATUM: y -= th; break;
+  case BC_DATUM: x -= tw / 2; y -= th; break;
+  case BR_DATUM: x -= tw; y -= th; break;
+  default: break;
+  }
+  for (unsigned int i = 0; i < str.length(); i++)
+    x += drawChar((uint8_t)str[i], x, y);
+  return (int16_t)tw;
+}
+
+// ===== PNG output =====
+// Uncompressed (stored) deflate keeps this free of zlib.
+
+static uint32_t crcTable[256];
+
+static uint32_t crc32(const uint8_t *data, size_t len, uint32_t crc = 0) {
+  if (crcTable[1] == 0) {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++)
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      crcTable[n] = c;
+    }
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++)
+    crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+static void putBE32(std::vector<uint8_t> &out, uint32_t v) {
+  out.push_back(v >> 24);
+  out.push_back(v >> 16);
+  out.push_back(v >> 8);
+  out.push_back(v);
+}
+
+static void writeChunk(FILE *f, const char *type,
+                       const std::vector<uint8_t> &data) {
+  std::vector<uint8_t> buf;
+  putBE32(buf, (uint32_t)data.size());
+  buf.insert(buf.end(), type, type + 4);
+  buf.insert(buf.end(), data.begin(), data.end());
+  uint32_t crc = crc32(buf.data() + 4, buf.size() - 4);
+  putBE32(buf, crc);
+  fwrite(buf.data(), 1, buf.size(), f);
+}
+
+bool TFT_eSPI::writePNG(const char *path) const {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  static const uint8_t sig[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  fwrite(sig, 1, 8, f);
+
+  std::vector<uint8_t> ihdr;
+  putBE32(ihdr, w);
+  putBE32(ihdr, h);
+  ihdr.push_back(8); // Bit depth
+  ihdr.push_back(2); // RGB
+  ihdr.push_back(0);
+  ihdr.push_back(0);
+  ihdr.push_back(0);
+  writeChunk(f, "IHDR", ihdr);
+
+  // Raw scanlines: filter byte + RGB888
+  std::vector<uint8_t> raw;
+  raw.reserve((size_t)h * (w * 3 + 1));
+  for (int32_t y = 0; y < h; y++) {
+    raw.push_back(0);
+    for (int32_t x = 0; x < w; x++) {
+      uint16_t c = fb[y * w + x];
+      uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+      raw.push_back((r << 3) | (r >> 2));
+      raw.push_back((g << 2) | (g >> 4));
+      raw.push_back((b << 3) | (b >> 2));
+    }
+  }
+
+  std::vector<uint8_t> z = {0x78, 0x01};
+  uint32_t a = 1, b = 0;
+  for (uint8_t v : raw) {
+    a = (a + v) % 65521;
+    b = (b + a) % 65521;
+  }
+  for (size_t pos = 0; pos < raw.size(); pos += 65535) {
+    size_t len = raw.size() - pos < 65535 ? raw.size() - pos : 65535;
+    z.push_back(pos + len == raw.size() ? 1 : 0);
+    z.push_back(len & 0xFF);
+    z.push_back(len >> 8);
+    z.push_back(~len & 0xFF);
+    z.push_back((~len >> 8) & 0xFF);
+    z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+  }
+  putBE32(z, (b << 16) | a);
+  writeChunk(f, "IDAT", z);
+  writeChunk(f, "IEND", std::vector<uint8_t>());
+  return fclose(f) == 0;
+}
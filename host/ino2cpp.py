@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Turn an Arduino .ino sketch into a .cpp the host compiler accepts.
+
+The Arduino builder adds a prototype for every top-level function so a
+sketch can call functions defined further down. This does the same with a
+small brace-depth scanner: prototypes are inserted just before the first
+function definition and a #line directive keeps compiler errors pointing at
+the original .ino.
+
+Usage: ino2cpp.py sketch.ino out.cpp
+"""
+
+import re
+import sys
+
+
+def strip_comments_and_strings(src):
+    """Blank out comments and literals, keeping offsets and newlines."""
+    out = list(src)
+    i, n = 0, len(src)
+    while i < n:
+        c = src[i]
+        if src.startswith("//", i):
+            while i < n and src[i] != "\n":
+                out[i] = " "
+                i += 1
+        elif src.startswith("/*", i):
+            while i < n and not src.startswith("*/", i):
+                if src[i] != "\n":
+                    out[i] = " "
+                i += 1
+            if i < n:
+                out[i] = out[i + 1] = " "
+                i += 2
+        elif c in "\"'":
+            i += 1
+            while i < n and src[i] != c:
+                if src[i] == "\\":
+                    out[i] = " "
+                    i += 1
+                out[i] = " "
+                i += 1
+            i += 1
+        else:
+            i += 1
+    return "".join(out)
+
+
+SKIP_WORDS = re.compile(r"\b(struct|class|union|enum|namespace|typedef)\b|=")
+
+
+def find_functions(src):
+    """Return (prototype, start offset) for each top-level definition."""
+    clean = strip_comments_and_strings(src)
+    protos = []
+    depth = 0
+    seg_start = 0
+    i = 0
+    while i < len(clean):
+        c = clean[i]
+        if depth == 0 and c == "#" and (i == 0 or clean[i - 1] == "\n"):
+            # Preprocessor line (with continuations) ends the segment
+            while i < len(clean) and not (
+                clean[i] == "\n" and clean[i - 1] != "\\"
+            ):
+                i += 1
+            seg_start = i + 1
+        elif c == "{":
+            if depth == 0:
+                head = clean[seg_start:i].strip()
+                if head.endswith(")") and not SKIP_WORDS.search(
+                    head.split("(")[0]
+                ):
+                    sig = " ".join(head.split())
+                    protos.append((sig + ";", seg_start))
+            depth += 1
+        elif c == "}":
+            depth -= 1
+            if depth == 0:
+                seg_start = i + 1
+        elif c == ";" and depth == 0:
+            seg_start = i + 1
+        i += 1
+    return protos
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    path, out_path = sys.argv[1], sys.argv[2]
+    src = open(path).read()
+    protos = find_functions(src)
+
+    if protos:
+        insert_at = protos[0][1]
+        # Keep the insertion on a line boundary
+        while insert_at > 0 and src[insert_at - 1] != "\n":
+            insert_at -= 1
+    else:
+        insert_at = len(src)
+    line = src.count("\n", 0, insert_at) + 1
+
+    seen = set()
+    proto_lines = []
+    for sig, _ in protos:
+        if sig not in seen:
+            seen.add(sig)
+            proto_lines.append(sig)
+
+    with open(out_path, "w") as out:
+        out.write('#include "Arduino.h"\n')
+        out.write('#line 1 "%s"\n' % path)
+        out.write(src[:insert_at])
+        out.write("\n".join(proto_lines) + "\n")
+        out.write('#line %d "%s"\n' % (line, path))
+        out.write(src[insert_at:])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,335 @@
+// ============================================================================
+// LOST-FRAME RECOVERY SIMULATOR
+// ============================================================================
+// Pairs an oil and a fuel LinkSender with a LinkReceiver over an in-memory
+// radio that drops data frames to a loss pattern, then checks what the
+// receiver rebuilds from the history each packet carries. Every recovered
+// reading is compared against the value the sender actually sampled for the
+// lost frame, and the receiver's framesMissed count against the frames the
+// radio dropped.
+//
+// Exits 1 if a recovered value is wrong, a lost frame goes uncounted, or a
+// pattern whose bursts fit in PACKET_HISTORY_DEPTH leaves anything
+// unrecovered.
+//
+// Usage: loss_sim [frames]
+
+#include <packet_link.h>
+
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#define OIL_INTERVAL_MS 500
+#define FUEL_INTERVAL_MS 1000
+#define TICK_MS 50
+#define DRAIN_MS 2000 // Lossless run-out so no loss is left pending at the end
+
+static const uint8_t OIL_MAC[6] = {0x02, 0, 0, 0, 0, 0x01};
+static const uint8_t FUEL_MAC[6] = {0x02, 0, 0, 0, 0, 0x02};
+static const uint8_t DISPLAY_MAC[6] = {0x02, 0, 0, 0, 0, 0x10};
+
+// ===== LOSS PATTERNS =====
+typedef struct {
+  const char *name;
+  bool (*drop)(uint32_t index); // Drop the index'th data frame of a sender
+  int maxBurst;                 // Longest run of drops, 0 = unbounded
+} LossPattern;
+
+static std::mt19937 rng(4242);
+
+static bool dropNone(uint32_t) { return false; }
+static bool dropRandom5(uint32_t) { return rng() % 100 < 5; }
+static bool dropRandom20(uint32_t) { return rng() % 100 < 20; }
+static bool dropBurst2(uint32_t i) { return i % 10 >= 8; }
+static bool dropBurst3(uint32_t i) { return i % 10 >= 7; }
+static bool dropEveryThird(uint32_t i) { return i % 3 == 2; }
+
+static const LossPattern PATTERNS[] = {
+    {"none", dropNone, 0},
+    {"random 5%", dropRandom5, 0},
+    {"random 20%", dropRandom20, 0},
+    {"burst 2/10", dropBurst2, 2},
+    {"burst 3/10", dropBurst3, 3},
+    {"every 3rd", dropEveryThird, 1},
+};
+
+// ===== RADIO =====
+// Frames queue up and are delivered between node steps; simSend() records
+// the node that is currently running as the source.
+typedef struct {
+  uint8_t from[6];
+  uint8_t to[6];
+  std::vector<uint8_t> data;
+} Frame;
+
+static std::vector<Frame> air;
+static const uint8_t *currentMac;
+static bool lossy; // False while draining
+
+static bool simSend(const uint8_t *mac, const uint8_t *data, size_t len) {
+  Frame f;
+  memcpy(f.from, currentMac, 6);
+  memcpy(f.to, mac, 6);
+  f.data.assign(data, data + len);
+  air.push_back(f);
+  return true;
+}
+
+static bool simPeer(const uint8_t *, bool) { return true; }
+
+static const LinkTransport SIM_RADIO = {simSend, simPeer};
+
+// ===== ONE RUN =====
+typedef struct {
+  uint32_t sent;      // Data frames sent after the receiver first heard us
+  uint32_t lost;      // Dropped by the radio
+  uint32_t recovered; // Rebuilt from history, value checked
+  uint32_t mismatched;
+} SenderStats;
+
+typedef struct {
+  LinkSender link;
+  const uint8_t *mac;
+  uint32_t index; // Data frames sent, drives the loss pattern
+  bool heard;     // Receiver has a sequence to count gaps from
+  SenderStats stats;
+  bool built;
+  uint32_t lastSampleMs;
+} SimSender;
+
+// What each sender sampled, by sequence number, for checking recoveries
+static std::vector<int16_t> oilTempDeci, oilPressDeci;
+static std::vector<uint8_t> fuelPercent;
+
+static float oilTempAt(uint32_t seq) {
+  return 95.0f + 20.0f * sinf(seq * 0.05f);
+}
+static float oilPressAt(uint32_t seq) {
+  return 40.0f + 15.0f * sinf(seq * 0.3f);
+}
+static uint8_t fuelAt(uint32_t seq) { return (uint8_t)(90 - (seq / 40) % 80); }
+
+static void checkOil(SimSender &tx, const uint8_t *data, size_t len,
+                     uint8_t missed) {
+  TempDataPacketView oil(data, len);
+  const uint16_t seq = oil.sequenceNumber();
+  for (int k = 1; k <= missed && k <= PACKET_HISTORY_DEPTH; k++) {
+    const uint16_t age = k == 1 ? oil.prev1AgeMs() : oil.prev2AgeMs();
+    const int16_t temp = k == 1 ? oil.prev1OilTemp() : oil.prev2OilTemp();
+    const uint16_t press =
+        k == 1 ? oil.prev1OilPressure() : oil.prev2OilPressure();
+    if (age != k * OIL_INTERVAL_MS || temp != oilTempDeci[seq - k] ||
+        press != (uint16_t)oilPressDeci[seq - k]) {
+      printf("  oil seq %u history %d: age %u temp %d press %u, expected "
+             "%d %d %d\n",
+             seq, k, age, temp, press, k * OIL_INTERVAL_MS,
+             oilTempDeci[seq - k], oilPressDeci[seq - k]);
+      tx.stats.mismatched++;
+    } else {
+      tx.stats.recovered++;
+    }
+  }
+}
+
+static void checkFuel(SimSender &tx, const uint8_t *data, size_t len,
+                      uint8_t missed) {
+  FuelDataPacketView fuel(data, len);
+  const uint16_t seq = fuel.sequence_number();
+  for (int k = 1; k <= missed && k <= PACKET_HISTORY_DEPTH; k++) {
+    const uint16_t age = k == 1 ? fuel.prev1AgeMs() : fuel.prev2AgeMs();
+    const uint8_t percent =
+        k == 1 ? fuel.prev1Percent() : fuel.prev2Percent();
+    if (age != k * FUEL_INTERVAL_MS || percent != fuelPercent[seq - k]) {
+      printf("  fuel seq %u history %d: age %u level %u, expected %d %u\n",
+             seq, k, age, percent, k * FUEL_INTERVAL_MS,
+             fuelPercent[seq - k]);
+      tx.stats.mismatched++;
+    } else {
+      tx.stats.recovered++;
+    }
+  }
+}
+
+// Deliver everything on the air, including frames sent while handling it
+static void deliver(SimSender *senders, int senderCount, LinkReceiver &rx,
+                    const LossPattern &pattern) {
+  for (size_t f = 0; f < air.size(); f++) {
+    const Frame frame = air[f];
+    const uint8_t *data = frame.data.data();
+    const size_t len = frame.data.size();
+
+    for (int i = 0; i < senderCount; i++) {
+      SimSender &tx = senders[i];
+      if (memcmp(frame.from, tx.mac, 6) == 0)
+        continue;
+      currentMac = tx.mac;
+      tx.link.receive(frame.from, data, len);
+    }
+    if (memcmp(frame.from, DISPLAY_MAC, 6) == 0)
+      continue;
+
+    // Data frames go through the loss pattern once the receiver has one
+    // to count from; before that a loss can't be seen
+    SimSender *tx = NULL;
+    for (int i = 0; i < senderCount; i++) {
+      if (memcmp(frame.from, senders[i].mac, 6) == 0)
+        tx = &senders[i];
+    }
+    uint8_t flags = 0, eventSeq;
+    uint16_t seq;
+    if (tx && packetLinkFields(data, len, &flags, &eventSeq, &seq) &&
+        !(flags & LINK_FLAG_REPEAT) && tx->heard) {
+      const uint32_t index = tx->index++;
+      tx->stats.sent++;
+      if (lossy && pattern.drop(index)) {
+        tx->stats.lost++;
+        continue;
+      }
+    }
+
+    currentMac = DISPLAY_MAC;
+    uint8_t missed = 0;
+    if (rx.receive(frame.from, data, len, &missed) != LINK_RX_DATA || !tx)
+      continue;
+    tx->heard = true;
+    if (packetType(data, len) == MSG_TYPE_OIL)
+      checkOil(*tx, data, len, missed);
+    else
+      checkFuel(*tx, data, len, missed);
+  }
+  air.clear();
+}
+
+static TempDataPacket oilPacket(SimSender &tx, const TempDataPacket &prev,
+                                uint16_t seq, uint32_t nowMs) {
+  TempDataPacket pkt = {};
+  pkt.timestamp = nowMs;
+  pkt.oilTemperature = oilTempAt(seq);
+  pkt.oilPressure = oilPressAt(seq);
+  pkt.sensorsStatus = 0x05;
+  pkt.sequenceNumber = seq;
+  if (tx.built)
+    packetCarryHistory(&pkt, prev, nowMs - tx.lastSampleMs);
+  oilTempDeci.push_back(packetDeci(pkt.oilTemperature));
+  oilPressDeci.push_back((int16_t)packetDeciUnsigned(pkt.oilPressure));
+  return pkt;
+}
+
+static FuelDataPacket fuelPacket(SimSender &tx, const FuelDataPacket &prev,
+                                 uint16_t seq, uint32_t nowMs) {
+  FuelDataPacket pkt = {};
+  pkt.timestamp = nowMs;
+  pkt.fuel_percent = fuelAt(seq);
+  pkt.sequence_number = seq;
+  if (tx.built)
+    packetCarryHistory(&pkt, prev, nowMs - tx.lastSampleMs);
+  fuelPercent.push_back(pkt.fuel_percent);
+  return pkt;
+}
+
+// Runs one pattern until the oil sender has sent frames data frames.
+// Returns false if the pattern failed.
+static bool runPattern(const LossPattern &pattern, uint32_t frames) {
+  SimSender senders[2];
+  senders[0].mac = OIL_MAC;
+  senders[1].mac = FUEL_MAC;
+  LinkReceiver rx;
+  air.clear();
+  oilTempDeci.clear();
+  oilPressDeci.clear();
+  fuelPercent.clear();
+
+  for (int i = 0; i < 2; i++) {
+    SimSender &tx = senders[i];
+    tx.index = 0;
+    tx.heard = false;
+    tx.built = false;
+    tx.lastSampleMs = 0;
+    memset(&tx.stats, 0, sizeof(tx.stats));
+    currentMac = tx.mac;
+    tx.link.begin(&SIM_RADIO, 1, i == 0 ? MSG_TYPE_OIL : MSG_TYPE_FUEL);
+  }
+  currentMac = DISPLAY_MAC;
+  rx.begin(&SIM_RADIO, 1, LINK_ROLE_DISPLAY);
+
+  TempDataPacket oil = {};
+  FuelDataPacket fuel = {};
+  uint16_t oilSeq = 0, fuelSeq = 0;
+  uint32_t endMs = 0;
+  lossy = true;
+  for (uint32_t nowMs = 0; lossy || nowMs < endMs; nowMs += TICK_MS) {
+    if (lossy && senders[0].index >= frames) {
+      lossy = false;
+      endMs = nowMs + DRAIN_MS;
+    }
+    currentMac = DISPLAY_MAC;
+    rx.poll(nowMs);
+    for (int i = 0; i < 2; i++) {
+      currentMac = senders[i].mac;
+      senders[i].link.poll(nowMs);
+    }
+    deliver(senders, 2, rx, pattern);
+
+    // Senders sample and send on their own schedules, history from the
+    // packet before
+    if (nowMs % OIL_INTERVAL_MS == 0) {
+      SimSender &tx = senders[0];
+      oil = oilPacket(tx, oil, oilSeq++, nowMs);
+      tx.built = true;
+      tx.lastSampleMs = nowMs;
+      currentMac = tx.mac;
+      tx.link.seal(&oil, false);
+      tx.link.send(&oil);
+    }
+    if (nowMs % FUEL_INTERVAL_MS == 0) {
+      SimSender &tx = senders[1];
+      fuel = fuelPacket(tx, fuel, fuelSeq++, nowMs);
+      tx.built = true;
+      tx.lastSampleMs = nowMs;
+      currentMac = tx.mac;
+      tx.link.seal(&fuel, false);
+      tx.link.send(&fuel);
+    }
+    deliver(senders, 2, rx, pattern);
+  }
+
+  bool ok = true;
+  uint32_t lost = 0;
+  static const char *const NAMES[] = {"oil", "fuel"};
+  for (int i = 0; i < 2; i++) {
+    const SenderStats &s = senders[i].stats;
+    const uint32_t unrecovered = s.lost - s.recovered - s.mismatched;
+    lost += s.lost;
+    printf("%-12s %-5s %6u %6u %9u %11u %8.1f%%\n", pattern.name, NAMES[i],
+           s.sent, s.lost, s.recovered, unrecovered,
+           s.lost ? 100.0 * s.recovered / s.lost : 100.0);
+    if (s.mismatched > 0)
+      ok = false;
+    if (pattern.maxBurst > 0 && pattern.maxBurst <= PACKET_HISTORY_DEPTH &&
+        unrecovered > 0)
+      ok = false;
+  }
+  if (rx.linkStats().framesMissed != lost) {
+    printf("  receiver counted %u missed frames, radio dropped %u\n",
+           rx.linkStats().framesMissed, lost);
+    ok = false;
+  }
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  const uint32_t frames = argc > 1 ? (uint32_t)atol(argv[1]) : 2000;
+
+  printf("pattern      type    sent   lost recovered unrecovered  rate\n");
+  bool ok = true;
+  for (size_t p = 0; p < sizeof(PATTERNS) / sizeof(PATTERNS[0]); p++) {
+    if (!runPattern(PATTERNS[p], frames)) {
+      printf("  %s: FAILED\n", PATTERNS[p].name);
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,412 @@
+// ============================================================================
+// ESP-NOW SOAK TEST
+// ============================================================================
+// Runs the real CYD, oil sender and fuel sender sketches together over the
+// modelled radio medium (radio_medium.h) for a stretch of virtual time, then
+// reports per-link delivery and latency, per-node goodput and how busy the
+// channel was. Flood nodes add background broadcast traffic to push the
+// channel towards saturation.
+//
+// With --scenario the senders' thermocouple, pressure ADC and fuel ADC are
+// driven by the vehicle simulator (vehicle_sim.h) instead of fixed values,
+// and every reading the display receives is compared with the simulator's
+// ground truth at the reading's sample time. The display also gets the
+// model's road speed as the laptop's GPS line, once a second.
+//
+// --uplink FILE saves the display's serial output as the laptop would read
+// it, log text and telemetry frames together, for the recorder
+// (laptop/telemetry) to ingest.
+//
+// The node shared objects are looked for in nodes/ next to this executable.
+// Exits 1 if either sender never got a frame through to the display. With
+// no loss and no flood traffic it also exits 1 if the display's [BOOT] lines
+// put its first oil or fuel reading on screen later than
+// FIRST_READING_MAX_MS after it booted; on a lossy channel a lost first
+// frame waits for the sender's next one.
+//
+// Usage: espnow_soak [--seconds N] [--loss P] [--burst N] [--latency-us N]
+//                    [--jitter-us N] [--dup P] [--rate-kbps N] [--retries N]
+//                    [--queue N] [--flood N] [--flood-hz N] [--flood-bytes N]
+//                    [--seed N] [--serial] [--scenario FILE] [--sim-ms N]
+//                    [--uplink FILE]
+
+#include "radio_medium.h"
+#include "vehicle_sim.h"
+
+#include <vehicle_packets.h>
+
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const uint8_t CYD_MAC[6] = {0x08, 0xD1, 0xF9, 0x2A, 0x08, 0xBC};
+static const uint8_t OIL_MAC[6] = {0x98, 0xA3, 0x16, 0x8E, 0x6A, 0xE4};
+static const uint8_t FUEL_MAC[6] = {0x98, 0xA3, 0x16, 0x8E, 0x6A, 0xE5};
+
+#define ADS1115_ADDR 0x48
+#define OLED_ADDR 0x3C
+#define OIL_TEMP_C 95.0f
+#define OIL_PRESSURE_VOLTS 1.5f // Mid-scale on the pressure sender
+#define FUEL_ADC_RAW 2048       // Half a tank
+
+// Boots are staggered as they would be on a real ignition
+#define OIL_BOOT_US 150000
+#define FUEL_BOOT_US 230000
+
+// Senders boot within a quarter second and send as soon as they pair
+#define FIRST_READING_MAX_MS 400
+
+#define SIM_REPORT_MS 60000
+#define SIM_GPS_MS 1000
+
+static int fuelAdc(uint8_t) { return FUEL_ADC_RAW; }
+
+// Sensor reads while a scenario runs; each draws fresh noise
+static VehicleSim *sim = nullptr;
+static int simFuelAdc(uint8_t) { return sim->fuelAdcRaw(); }
+
+// Every pressure conversion the oil sender starts, to see how evenly its
+// reads are spaced while the OLED shares the bus
+static const NodeApi *oilApi = nullptr;
+static uint64_t adsLastUs = 0, adsGapSumUs = 0, adsGapMaxUs = 0;
+static uint32_t adsGaps = 0;
+static float oilAdsVolts(uint8_t channel) {
+  const uint64_t now = oilApi->micros();
+  if (channel == 0 && adsLastUs) {
+    const uint64_t gap = now - adsLastUs;
+    adsGapSumUs += gap;
+    adsGapMaxUs = std::max(adsGapMaxUs, gap);
+    adsGaps++;
+  }
+  if (channel == 0)
+    adsLastUs = now;
+  return sim ? sim->adsVolts(channel) : OIL_PRESSURE_VOLTS;
+}
+
+// Received value against ground truth
+typedef struct {
+  uint32_t reads;
+  uint32_t faulted; // Flagged by the sender, not compared
+  double errorSum;
+  double absSum;
+  double absMax;
+} Accuracy;
+
+static void account(Accuracy *a, double reported, double truth) {
+  const double e = reported - truth;
+  a->reads++;
+  a->errorSum += e;
+  a->absSum += fabs(e);
+  if (fabs(e) > a->absMax)
+    a->absMax = fabs(e);
+}
+
+static void printAccuracy(const char *name, const Accuracy &a) {
+  printf("%-14s %6u %7u %8.2f %8.2f %8.2f\n", name, a.reads, a.faulted,
+         a.reads ? a.errorSum / a.reads : 0.0,
+         a.reads ? a.absSum / a.reads : 0.0, a.absMax);
+}
+
+// How far a packet's current value, and its window minimum, sit above the
+// lowest true value since the sender's previous packet
+typedef struct {
+  uint32_t windows;
+  double valueMiss;
+  double windowMiss;
+} WindowCheck;
+
+static std::string exeDir(const char *argv0) {
+  char path[4096];
+  ssize_t n = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  std::string p = n > 0 ? std::string(path, n) : std::string(argv0);
+  size_t slash = p.rfind('/');
+  return slash == std::string::npos ? "." : p.substr(0, slash);
+}
+
+int main(int argc, char **argv) {
+  MediumConfig cfg;
+  double seconds = 60;
+  int floods = 0;
+  double floodHz = 100;
+  int floodBytes = 200;
+  bool serial = false;
+  const char *scenario = nullptr;
+  uint32_t simMs = 10;
+  bool secondsSet = false;
+  const char *uplinkPath = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (a == "--seconds" && hasValue)
+      seconds = atof(argv[++i]), secondsSet = true;
+    else if (a == "--loss" && hasValue)
+      cfg.loss = atof(argv[++i]);
+    else if (a == "--burst" && hasValue)
+      cfg.burst = atof(argv[++i]);
+    else if (a == "--latency-us" && hasValue)
+      cfg.latencyUs = (uint32_t)atol(argv[++i]);
+    else if (a == "--jitter-us" && hasValue)
+      cfg.jitterUs = (uint32_t)atol(argv[++i]);
+    else if (a == "--dup" && hasValue)
+      cfg.duplicate = atof(argv[++i]);
+    else if (a == "--rate-kbps" && hasValue)
+      cfg.rateKbps = (uint32_t)atol(argv[++i]);
+    else if (a == "--retries" && hasValue)
+      cfg.retries = atoi(argv[++i]);
+    else if (a == "--queue" && hasValue)
+      cfg.txQueue = atoi(argv[++i]);
+    else if (a == "--flood" && hasValue)
+      floods = atoi(argv[++i]);
+    else if (a == "--flood-hz" && hasValue)
+      floodHz = atof(argv[++i]);
+    else if (a == "--flood-bytes" && hasValue)
+      floodBytes = atoi(argv[++i]);
+    else if (a == "--seed" && hasValue)
+      cfg.seed = strtoull(argv[++i], nullptr, 10);
+    else if (a == "--serial")
+      serial = true;
+    else if (a == "--scenario" && hasValue)
+      scenario = argv[++i];
+    else if (a == "--sim-ms" && hasValue)
+      simMs = (uint32_t)atol(argv[++i]);
+    else if (a == "--uplink" && hasValue)
+      uplinkPath = argv[++i];
+    else {
+      fprintf(stderr,
+              "usage: %s [--seconds N] [--loss P] [--burst N] "
+              "[--latency-us N] [--jitter-us N] [--dup P] [--rate-kbps N] "
+              "[--retries N] [--queue N] [--flood N] [--flood-hz N] "
+              "[--flood-bytes N] [--seed N] [--serial] [--scenario FILE] "
+              "[--sim-ms N] [--uplink FILE]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (cfg.rateKbps == 0)
+    cfg.rateKbps = 1;
+  if (simMs == 0)
+    simMs = 1;
+
+  VehicleSim vehicle(cfg.seed);
+  if (scenario) {
+    if (!vehicle.loadScenario(scenario)) {
+      fprintf(stderr, "cannot read %s\n", scenario);
+      return 2;
+    }
+    if (!secondsSet && vehicle.endMs())
+      seconds = vehicle.endMs() / 1000.0;
+    sim = &vehicle;
+  }
+
+  RadioMedium medium(cfg);
+  const std::string dir = exeDir(argv[0]) + "/nodes/";
+  const int cyd = medium.addNode("cyd", dir + "cyd.so", CYD_MAC);
+  const int oil = medium.addNode("oil", dir + "oil.so", OIL_MAC, OIL_BOOT_US);
+  const int fuel =
+      medium.addNode("fuel", dir + "fuel.so", FUEL_MAC, FUEL_BOOT_US);
+  if (cyd < 0 || oil < 0 || fuel < 0)
+    return 2;
+  for (int i = 0; i < floods; i++) {
+    const uint8_t mac[6] = {0x02, 0xF1, 0x00, 0x00, 0x00, (uint8_t)i};
+    medium.addFlood("flood" + std::to_string(i), mac, floodHz,
+                    (size_t)floodBytes);
+  }
+
+  medium.api(oil)->addI2cDevice(ADS1115_ADDR);
+  medium.api(oil)->addI2cDevice(OLED_ADDR);
+  medium.api(oil)->setThermocouple(OIL_TEMP_C, 25.0f, 0);
+  oilApi = medium.api(oil);
+  oilApi->setAdcReadHook(oilAdsVolts);
+  medium.api(fuel)->setAnalogReadHook(sim ? simFuelAdc : fuelAdc);
+
+  // Truth per simulator step, and the readings the display received
+  std::vector<VehicleTruth> history;
+  Accuracy oilTempAcc = {}, oilPressAcc = {}, fuelAcc = {};
+  int oilSeq = -1, fuelSeq = -1;
+  WindowCheck pressWindow = {};
+  uint32_t lastOilMs = 0;
+  auto truthAt = [&](uint32_t ms) -> const VehicleTruth & {
+    size_t i = ms / simMs;
+    return history[i < history.size() ? i : history.size() - 1];
+  };
+  medium.onDeliver([&](int from, int to, uint64_t, const uint8_t *data,
+                       size_t len) {
+    if (!sim || to != cyd || history.empty())
+      return;
+    TempDataPacketView oilPkt(data, len);
+    FuelDataPacketView fuelPkt(data, len);
+    if (from == oil && oilPkt.valid() && oilPkt.sequenceNumber() != oilSeq) {
+      oilSeq = oilPkt.sequenceNumber(); // Duplicates count once
+      const VehicleTruth &t = truthAt(oilPkt.timestamp());
+      if (oilPkt.oilFaultStatus() || isnan(oilPkt.oilTemperature()))
+        oilTempAcc.faulted++;
+      else
+        account(&oilTempAcc, oilPkt.oilTemperature(), t.oilTempC);
+      account(&oilPressAcc, oilPkt.oilPressure(), t.oilPressurePsi);
+      if (oilPkt.oilPressSamples() > 0 && lastOilMs > 0) {
+        double lowest = t.oilPressurePsi;
+        for (uint32_t ms = lastOilMs; ms < oilPkt.timestamp(); ms += simMs)
+          lowest = fmin(lowest, truthAt(ms).oilPressurePsi);
+        pressWindow.windows++;
+        pressWindow.valueMiss += oilPkt.oilPressure() - lowest;
+        pressWindow.windowMiss += oilPkt.oilPressMin() / 10.0 - lowest;
+      }
+      lastOilMs = oilPkt.timestamp();
+    } else if (from == fuel && fuelPkt.valid() &&
+               fuelPkt.sequence_number() != fuelSeq) {
+      fuelSeq = fuelPkt.sequence_number();
+      if (fuelPkt.fault_status())
+        fuelAcc.faulted++;
+      else
+        account(&fuelAcc, fuelPkt.fuel_percent(),
+                truthAt(fuelPkt.timestamp()).fuelPercent);
+    }
+  });
+
+  // The display's telemetry frames, and its raw serial output if asked for
+  FILE *uplink = nullptr;
+  if (uplinkPath && !(uplink = fopen(uplinkPath, "wb"))) {
+    fprintf(stderr, "cannot write %s\n", uplinkPath);
+    return 2;
+  }
+  uint32_t uplinkFrames = 0, uplinkBad = 0;
+  medium.onSerialFrame([&](int node, uint64_t, const uint8_t *data,
+                           size_t len) {
+    if (node != cyd)
+      return;
+    if (TelemetryPacketView(data, len).valid())
+      uplinkFrames++;
+    else
+      uplinkBad++;
+  });
+  medium.onSerialOutput([&](int node, uint64_t, const uint8_t *buf,
+                            size_t len) {
+    if (node == cyd && uplink)
+      fwrite(buf, 1, len, uplink);
+  });
+
+  // Without --serial only every node's boot timings and alarms, and the
+  // display's periodic link and latency reports are shown
+  std::map<std::string, unsigned long> firstOnScreenMs; // By channel label
+  medium.onSerialLine([&](int node, uint64_t us, const std::string &line) {
+    static const std::string first = "[BOOT] first ";
+    static const std::string onScreen = " on screen at ";
+    const size_t at = line.find(onScreen);
+    if (node == cyd && line.compare(0, first.size(), first) == 0 &&
+        at != std::string::npos)
+      firstOnScreenMs[line.substr(first.size(), at - first.size())] =
+          strtoul(line.c_str() + at + onScreen.size(), nullptr, 10);
+    const bool always = line.compare(0, 5, "Boot:") == 0 ||
+                      line.compare(0, 6, "[BOOT]") == 0 ||
+                      line.compare(0, 6, "Alarm:") == 0 ||
+                      line.compare(0, 7, "[ALARM]") == 0;
+    if (!serial && !always &&
+        (node != cyd || (line.find("[PERF]") == std::string::npos &&
+                         line.find("[LINK] senders") == std::string::npos &&
+                         line.find("samples recovered") == std::string::npos)))
+      return;
+    printf("%9.3f %-5s %s\n", us / 1e6, medium.name(node).c_str(),
+           line.c_str());
+  });
+
+  const uint64_t endUs = (uint64_t)(seconds * 1e6);
+  if (!sim) {
+    medium.run(endUs);
+  } else {
+    // Step the car, then let the nodes catch up to it
+    for (uint64_t us = 0; us <= endUs; us += simMs * 1000ULL) {
+      vehicle.step(us);
+      const VehicleTruth &t = vehicle.truth();
+      history.push_back(t);
+      medium.api(oil)->setThermocouple(vehicle.thermocoupleC(),
+                                       vehicle.coldJunctionC(),
+                                       vehicle.thermocoupleFault());
+      if (us % (SIM_GPS_MS * 1000ULL) == 0) {
+        char gps[64];
+        snprintf(gps, sizeof(gps), "%.1f|3D Fix\n", t.speedKph / 1.609344);
+        medium.api(cyd)->feedSerial(gps);
+      }
+      if (us % (SIM_REPORT_MS * 1000ULL) == 0)
+        printf("%9.3f sim   %5.1f km/h gear %d %4.0f rpm load %3.0f%% | oil "
+               "%5.1f C %4.1f PSI | fuel %4.1f%% (float %4.1f%%)\n",
+               us / 1e6, t.speedKph, t.gear, t.rpm, t.load * 100, t.oilTempC,
+               t.oilPressurePsi, t.fuelPercent, t.senderPercent);
+      medium.run(us);
+      if (vehicle.finished())
+        break;
+    }
+  }
+
+  printf("\nlink          sent delivered   lost    dup  lat avg  lat max\n");
+  for (int from = 0; from < medium.size(); from++) {
+    for (int to = 0; to < medium.size(); to++) {
+      const LinkCounters &lc = medium.link(from, to);
+      if (from == to || lc.sent == 0 || to > fuel)
+        continue;
+      const std::string name = medium.name(from) + ">" + medium.name(to);
+      printf("%-12s %5u %9u %6u %6u %6.2fms %6.2fms\n", name.c_str(),
+             lc.sent, lc.delivered, lc.lost, lc.duplicated,
+             lc.delivered ? lc.latencyUsTotal / 1e3 / lc.delivered : 0.0,
+             lc.latencyUsMax / 1e3);
+    }
+  }
+
+  printf("\nnode        tx   tx bytes  q full  send ok  fail      rx  "
+         "goodput\n");
+  for (int n = 0; n < medium.size(); n++) {
+    const NodeCounters &c = medium.counters(n);
+    printf("%-7s %6u %10llu %7u %8u %5u %7u %6.0fB/s\n",
+           medium.name(n).c_str(), c.txFrames, (unsigned long long)c.txBytes,
+           c.queueFull, c.sendOk, c.sendFail, c.rxFrames,
+           c.rxBytes / seconds);
+  }
+  printf("\nchannel busy %.1f%% of %.0f s\n",
+         100.0 * medium.busyMicros() / endUs, seconds);
+  printf("oil i2c busy %.1f%%, pressure read every %.1f ms avg, %.1f ms "
+         "max\n",
+         100.0 * oilApi->wireBusyMicros() / endUs,
+         adsGaps ? adsGapSumUs / 1e3 / adsGaps : 0.0, adsGapMaxUs / 1e3);
+
+  printf("uplink %u telemetry frames from the display, %u invalid\n",
+         uplinkFrames, uplinkBad);
+  if (uplink)
+    fclose(uplink);
+
+  if (sim) {
+    printf("\naccuracy        reads faulted     bias  mean |e|  max |e|\n");
+    printAccuracy("oil temp C", oilTempAcc);
+    printAccuracy("oil press PSI", oilPressAcc);
+    printAccuracy("fuel %", fuelAcc);
+    if (pressWindow.windows > 0)
+      printf("oil press low per packet: value %.2f PSI over the true "
+             "minimum, window min %.2f PSI\n",
+             pressWindow.valueMiss / pressWindow.windows,
+             pressWindow.windowMiss / pressWindow.windows);
+  }
+
+  bool ok = medium.link(oil, cyd).delivered > 0 &&
+             medium.link(fuel, cyd).delivered > 0;
+  if (!ok)
+    printf("FAILED: a sender never reached the display\n");
+  const bool cleanChannel = cfg.loss == 0 && floods == 0;
+  for (const char *label : {"OIL TEMP", "OIL PRESSURE", "FUEL"}) {
+    if (!cleanChannel)
+      break;
+    const auto it = firstOnScreenMs.find(label);
+    if (it == firstOnScreenMs.end()) {
+      printf("FAILED: %s never reached the screen\n", label);
+      ok = false;
+    } else if (it->second > FIRST_READING_MAX_MS) {
+      printf("FAILED: first %s on screen at %lu ms, over %d ms\n", label,
+             it->second, FIRST_READING_MAX_MS);
+      ok = false;
+    }
+  }
+  // The node threads are parked mid-loop() and can't be joined
+  fflush(stdout);
+  _exit(ok ? 0 : 1);
+}
@@ -0,0 +1,58 @@
+// Linked into every node shared object: exposes the sketch and its private
+// copy of the host shim through one table. Everything else in the object is
+// built with hidden visibility, so nodes never see each other's globals.
+
+#include "node_api.h"
+#include "Adafruit_ADS1X15.h"
+#include "Adafruit_MAX31856.h"
+#include "WiFi.h"
+#include "Wire.h"
+
+void setup();
+void loop();
+
+static void setThermocouple(float tempC, float coldJunctionC, uint8_t fault) {
+  Adafruit_MAX31856::hostThermocoupleC = tempC;
+  Adafruit_MAX31856::hostColdJunctionC = coldJunctionC;
+  Adafruit_MAX31856::hostFault = fault;
+}
+
+static void setAdcVolts(uint8_t channel, float volts) {
+  Adafruit_ADS1115::hostVolts[channel & 3] = volts;
+}
+
+static void setAdcReadHook(HostAdsReadHook hook) {
+  Adafruit_ADS1115::hostReadHook = hook;
+}
+
+static void setSerialOutput(HardwareSerial::Output out) {
+  Serial.hostSetOutput(out);
+}
+
+static void feedSerial(const char *text) { Serial.hostFeed(text); }
+
+static const NodeApi API = {
+    setup,
+    loop,
+    hostMicros64,
+    hostSetMicros64,
+    hostSetSleepHook,
+    hostSetMacAddress,
+    hostWifiChannel,
+    hostEspNowSetBackend,
+    hostEspNowDeliver,
+    hostEspNowSendDone,
+    setSerialOutput,
+    feedSerial,
+    hostSetAnalogReadHook,
+    hostWireAddDevice,
+    hostWireBusyMicros,
+    setThermocouple,
+    setAdcVolts,
+    setAdcReadHook,
+};
+
+extern "C" __attribute__((visibility("default"))) const NodeApi *
+hostNodeApi() {
+  return &API;
+}
@@ -0,0 +1,49 @@
+#ifndef HOST_NODE_API_H
+#define HOST_NODE_API_H
+
+// ============================================================================
+// SIMULATED NODE INTERFACE
+// ============================================================================
+// Each sketch is built as its own shared object together with a private copy
+// of the host Arduino shim, so several sketches (and their globals, clocks,
+// Serial and ESP-NOW stacks) can live in one process. The object exports a
+// single symbol, hostNodeApi(), through which the radio medium drives it.
+
+#include "Adafruit_ADS1X15.h"
+#include "Arduino.h"
+#include "esp_now.h"
+
+typedef struct {
+  void (*setup)();
+  void (*loop)();
+
+  // Clock
+  uint64_t (*micros)();
+  void (*setMicros)(uint64_t us);
+  void (*setSleepHook)(HostSleepHook hook);
+
+  // Radio
+  void (*setMac)(const uint8_t mac[6]);
+  uint8_t (*channel)();
+  void (*setBackend)(HostEspNowBackend *backend);
+  void (*deliver)(const uint8_t *src, const uint8_t *dest,
+                  const uint8_t *data, int len, int rssi);
+  void (*sendDone)(const uint8_t *dest, esp_now_send_status_t status);
+
+  // Serial output, one call per write, and input the sketch reads
+  void (*setSerialOutput)(HardwareSerial::Output out);
+  void (*feedSerial)(const char *text);
+
+  // Sensor inputs
+  void (*setAnalogReadHook)(HostAnalogReadHook hook);
+  void (*addI2cDevice)(uint8_t address);
+  uint64_t (*wireBusyMicros)(); // I2C bus time used so far
+  void (*setThermocouple)(float tempC, float coldJunctionC, uint8_t fault);
+  void (*setAdcVolts)(uint8_t channel, float volts);
+  void (*setAdcReadHook)(HostAdsReadHook hook);
+} NodeApi;
+
+typedef const NodeApi *(*NodeApiFn)();
+#define NODE_API_SYMBOL "hostNodeApi"
+
+#endif // HOST_NODE_API_H
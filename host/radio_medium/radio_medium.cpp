@@ -0,0 +1,385 @@
+// ESP-NOW radio medium: node loading, baton scheduling and the channel model
+
+#include "radio_medium.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+
+#define NODE_LOOP_US 10     // Least time one loop() pass takes
+#define PHY_PREAMBLE_US 192 // 802.11b long preamble, what ESP-NOW uses at 1M
+#define ESPNOW_OVERHEAD 43  // MAC header, action frame and vendor IE bytes
+#define ACK_BYTES 14
+#define SIFS_US 10
+#define DIFS_US 50
+#define SLOT_US 20
+#define CW_SLOTS 16 // Backoff window when the channel was busy
+#define RSSI_DBM -60
+
+static const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF};
+
+RadioMedium *RadioMedium::instance = nullptr;
+thread_local RadioMedium::Node *RadioMedium::self = nullptr;
+
+RadioMedium::RadioMedium(const MediumConfig &cfg)
+    : config(cfg), rng(cfg.seed), links(MAX_NODES * MAX_NODES),
+      linkInBurst(MAX_NODES * MAX_NODES) {
+  instance = this;
+  // Two-state loss: a run of losses lasts burst frames on average and the
+  // share of time spent in runs is loss
+  const double burst = config.burst < 1 ? 1 : config.burst;
+  leaveBurst = 1.0 / burst;
+  if (config.loss <= 0)
+    enterBurst = 0;
+  else if (config.loss >= 1)
+    enterBurst = 1, leaveBurst = 0;
+  else
+    enterBurst = config.loss * leaveBurst / (1 - config.loss);
+  if (enterBurst > 1)
+    enterBurst = 1;
+}
+
+int RadioMedium::addNode(const std::string &name, const std::string &path,
+                         const uint8_t mac[6], uint32_t bootUs) {
+  if ((int)nodes.size() >= MAX_NODES) {
+    fprintf(stderr, "%s: more than %d nodes\n", name.c_str(), MAX_NODES);
+    return -1;
+  }
+  // RTLD_LOCAL keeps each node's shim and sketch globals to itself
+  void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    fprintf(stderr, "%s: %s\n", name.c_str(), dlerror());
+    return -1;
+  }
+  NodeApiFn fn = (NodeApiFn)dlsym(handle, NODE_API_SYMBOL);
+  if (!fn) {
+    fprintf(stderr, "%s: no %s in %s\n", name.c_str(), NODE_API_SYMBOL,
+            path.c_str());
+    return -1;
+  }
+
+  Node *node = new Node();
+  node->name = name;
+  node->index = (int)nodes.size();
+  memcpy(node->mac, mac, 6);
+  node->handle = handle;
+  node->api = fn();
+  node->port.medium = this;
+  node->port.node = node;
+  node->wakeUs = bootUs;
+  nodes.push_back(node);
+
+  node->api->setMac(mac);
+  node->api->setBackend(&node->port);
+  node->api->setSleepHook(sleepHook);
+  node->api->setSerialOutput(serialHook);
+  node->thread = std::thread(&RadioMedium::nodeThread, this, node);
+  return node->index;
+}
+
+int RadioMedium::addFlood(const std::string &name, const uint8_t mac[6],
+                          double hz, size_t len) {
+  if ((int)nodes.size() >= MAX_NODES || hz <= 0)
+    return -1;
+  Node *node = new Node();
+  node->name = name;
+  node->index = (int)nodes.size();
+  memcpy(node->mac, mac, 6);
+  node->wakeUs = UINT64_MAX;
+  node->floodHz = hz;
+  node->floodLen = len < 1 ? 1 : len > ESP_NOW_MAX_DATA_LEN
+                                     ? ESP_NOW_MAX_DATA_LEN
+                                     : len;
+  nodes.push_back(node);
+
+  Event first = {};
+  first.kind = EVENT_FLOOD;
+  first.node = node->index;
+  first.us = std::uniform_int_distribution<uint64_t>(
+      0, (uint64_t)(1e6 / hz))(rng);
+  schedule(first);
+  return node->index;
+}
+
+// ===== Scheduling =====
+
+void RadioMedium::run(uint64_t endUs) {
+  for (;;) {
+    Node *next = nullptr;
+    for (Node *n : nodes) {
+      if (n->api && (!next || n->wakeUs < next->wakeUs))
+        next = n;
+    }
+    const uint64_t nodeUs = next ? next->wakeUs : UINT64_MAX;
+    if (!events.empty() && events.top().us <= nodeUs) {
+      if (events.top().us > endUs)
+        break;
+      Event e = events.top();
+      events.pop();
+      handle(e);
+      continue;
+    }
+    if (!next || nodeUs > endUs)
+      break;
+    // The node may keep the baton until something else is due
+    horizonUs = endUs + 1;
+    if (!events.empty() && events.top().us < horizonUs)
+      horizonUs = events.top().us;
+    for (Node *n : nodes) {
+      if (n != next && n->api && n->wakeUs < horizonUs)
+        horizonUs = n->wakeUs;
+    }
+    resume(*next);
+  }
+}
+
+void RadioMedium::resume(Node &node) {
+  if (node.api->micros() < node.wakeUs)
+    node.api->setMicros(node.wakeUs);
+  std::unique_lock<std::mutex> lock(batonMutex);
+  running = &node;
+  batonCv.notify_all();
+  batonCv.wait(lock, [this] { return running == nullptr; });
+}
+
+void RadioMedium::nodeThread(Node *node) {
+  self = node;
+  {
+    std::unique_lock<std::mutex> lock(batonMutex);
+    batonCv.wait(lock, [this, node] { return running == node; });
+  }
+  node->api->setup();
+  for (;;) {
+    node->api->loop();
+    sleepHook(node->api->micros() + NODE_LOOP_US);
+  }
+}
+
+// Every clock advance in a node ends up here
+void RadioMedium::sleepHook(uint64_t untilUs) {
+  RadioMedium *m = instance;
+  Node *node = self;
+  if (!node) {
+    // A radio callback moving time: it runs on the medium's thread and
+    // can't yield, so just move that node's clock
+    Node *cb = m->callbackNode;
+    if (cb && cb->api->micros() < untilUs)
+      cb->api->setMicros(untilUs);
+    return;
+  }
+  if (untilUs < m->horizonUs)
+    return; // Nothing else happens first, so no need to switch threads
+  std::unique_lock<std::mutex> lock(m->batonMutex);
+  node->wakeUs = untilUs;
+  m->running = nullptr;
+  m->batonCv.notify_all();
+  m->batonCv.wait(lock, [m, node] { return m->running == node; });
+}
+
+void RadioMedium::schedule(Event &event) {
+  event.order = nextOrder++;
+  events.push(event);
+  if (event.us < horizonUs)
+    horizonUs = event.us;
+}
+
+void RadioMedium::handle(const Event &e) {
+  Node &node = *nodes[e.node];
+  switch (e.kind) {
+  case EVENT_DELIVER: {
+    callbackNode = &node;
+    if (node.api->micros() < e.us)
+      node.api->setMicros(e.us);
+    const uint64_t atUs = node.api->micros();
+    LinkCounters &lc = links[e.from * MAX_NODES + e.node];
+    lc.delivered++;
+    lc.latencyUsTotal += atUs - e.sentUs;
+    if (atUs - e.sentUs > lc.latencyUsMax)
+      lc.latencyUsMax = atUs - e.sentUs;
+    node.stats.rxFrames++;
+    node.stats.rxBytes += e.data.size();
+    if (deliverHandler)
+      deliverHandler(e.from, e.node, atUs, e.data.data(), e.data.size());
+    node.api->deliver(nodes[e.from]->mac, e.dest, e.data.data(),
+                      (int)e.data.size(), RSSI_DBM);
+    callbackNode = nullptr;
+    break;
+  }
+  case EVENT_SEND_DONE:
+    node.inFlight--;
+    if (e.ok)
+      node.stats.sendOk++;
+    else
+      node.stats.sendFail++;
+    if (node.api) {
+      callbackNode = &node;
+      if (node.api->micros() < e.us)
+        node.api->setMicros(e.us);
+      node.api->sendDone(e.dest, e.ok ? ESP_NOW_SEND_SUCCESS
+                                      : ESP_NOW_SEND_FAIL);
+      callbackNode = nullptr;
+    }
+    break;
+  case EVENT_FLOOD: {
+    // Junk with protocol version 0, which every node ignores
+    std::vector<uint8_t> junk(node.floodLen);
+    for (size_t i = 1; i < junk.size(); i++)
+      junk[i] = (uint8_t)rng();
+    transmitFrom(node, e.us, BROADCAST_MAC, junk.data(), junk.size());
+    Event next = e;
+    next.us = e.us + (uint64_t)(1e6 / node.floodHz);
+    schedule(next);
+    break;
+  }
+  }
+}
+
+// ===== Channel model =====
+
+esp_err_t RadioMedium::Port::transmit(const uint8_t *dest,
+                                      const uint8_t *data, size_t len) {
+  return medium->transmitFrom(*node, node->api->micros(), dest, data, len);
+}
+
+uint64_t RadioMedium::airtimeUs(size_t len) const {
+  return PHY_PREAMBLE_US + (len + ESPNOW_OVERHEAD) * 8000ULL / config.rateKbps;
+}
+
+// Wait for the channel (plus backoff if someone else had it) and hold it for
+// airUs. Returns when the transmission ends.
+uint64_t RadioMedium::acquireChannel(uint64_t nowUs, uint64_t airUs) {
+  uint64_t startUs = nowUs + DIFS_US;
+  if (channelFreeUs > nowUs) {
+    startUs = channelFreeUs + DIFS_US +
+              std::uniform_int_distribution<int>(0, CW_SLOTS - 1)(rng) *
+                  SLOT_US;
+  }
+  channelFreeUs = startUs + airUs;
+  channelBusyUs += airUs;
+  return channelFreeUs;
+}
+
+bool RadioMedium::lose(int from, int to) {
+  const double u = std::uniform_real_distribution<double>(0, 1)(rng);
+  std::vector<bool>::reference bad = linkInBurst[from * MAX_NODES + to];
+  bad = bad ? u >= leaveBurst : u < enterBurst;
+  return bad;
+}
+
+esp_err_t RadioMedium::transmitFrom(Node &node, uint64_t nowUs,
+                                    const uint8_t *dest, const uint8_t *data,
+                                    size_t len) {
+  if (node.inFlight >= config.txQueue) {
+    node.stats.queueFull++;
+    return ESP_ERR_ESPNOW_NO_MEM;
+  }
+  node.inFlight++;
+  node.stats.txFrames++;
+  node.stats.txBytes += len;
+
+  const bool broadcast =
+      dest == nullptr || memcmp(dest, BROADCAST_MAC, 6) == 0;
+  const uint8_t channel = node.api ? node.api->channel() : 1;
+  const uint64_t airUs = airtimeUs(len);
+  const uint32_t jitterUs = config.jitterUs;
+
+  Event rx = {};
+  rx.kind = EVENT_DELIVER;
+  rx.from = node.index;
+  rx.sentUs = nowUs;
+  memcpy(rx.dest, broadcast ? BROADCAST_MAC : dest, 6);
+  rx.data.assign(data, data + len);
+  auto deliver = [&](Node &to, uint64_t airEndUs) {
+    rx.node = to.index;
+    rx.us = airEndUs + config.latencyUs +
+            (jitterUs ? std::uniform_int_distribution<uint32_t>(
+                            0, jitterUs)(rng)
+                      : 0);
+    schedule(rx);
+    if (std::uniform_real_distribution<double>(0, 1)(rng) <
+        config.duplicate) {
+      links[node.index * MAX_NODES + to.index].duplicated++;
+      rx.us += airUs + SIFS_US;
+      schedule(rx);
+    }
+  };
+
+  Event done = {};
+  done.kind = EVENT_SEND_DONE;
+  done.node = node.index;
+  memcpy(done.dest, rx.dest, 6);
+
+  if (broadcast) {
+    done.us = acquireChannel(nowUs, airUs);
+    done.ok = true;
+    for (Node *to : nodes) {
+      if (to == &node || !to->api || to->api->channel() != channel)
+        continue;
+      LinkCounters &lc = links[node.index * MAX_NODES + to->index];
+      lc.sent++;
+      if (lose(node.index, to->index))
+        lc.lost++;
+      else
+        deliver(*to, done.us);
+    }
+  } else {
+    Node *to = nullptr;
+    for (Node *n : nodes) {
+      if (n != &node && n->api && n->api->channel() == channel &&
+          memcmp(n->mac, dest, 6) == 0)
+        to = n;
+    }
+    // Each try is the frame, a SIFS and the ACK; no ACK means try again
+    const uint64_t ackUs =
+        SIFS_US + PHY_PREAMBLE_US + ACK_BYTES * 8000ULL / config.rateKbps;
+    uint64_t tUs = nowUs;
+    done.ok = false;
+    for (int attempt = 0; attempt <= config.retries && !done.ok;
+         attempt++) {
+      tUs = acquireChannel(tUs, airUs + ackUs);
+      if (to && !lose(node.index, to->index)) {
+        deliver(*to, tUs - ackUs);
+        done.ok = true;
+      }
+    }
+    done.us = tUs;
+    if (to) {
+      LinkCounters &lc = links[node.index * MAX_NODES + to->index];
+      lc.sent++;
+      if (!done.ok)
+        lc.lost++;
+    }
+  }
+  schedule(done);
+  return ESP_OK;
+}
+
+// ===== Serial =====
+
+void RadioMedium::serialHook(const uint8_t *buf, size_t len) {
+  instance->serialOutput(buf, len);
+}
+
+void RadioMedium::serialOutput(const uint8_t *buf, size_t len) {
+  Node *node = self ? self : callbackNode;
+  if (!node)
+    return;
+  if (outputHandler)
+    outputHandler(node->index, node->api->micros(), buf, len);
+  for (size_t i = 0; i < len; i++) {
+    const int kind = node->uplink.feed(buf[i]);
+    if (kind == UPLINK_FRAME && frameHandler)
+      frameHandler(node->index, node->api->micros(), node->uplink.packet(),
+                   node->uplink.packetLen());
+    if (kind != UPLINK_TEXT)
+      continue;
+    if (buf[i] != '\n') {
+      if (buf[i] != '\r')
+        node->line += (char)buf[i];
+      continue;
+    }
+    if (lineHandler)
+      lineHandler(node->index, node->api->micros(), node->line);
+    node->line.clear();
+  }
+}
@@ -0,0 +1,221 @@
+#ifndef HOST_RADIO_MEDIUM_H
+#define HOST_RADIO_MEDIUM_H
+
+// ============================================================================
+// ESP-NOW RADIO MEDIUM
+// ============================================================================
+// Runs several node shared objects (node_api.h) in one process on a shared
+// virtual clock and carries their ESP-NOW frames over a modelled channel:
+//
+//   - Airtime: one frame on the air at a time. A frame waits for the channel
+//     plus a random backoff, then occupies it for preamble + bytes at the
+//     PHY rate. Unicast ACKs and MAC retries take airtime too.
+//   - Loss: per directed link, a two-state (Gilbert) model. loss is the long
+//     run loss rate and burst the mean length of a run of losses; burst 1 is
+//     independent loss.
+//   - Latency and jitter: added between the end of the frame on the air and
+//     the receive callback, so jitter can reorder frames.
+//   - Duplication: a delivered frame is delivered again, as when an ACK is
+//     lost and the MAC retries.
+//   - Send status: unicast reports success once a copy is ACKed, failure
+//     after the retries run out; broadcast reports success when the frame
+//     leaves the air. A node with a full TX queue gets ESP_ERR_ESPNOW_NO_MEM.
+//
+// Each node runs on its own thread, but only one thread runs at a time: a
+// node gives up the baton when its clock moves (delay(), bus transfers) past
+// the next frame or another node's wake time, and the medium resumes
+// whichever node or pending frame is earliest. Radio
+// callbacks run on the medium's thread, in the receiving node's context, at
+// the frame's arrival time. Runs with the same seed are identical.
+//
+// Serial output is split into lines; telemetry uplink frames between them
+// (telemetry_uplink.h) are kept out of the lines and passed on whole.
+
+#include "node_api.h"
+#include <telemetry_uplink.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct {
+  double loss = 0;           // Long-run frame loss, 0..1
+  double burst = 1;          // Mean frames per loss run
+  uint32_t latencyUs = 100;  // Air-to-callback delay
+  uint32_t jitterUs = 0;     // Uniform extra delay, 0..jitterUs
+  double duplicate = 0;      // Chance a delivered frame arrives twice
+  uint32_t rateKbps = 1000;  // PHY rate, ESP-NOW default 1 Mbps
+  int retries = 7;           // Unicast MAC retries after the first try
+  int txQueue = 8;           // Frames a node may have in flight
+  uint64_t seed = 1;
+} MediumConfig;
+
+// Counts for one direction of one pair of nodes
+typedef struct {
+  uint32_t sent; // Frames offered, first tries only
+  uint32_t delivered;
+  uint32_t lost;
+  uint32_t duplicated;
+  uint64_t latencyUsTotal; // esp_now_send() to receive callback
+  uint64_t latencyUsMax;
+} LinkCounters;
+
+typedef struct {
+  uint32_t txFrames;
+  uint64_t txBytes;
+  uint32_t queueFull;
+  uint32_t sendOk;
+  uint32_t sendFail;
+  uint32_t rxFrames;
+  uint64_t rxBytes;
+} NodeCounters;
+
+class RadioMedium {
+public:
+  explicit RadioMedium(const MediumConfig &config);
+
+  // Load a node shared object. Returns its index, or -1 with a message on
+  // stderr.
+  int addNode(const std::string &name, const std::string &path,
+              const uint8_t mac[6], uint32_t bootUs = 0);
+  // A node with no sketch that broadcasts len junk bytes at hz
+  int addFlood(const std::string &name, const uint8_t mac[6], double hz,
+               size_t len);
+
+  const NodeApi *api(int node) const { return nodes[node]->api; }
+
+  // Each complete line a node prints, with the node and the time
+  void onSerialLine(
+      std::function<void(int node, uint64_t us, const std::string &)> fn) {
+    lineHandler = fn;
+  }
+
+  // Serial output exactly as a node wrote it, frames and text, with the time
+  void onSerialOutput(std::function<void(int node, uint64_t us,
+                                         const uint8_t *buf, size_t len)>
+                          fn) {
+    outputHandler = fn;
+  }
+
+  // Each uplink frame's packet a node writes to its serial
+  void onSerialFrame(std::function<void(int node, uint64_t us,
+                                        const uint8_t *data, size_t len)>
+                         fn) {
+    frameHandler = fn;
+  }
+
+  // Each frame as it reaches a node's receive callback
+  void onDeliver(std::function<void(int from, int to, uint64_t us,
+                                    const uint8_t *data, size_t len)>
+                     fn) {
+    deliverHandler = fn;
+  }
+
+  // Run every node until the clock reaches endUs. May be called again to
+  // carry on from there.
+  void run(uint64_t endUs);
+
+  int size() const { return (int)nodes.size(); }
+  const std::string &name(int node) const { return nodes[node]->name; }
+  const NodeCounters &counters(int node) const { return nodes[node]->stats; }
+  const LinkCounters &link(int from, int to) const {
+    return links[from * MAX_NODES + to];
+  }
+  uint64_t busyMicros() const { return channelBusyUs; }
+
+private:
+  static const int MAX_NODES = 16;
+
+  struct Node;
+
+  // esp_now_send() of one node lands here
+  class Port : public HostEspNowBackend {
+  public:
+    RadioMedium *medium;
+    Node *node;
+    esp_err_t transmit(const uint8_t *dest, const uint8_t *data,
+                       size_t len) override;
+  };
+
+  struct Node {
+    std::string name;
+    int index;
+    uint8_t mac[6];
+    void *handle; // dlopen() handle, NULL for a flood node
+    const NodeApi *api;
+    Port port;
+    std::thread thread;
+    uint64_t wakeUs; // When the node wants to run again
+    int inFlight;    // Sent frames awaiting their send status
+    double floodHz;
+    size_t floodLen;
+    std::string line; // Serial output not yet ended by a newline
+    UplinkReader uplink;
+    NodeCounters stats;
+  };
+
+  enum EventKind { EVENT_DELIVER, EVENT_SEND_DONE, EVENT_FLOOD };
+
+  struct Event {
+    uint64_t us;
+    uint64_t order; // Ties keep insertion order
+    EventKind kind;
+    int node; // Receiver, sender (send status) or flood node
+    int from;
+    uint8_t dest[6];
+    bool ok;
+    uint64_t sentUs;
+    std::vector<uint8_t> data;
+    bool operator>(const Event &o) const {
+      return us != o.us ? us > o.us : order > o.order;
+    }
+  };
+
+  esp_err_t transmitFrom(Node &node, uint64_t nowUs, const uint8_t *dest,
+                         const uint8_t *data, size_t len);
+  uint64_t airtimeUs(size_t len) const;
+  uint64_t acquireChannel(uint64_t nowUs, uint64_t airUs);
+  bool lose(int from, int to);
+  void schedule(Event &event);
+  void handle(const Event &event);
+  void resume(Node &node);
+  void nodeThread(Node *node);
+  void serialOutput(const uint8_t *buf, size_t len);
+
+  static void sleepHook(uint64_t untilUs);
+  static void serialHook(const uint8_t *buf, size_t len);
+
+  MediumConfig config;
+  std::mt19937_64 rng;
+  double enterBurst; // Gilbert transition chances, from loss and burst
+  double leaveBurst;
+  std::vector<Node *> nodes;
+  std::vector<LinkCounters> links;
+  std::vector<bool> linkInBurst;
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+  uint64_t nextOrder = 0;
+  uint64_t channelFreeUs = 0;
+  uint64_t channelBusyUs = 0;
+  std::function<void(int, uint64_t, const std::string &)> lineHandler;
+  std::function<void(int, uint64_t, const uint8_t *, size_t)> outputHandler;
+  std::function<void(int, uint64_t, const uint8_t *, size_t)> frameHandler;
+  std::function<void(int, int, uint64_t, const uint8_t *, size_t)>
+      deliverHandler;
+
+  // Baton: the node whose thread may run, or NULL for the medium
+  std::mutex batonMutex;
+  std::condition_variable batonCv;
+  Node *running = nullptr;
+  Node *callbackNode = nullptr; // Node whose radio callback is running
+  uint64_t horizonUs = 0;       // Running node yields before this time
+
+  static RadioMedium *instance;
+  static thread_local Node *self;
+};
+
+#endif // HOST_RADIO_MEDIUM_H
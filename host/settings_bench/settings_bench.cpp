@@ -0,0 +1,168 @@
+// ============================================================================
+// SETTINGS STORAGE BENCH
+// ============================================================================
+// Runs the oil sender's Settings (settings.cpp, unmodified) against the
+// in-memory Preferences shim and checks the blob store:
+//
+//   - settings saved by older firmware as one key per field are migrated
+//     into the blob on first boot, and the old keys removed
+//   - a reboot loads them back with one lookup
+//   - a run of console edits becomes one flash write, once the edits stop
+//   - re-saving unchanged values writes nothing
+//   - a corrupt or torn blob is rejected and defaults used
+//
+// It also prints the NVS lookups and writes each step costs next to the old
+// per-key layout.
+//
+// Exits 1 if any check fails.
+//
+// Usage: settings_bench
+
+#include "settings.h"
+
+#include <stdio.h>
+
+// The seven per-field keys settings.cpp used before the blob
+static const char *const OLD_KEYS[] = {"h_off", "h_lim",    "o_off",
+                                       "o_lim", "p_off",    "p_lo_lim",
+                                       "p_hi_lim"};
+#define OLD_KEY_COUNT (sizeof(OLD_KEYS) / sizeof(OLD_KEYS[0]))
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+static void row(const char *step, const char *layout) {
+  HostPreferencesStats s = hostPreferencesStats();
+  printf("%-24s %-8s %6lu %7lu %7lu\n", step, layout, (unsigned long)s.reads,
+         (unsigned long)s.writes, (unsigned long)s.bytesWritten);
+  hostPreferencesResetStats();
+}
+
+// What the old Settings::load() and save() cost
+static void oldLayout() {
+  Preferences prefs;
+  prefs.begin(SETTINGS_NAMESPACE, false);
+  hostPreferencesResetStats();
+  for (size_t i = 0; i < OLD_KEY_COUNT; i++)
+    prefs.getFloat(OLD_KEYS[i], 0.0f);
+  row("boot load", "keys");
+  for (size_t i = 0; i < OLD_KEY_COUNT; i++)
+    prefs.putFloat(OLD_KEYS[i], (float)i);
+  row("one console edit", "keys");
+  for (int edit = 0; edit < 20; edit++)
+    for (size_t i = 0; i < OLD_KEY_COUNT; i++)
+      prefs.putFloat(OLD_KEYS[i], (float)edit);
+  row("20 console edits", "keys");
+  prefs.end();
+  hostPreferencesErase();
+}
+
+int main() {
+  Serial.hostSetQuiet(true);
+  printf("%-24s %-8s %6s %7s %7s\n", "step", "layout", "reads", "writes",
+         "bytes");
+  oldLayout();
+
+  // Settings saved by the per-key firmware
+  {
+    Preferences prefs;
+    prefs.begin(SETTINGS_NAMESPACE, false);
+    for (size_t i = 0; i < OLD_KEY_COUNT; i++)
+      prefs.putFloat(OLD_KEYS[i], 100.0f + i);
+    prefs.end();
+  }
+  hostPreferencesResetStats();
+
+  Settings *s = new Settings();
+  s->begin();
+  row("migrate old keys", "blob");
+  check(s->oilTempAlarmHigh == 103.0f && s->oilPressAlarmHigh == 106.0f,
+        "migrated values");
+  check(s->writesThisBoot() == 1 && !s->pending(), "migration written");
+  {
+    Preferences prefs;
+    prefs.begin(SETTINGS_NAMESPACE, true);
+    bool left = false;
+    for (size_t i = 0; i < OLD_KEY_COUNT; i++)
+      left |= prefs.isKey(OLD_KEYS[i]);
+    check(!left, "old keys removed");
+  }
+  delete s;
+  hostPreferencesResetStats();
+
+  // Reboot
+  s = new Settings();
+  s->begin();
+  row("boot load", "blob");
+  check(s->oilPressAlarmLow == 105.0f, "values survive reboot");
+  check(hostPreferencesStats().writes == 0, "no write on boot");
+
+  // One edit, then a burst of edits a keypress apart
+  s->oilTempOffset = 1.5f;
+  s->save();
+  s->poll();
+  check(hostPreferencesStats().writes == 0, "edit deferred");
+  delay(SETTINGS_SAVE_QUIET_MS);
+  s->poll();
+  row("one console edit", "blob");
+  for (int edit = 0; edit < 20; edit++) {
+    s->oilTempAlarmHigh = 200.0f + edit;
+    s->save();
+    s->poll();
+    delay(500);
+  }
+  check(hostPreferencesStats().writes == 0, "no write while editing");
+  delay(SETTINGS_SAVE_QUIET_MS);
+  s->poll();
+  row("20 console edits", "blob");
+  check(s->writesThisBoot() == 2, "edits coalesced into one write");
+
+  // Saved with nothing changed
+  s->save();
+  s->flush();
+  check(s->writesThisBoot() == 2, "unchanged values not rewritten");
+  const uint32_t lifetime = s->lifetimeWrites();
+  delete s;
+
+  s = new Settings();
+  s->begin();
+  check(s->oilTempAlarmHigh == 219.0f, "last edit survives reboot");
+  check(s->lifetimeWrites() == lifetime && lifetime == 3,
+        "lifetime write count");
+  delete s;
+
+  // Flip one payload byte, then truncate
+  {
+    Preferences prefs;
+    prefs.begin(SETTINGS_NAMESPACE, false);
+    uint8_t image[64];
+    size_t len = prefs.getBytes(SETTINGS_KEY, image, sizeof(image));
+    image[len - 1] ^= 0x10;
+    prefs.putBytes(SETTINGS_KEY, image, len);
+    s = new Settings();
+    s->begin();
+    check(s->oilTempAlarmHigh == 250.0f, "corrupt blob gives defaults");
+    delete s;
+
+    image[len - 1] ^= 0x10;
+    prefs.putBytes(SETTINGS_KEY, image, len - 3);
+    s = new Settings();
+    s->begin();
+    check(s->oilTempAlarmHigh == 250.0f, "torn blob gives defaults");
+    delete s;
+    prefs.end();
+  }
+
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
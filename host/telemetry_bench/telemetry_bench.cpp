@@ -0,0 +1,278 @@
+// ============================================================================
+// TELEMETRY STORE BENCH
+// ============================================================================
+// Writes a synthetic history through the laptop's telemetry store
+// (laptop/telemetry/telemetry_store.cpp): two drives a day of 1 Hz frames,
+// built as sealed TelemetryPackets the way the CYD sends them, with warm-up,
+// speed changes, fuel burn and refills, a GPS track and a few low oil
+// pressure events. Then:
+//
+//   - prints the file size per row next to the raw uplink frames
+//   - reads every chunk back and checks each value is what was written
+//   - times a one-day query, a low-pressure query and a full scan, with the
+//     chunks and bytes each one had to read
+//
+// Exits 1 if any value doesn't round-trip or a query finds the wrong rows.
+//
+// Usage: telemetry_bench [days] [file]
+
+#include "telemetry_store.h"
+
+#include <telemetry_uplink.h>
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdlib.h>
+
+#define DAY_MS 86400000LL
+#define LOW_PRESS_PSI10 150 // Query threshold, under any healthy reading
+
+static std::mt19937 rng(2026);
+
+static double uniform(double lo, double hi) {
+  return std::uniform_real_distribution<double>(lo, hi)(rng);
+}
+
+static double noise(double sd) {
+  return std::normal_distribution<double>(0.0, sd)(rng);
+}
+
+// Slowly varying state carried from drive to drive
+struct Car {
+  double fuel = 80.0; // %
+  double lat = 47.6062;
+  double lon = -122.3321;
+  uint32_t displayMs = 0;
+  uint16_t seq = 0;
+};
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// One drive of `seconds` frames from startMs; lowPressAt >= 0 starts a 20 s
+// pressure loss there
+static void drive(Car *car, int64_t startMs, int seconds, int lowPressAt,
+                  double ambientF, std::vector<TelemetryRow> *rows,
+                  uint32_t *lowRows) {
+  double oilF = ambientF;
+  double speed = 0;
+  double target = 0;
+  double heading = uniform(0, 360);
+  double alt = uniform(20, 150);
+  int sats = 0;
+  car->displayMs = 0; // The CYD powers up with the car
+  for (int s = 0; s < seconds; s++) {
+    if (s % 60 == 0)
+      target = uniform(0, 1) < 0.15 ? 0 : uniform(25, 70);
+    speed += (target - speed) * 0.08 + noise(0.3);
+    speed = speed < 0.5 ? 0 : speed;
+    oilF += (205.0 - oilF) / 420.0 + noise(0.15);
+    double press = 25.0 + speed * 0.5 - (oilF - 150.0) * 0.05 + noise(0.4);
+    const bool low = lowPressAt >= 0 && s >= lowPressAt && s < lowPressAt + 20;
+    if (low)
+      press = uniform(4, 9);
+    car->fuel -= speed * 0.00012;
+    heading = fmod(heading + noise(2.0) + 360.0, 360.0);
+    const double metres = speed * 0.44704;
+    car->lat += metres * cos(heading * M_PI / 180) / 111320.0;
+    car->lon += metres * sin(heading * M_PI / 180) /
+                (111320.0 * cos(car->lat * M_PI / 180));
+    alt += noise(0.3);
+    if (s > 25 && s % 120 == 0)
+      sats = 7 + (int)(rng() % 6);
+
+    TelemetryPacket pkt = {};
+    pkt.displayMs = car->displayMs;
+    pkt.frameSeq = car->seq++;
+    pkt.fresh = TELEMETRY_OIL_TEMP | TELEMETRY_OIL_PRESS | TELEMETRY_FUEL;
+    if (s > 25) // Cold start: no fix yet
+      pkt.fresh |= TELEMETRY_GPS_FIX;
+    pkt.oilTempF10 = (int16_t)lround(oilF * 10);
+    pkt.oilPressPsi10 = (uint16_t)lround(press < 0 ? 0 : press * 10);
+    pkt.fuelPercent10 = (uint16_t)lround(car->fuel * 10);
+    pkt.oilAlarms = low ? OIL_ALARM_PRESS_LOW : 0;
+    pkt.speedMph10 = (uint16_t)lround(speed * 10);
+    pkt.latE7 = (int32_t)llround(car->lat * 1e7);
+    pkt.lonE7 = (int32_t)llround(car->lon * 1e7);
+    pkt.altM = (int16_t)lround(alt);
+    pkt.headingDeg10 = (uint16_t)lround(heading * 10);
+    pkt.satellites = (uint8_t)sats;
+    packetSeal(&pkt);
+
+    TelemetryPacketView view((const uint8_t *)&pkt, sizeof(pkt));
+    rows->push_back(telemetryRow(view, startMs + s * 1000LL));
+    if ((pkt.fresh & TELEMETRY_OIL_PRESS) &&
+        pkt.oilPressPsi10 < LOW_PRESS_PSI10)
+      (*lowRows)++;
+    car->displayMs += 1000;
+  }
+  if (car->fuel < 15)
+    car->fuel = uniform(85, 99); // Filled up before the next drive
+}
+
+template <typename Fn> static double msFor(Fn fn) {
+  const auto t0 = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+// Chunks a query would read, rows it matches (for the time range and an
+// optional oil pressure ceiling, -1 = none)
+struct QueryResult {
+  uint32_t chunks = 0;
+  uint64_t rows = 0;
+  uint64_t bytes = 0;
+};
+
+static QueryResult query(const char *path, int64_t fromMs, int64_t toMs,
+                         int64_t pressBelow) {
+  QueryResult result;
+  TelemetryReader reader;
+  if (!reader.open(path))
+    return result;
+  std::vector<int64_t> time, fresh, press;
+  for (const TelemetryChunk &chunk : reader.chunks()) {
+    const TelemetryChunkHeader &h = chunk.header;
+    const TelemetryColumnStats &ps = h.stats[TLM_OIL_PRESS];
+    if (h.stats[TLM_TIME].max < fromMs || h.stats[TLM_TIME].min > toMs)
+      continue;
+    if (pressBelow >= 0 && (ps.count == 0 || ps.min >= pressBelow))
+      continue;
+    result.chunks++;
+    reader.readColumn(chunk, TLM_TIME, &time);
+    if (pressBelow >= 0) {
+      reader.readColumn(chunk, TLM_FRESH, &fresh);
+      reader.readColumn(chunk, TLM_OIL_PRESS, &press);
+    }
+    for (uint32_t r = 0; r < h.rows; r++)
+      if (time[r] >= fromMs && time[r] <= toMs &&
+          (pressBelow < 0 ||
+           ((fresh[r] & TELEMETRY_OIL_PRESS) && press[r] < pressBelow)))
+        result.rows++;
+  }
+  result.bytes = reader.bytesRead();
+  return result;
+}
+
+int main(int argc, char **argv) {
+  const int days = argc > 1 ? atoi(argv[1]) : 90;
+  const char *path = argc > 2 ? argv[2] : "/tmp/telemetry_bench.tlm";
+  remove(path);
+
+  // ===== Synthesise =====
+  int64_t firstMs;
+  telemetryParseTime("2026-01-01", &firstMs);
+  std::vector<TelemetryRow> rows;
+  uint32_t lowRows = 0;
+  uint64_t dayRows = 0;
+  const int queryDay = days / 2;
+  Car car;
+  for (int d = 0; d < days; d++) {
+    const double ambientF = 50 + 25 * sin(d * 2 * M_PI / 365.0);
+    const size_t before = rows.size();
+    for (int trip = 0; trip < 2; trip++) {
+      const int64_t startMs = firstMs + d * DAY_MS +
+                              (trip ? 17 * 3600000LL : 8 * 3600000LL) +
+                              (int64_t)(rng() % 1800) * 1000;
+      const int seconds = 2400 + (int)(rng() % 900);
+      const int lowAt = (d % 29 == 11 && trip == 1) ? seconds / 2 : -1;
+      drive(&car, startMs, seconds, lowAt, ambientF, &rows, &lowRows);
+    }
+    if (d == queryDay)
+      dayRows = rows.size() - before;
+  }
+
+  // ===== Write =====
+  TelemetryWriter writer;
+  bool ok = writer.open(path);
+  const double writeMs = msFor([&] {
+    for (const TelemetryRow &row : rows)
+      ok = writer.add(row) && ok;
+    ok = writer.flush() && ok;
+  });
+  const uint32_t chunks = writer.chunksWritten();
+  const uint64_t bytes = writer.bytesWritten();
+  writer.close();
+  check(ok, "write");
+
+  const uint64_t rawBytes =
+      rows.size() * (uint64_t)(sizeof(TelemetryPacket) + UPLINK_OVERHEAD);
+  printf("%d days, %zu rows in %u chunks, written in %.0f ms\n", days,
+         rows.size(), chunks, writeMs);
+  printf("%-24s %12s %10s\n", "layout", "bytes", "bytes/row");
+  printf("%-24s %12llu %10.2f\n", "raw uplink frames",
+         (unsigned long long)rawBytes, (double)rawBytes / rows.size());
+  printf("%-24s %12llu %10.2f\n", "columnar store", (unsigned long long)bytes,
+         (double)bytes / rows.size());
+  printf("%-24s %12s %9.1fx\n", "", "", (double)rawBytes / bytes);
+
+  // Coded bytes per column over the whole file
+  TelemetryReader reader;
+  check(reader.open(path), "open for reading");
+  uint64_t columnBytes[TLM_COLUMNS] = {};
+  for (const TelemetryChunk &chunk : reader.chunks())
+    for (int c = 0; c < TLM_COLUMNS; c++)
+      columnBytes[c] += chunk.header.stats[c].bytes;
+  printf("\n%-16s %10s\n", "column", "bytes/row");
+  for (int c = 0; c < TLM_COLUMNS; c++)
+    printf("%-16s %10.3f\n", TLM_COLUMN_DEFS[c].name,
+           (double)columnBytes[c] / rows.size());
+  printf("%-16s %10.3f\n", "chunk headers",
+         (double)chunks * sizeof(TelemetryChunkHeader) / rows.size());
+
+  // ===== Round trip =====
+  size_t next = 0;
+  std::vector<int64_t> column;
+  const double scanMs = msFor([&] {
+    for (const TelemetryChunk &chunk : reader.chunks()) {
+      for (int c = 0; c < TLM_COLUMNS; c++) {
+        if (!reader.readColumn(chunk, c, &column)) {
+          check(false, "decode a column");
+          return;
+        }
+        for (uint32_t r = 0; r < chunk.header.rows; r++)
+          if (next + r >= rows.size() || rows[next + r].v[c] != column[r]) {
+            check(false, "round trip");
+            return;
+          }
+      }
+      next += chunk.header.rows;
+    }
+  });
+  check(next == rows.size(), "every row read back");
+
+  // ===== Queries =====
+  printf("\n%-26s %8s %10s %12s %9s\n", "query", "rows", "chunks", "bytes read",
+         "ms");
+  printf("%-26s %8zu %4zu of %3zu %12llu %9.2f\n", "full scan, all columns",
+         rows.size(), reader.chunks().size(), reader.chunks().size(),
+         (unsigned long long)reader.bytesRead(), scanMs);
+
+  QueryResult q;
+  const int64_t dayMs = firstMs + queryDay * DAY_MS;
+  double ms = msFor([&] { q = query(path, dayMs, dayMs + DAY_MS - 1, -1); });
+  printf("%-26s %8llu %4u of %3zu %12llu %9.2f\n", "one day",
+         (unsigned long long)q.rows, q.chunks, reader.chunks().size(),
+         (unsigned long long)q.bytes, ms);
+  check(q.rows == dayRows, "one-day query finds that day's rows");
+
+  ms = msFor(
+      [&] { q = query(path, INT64_MIN, INT64_MAX, LOW_PRESS_PSI10); });
+  printf("%-26s %8llu %4u of %3zu %12llu %9.2f\n", "oil_press_psi<15",
+         (unsigned long long)q.rows, q.chunks, reader.chunks().size(),
+         (unsigned long long)q.bytes, ms);
+  check(q.rows == lowRows, "low-pressure query finds every low row");
+
+  printf("\n%s\n", failures ? "FAILED" : "all checks passed");
+  remove(path);
+  return failures ? 1 : 0;
+}
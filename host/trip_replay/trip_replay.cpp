@@ -0,0 +1,228 @@
+// ============================================================================
+// TRIP COMPUTER REPLAY
+// ============================================================================
+// Drives the vehicle simulator through a scenario and feeds the CYD's trip
+// computer (trip_computer.h, unmodified) what the car would give it: a GPS
+// fix every second along the simulated road, and the fuel sender's level at
+// its sample rate, smoothed the way the sender smooths it (slosh included).
+// The sender's wiring-fault flag comes from the simulated ADC through the
+// sender's resistance smoothing and limits; while it is set the level is the
+// clamped 0% or 100% the sender sends.
+//
+// The drive is split into legs wherever the tank was filled. Each leg's
+// distance is checked against the simulator's ground truth. Legs of at least
+// ECONOMY_MIN_MI also have their fuel used checked, and the economy at the
+// end against the true economy over the fit's window: on shorter legs the
+// slosh at the sender outweighs the fuel burnt. They are also checked for
+// the longest stretch the fuel used stood still while driving, which is how
+// a fit that stopped taking readings shows. trip.txt is the long drive for
+// this, with a slow top-up and a fill between legs; trip_fault.txt unplugs
+// and shorts the fuel sender partway through a long leg.
+//
+// Exits 1 if a checked value is out of tolerance, or a long leg ends with
+// no economy.
+//
+// Usage: trip_replay SCENARIO...
+
+#include "trip_computer.h"
+#include "fuel_config.h"
+#include "vehicle_sim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#define GPS_INTERVAL_MS 1000
+#define KM_PER_MI 1.609344
+#define HEADING_DEG 30.0 // Road direction; turns don't move the GPS track
+
+// Tolerances per leg
+#define DISTANCE_TOL 0.01 // Share of the true distance
+#define FUEL_TOL 0.15     // Share of the true fuel burnt
+#define MPG_TOL 0.20      // Share of the true economy; the fit window
+                          // sees only about 3% of the tank go
+#define ECONOMY_MIN_MI 10.0
+#define STALE_MAX_MI 4.0 // A new fit reports after TRIP_FIT_MIN_SPAN_MI
+#define FIT_WINDOW_MI (TRIP_FIT_WINDOW * TRIP_FIT_STEP_MI)
+
+// The fuel sender's read_fuel_resistance(): ohms across the sender from the
+// ADC count, pushed past the fault limits when out of range
+static double senderOhms(int adcRaw) {
+  const double volts = adcRaw / 4095.0 * VOLTAGE_DIVIDER_VCC;
+  if (volts >= VOLTAGE_DIVIDER_VCC)
+    return FUEL_CLAMP_MAX_OHMS * 1.5;
+  const double ohms =
+      VOLTAGE_DIVIDER_SERIES * volts / (VOLTAGE_DIVIDER_VCC - volts);
+  if (ohms > FUEL_CLAMP_MAX_OHMS)
+    return FUEL_CLAMP_MAX_OHMS * 1.5;
+  return ohms < FUEL_CLAMP_MIN_OHMS ? 0 : ohms;
+}
+
+// The level the sender sends for a resistance (uncalibrated), clamped
+static double ohmsToPercent(double ohms) {
+  const double pct = (FUEL_OHMS_EMPTY - ohms) / FUEL_RESISTANCE_RANGE * 100;
+  return pct < 0 ? 0 : pct > 100 ? 100 : pct;
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char *scenario, int leg, const char *what) {
+  if (!ok) {
+    printf("FAIL: %s leg %d: %s\n", scenario, leg, what);
+    failures++;
+  }
+}
+
+// Ground truth at one GPS fix
+struct TruthPoint {
+  double miles;
+  double fuelPct;
+};
+
+// Trip and ground truth at the start of a leg, and the fuel used's longest
+// stand-still during it
+struct Leg {
+  double miles;
+  double fuelPct;
+  float tripMiles;
+  float tripGal;
+  float countedGal;     // Fuel used when it last changed
+  double countedMiles;  // And where
+  double staleMi;
+};
+
+static bool within(double value, double truth, double tol) {
+  return fabs(value - truth) <= tol * fabs(truth);
+}
+
+// True economy over the last FIT_WINDOW_MI of the leg
+static double windowMpg(const std::vector<TruthPoint> &points) {
+  if (points.size() < 2)
+    return 0;
+  const TruthPoint &end = points.back();
+  size_t i = points.size() - 1;
+  while (i > 0 && end.miles - points[i].miles < FIT_WINDOW_MI)
+    i--;
+  const double gal =
+      (points[i].fuelPct - end.fuelPct) / 100.0 * TRIP_TANK_CAPACITY_GAL;
+  return gal > 0 ? (end.miles - points[i].miles) / gal : 0;
+}
+
+static void endLeg(const char *scenario, int leg, const Leg &start,
+                   const std::vector<TruthPoint> &points,
+                   const TripComputer &trip) {
+  if (points.empty())
+    return;
+  const double trueMiles = points.back().miles - start.miles;
+  const double trueGal =
+      (start.fuelPct - points.back().fuelPct) / 100.0 * TRIP_TANK_CAPACITY_GAL;
+  const double tripMiles = trip.distanceMiles() - start.tripMiles;
+  const double tripGal = trip.fuelUsedGal() - start.tripGal;
+  float mpg = 0;
+  const bool haveMpg = trip.economyMpg(&mpg);
+  const double trueMpg = windowMpg(points);
+
+  printf("%-14s %3d %7.2f %7.2f %7.3f %7.3f %7.1f %7.1f %7.2f\n", scenario,
+         leg, tripMiles, trueMiles, tripGal, trueGal, haveMpg ? mpg : 0.0f,
+         trueMpg, start.staleMi);
+  check(within(tripMiles, trueMiles, DISTANCE_TOL), scenario, leg,
+        "distance");
+  if (trueMiles < ECONOMY_MIN_MI)
+    return;
+  check(within(tripGal, trueGal, FUEL_TOL), scenario, leg, "fuel used");
+  check(start.staleMi <= STALE_MAX_MI, scenario, leg,
+        "fuel used stood still while driving");
+  check(haveMpg, scenario, leg, "no economy at the end of the leg");
+  if (haveMpg)
+    check(within(mpg, trueMpg, MPG_TOL), scenario, leg, "economy");
+}
+
+static void replay(const char *path) {
+  VehicleSim sim;
+  if (!sim.loadScenario(path)) {
+    fprintf(stderr, "cannot read %s\n", path);
+    failures++;
+    return;
+  }
+  const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+  const uint32_t endMs = sim.endMs() ? sim.endMs() : 600000;
+
+  TripComputer trip;
+  double lat = 47.6062, lon = -122.3321;
+  double miles = 0;
+  double senderPct = -1; // The fuel sender's smoothed level
+  double senderOhmsAvg = -1; // And its smoothed resistance, for faults
+  double lastFuelPct = -1;
+  std::vector<TruthPoint> points; // This leg's
+  Leg start = {};
+  int leg = 1;
+  bool filling = false;
+
+  for (uint32_t ms = 0; ms <= endMs && !sim.finished();
+       ms += SAMPLE_INTERVAL_MS) {
+    sim.step((uint64_t)ms * 1000);
+    const VehicleTruth &truth = sim.truth();
+
+    // A rise in the tank ends the leg; a fill in steps is one boundary
+    if (lastFuelPct >= 0 && truth.fuelPercent > lastFuelPct + 1e-6) {
+      if (!filling)
+        endLeg(name, leg++, start, points, trip);
+      filling = true;
+    } else if (filling && truth.speedKph > 1) {
+      filling = false;
+      start = {miles,     truth.fuelPercent,  trip.distanceMiles(),
+               trip.fuelUsedGal(), trip.fuelUsedGal(), miles, 0};
+      points.clear();
+    }
+    if (lastFuelPct < 0)
+      start.fuelPct = truth.fuelPercent;
+    lastFuelPct = truth.fuelPercent;
+
+    senderPct = senderPct < 0 ? truth.senderPercent
+                              : FUEL_SMOOTHING_ALPHA * truth.senderPercent +
+                                    (1 - FUEL_SMOOTHING_ALPHA) * senderPct;
+    const double ohms = senderOhms(sim.fuelAdcRaw());
+    senderOhmsAvg = senderOhmsAvg < 0
+                        ? ohms
+                        : FUEL_SMOOTHING_ALPHA * ohms +
+                              (1 - FUEL_SMOOTHING_ALPHA) * senderOhmsAvg;
+    if (ms % GPS_INTERVAL_MS != 0)
+      continue;
+
+    // Move along the road by the distance covered since the last fix
+    const double stepMi =
+        truth.speedKph / KM_PER_MI * GPS_INTERVAL_MS / 3600000.0;
+    miles += stepMi;
+    const double stepRad = stepMi / TRIP_EARTH_RADIUS_MI;
+    lat += stepRad * cos(HEADING_DEG * M_PI / 180) * 180 / M_PI;
+    lon += stepRad * sin(HEADING_DEG * M_PI / 180) * 180 / M_PI /
+           cos(lat * M_PI / 180);
+    trip.addFix(lat, lon, (float)(truth.speedKph / KM_PER_MI), true, ms);
+    const bool faulted = senderOhmsAvg > FUEL_FAULT_OPEN_CIRCUIT_OHMS ||
+                         senderOhmsAvg < FUEL_FAULT_SHORT_CIRCUIT_OHMS;
+    trip.addFuel((float)(faulted ? ohmsToPercent(senderOhmsAvg) : senderPct),
+                 ms, faulted);
+    if (trip.fuelUsedGal() != start.countedGal) {
+      start.countedGal = trip.fuelUsedGal();
+      start.countedMiles = miles;
+    }
+    start.staleMi = fmax(start.staleMi, miles - start.countedMiles);
+    if (!filling)
+      points.push_back({miles, truth.fuelPercent});
+  }
+  if (!filling)
+    endLeg(name, leg, start, points, trip);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s SCENARIO...\n", argv[0]);
+    return 2;
+  }
+  printf("%-14s %3s %7s %7s %7s %7s %7s %7s %7s\n", "scenario", "leg", "mi",
+         "true", "gal", "true", "mpg", "true", "stale");
+  for (int i = 1; i < argc; i++)
+    replay(argv[i]);
+  printf("\n%s\n", failures ? "FAILED" : "all checks passed");
+  return failures ? 1 : 0;
+}
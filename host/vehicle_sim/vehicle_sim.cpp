@@ -0,0 +1,322 @@
+// Vehicle signal simulator: drivetrain, oil, fuel and sensor models
+
+#include "vehicle_sim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_STEP_S 0.01
+
+// Drivetrain (4-speed Type 1 gearbox, 165R15 tyres)
+#define GEARS 4
+static const double GEAR_RATIO[GEARS] = {3.80, 2.06, 1.26, 0.93};
+static const double TRACTION_MS2[GEARS] = {2.4, 1.7, 1.1, 0.75};
+#define FINAL_DRIVE 4.125
+#define TYRE_CIRCUMFERENCE_M 1.98
+#define IDLE_RPM 850.0
+#define UPSHIFT_RPM 3600.0
+#define DOWNSHIFT_RPM 1600.0
+#define BRAKE_MS2 4.0
+#define ROLLING_MS2 0.12
+#define AERO_PER_MS2 0.00035 // Drag deceleration per (m/s)^2
+#define IDLE_LOAD 0.05
+
+// Oil temperature, C per second
+#define OIL_HEAT 0.14          // Per 1000 RPM at (0.3 + load)
+#define OIL_COOL_BASE 0.0006   // Per C above ambient, standing
+#define OIL_COOL_SPEED 0.00008 // Extra per C above ambient per m/s
+#define OIL_COOLER 0.01        // Per C above OIL_COOLER_C
+#define OIL_COOLER_C 95.0
+
+// Oil pressure
+#define PUMP_PSI_PER_KRPM 18.0 // At 90 C
+#define VISCOSITY_C 40.0       // Pressure falls by e per this many C
+#define RELIEF_PSI 75.0
+#define PRESSURE_LAG_S 0.15
+#define PUMP_RIPPLE_PSI 0.6
+
+// Pressure sender: 0.5-4.5 V for 0-100 PSI, through the 2.2k/4.7k divider
+#define SENDER_SUPPLY_V 5.0
+#define SENDER_DIVIDER (4.7 / (2.2 + 4.7))
+
+// Fuel
+#define TANK_LITRES 40.0
+#define IDLE_LITRES_PER_HOUR 0.6
+#define BURN_LITRES_PER_HOUR 25.0 // At full load and 4000 RPM
+#define SLOSH_HZ 0.7
+#define SLOSH_DAMPING 0.15
+#define SLOSH_PERCENT_PER_MS2 4.0 // Steady tilt of the surface
+#define SLOSH_LATERAL 0.5         // The float sits near the tank's centreline
+
+// Fuel sender: 73 ohm empty to 10 ohm full, 100 ohm series on 3.3 V
+#define SENDER_EMPTY_OHMS 73.0
+#define SENDER_FULL_OHMS 10.0
+#define SERIES_OHMS 100.0
+#define ADC_MAX 4095
+
+// MAX31856 fault register bits
+#define TC_FAULT_OVUV 0x02
+#define TC_FAULT_OPEN 0x01
+
+#define GRAVITY 9.81
+
+static double clampd(double v, double lo, double hi) {
+  return v < lo ? lo : v > hi ? hi : v;
+}
+
+static bool parseWireFault(const std::string &arg, WireFault *fault) {
+  if (arg == "ok")
+    *fault = WIRE_OK;
+  else if (arg == "open")
+    *fault = WIRE_OPEN;
+  else if (arg == "short")
+    *fault = WIRE_SHORT;
+  else
+    return false;
+  return true;
+}
+
+VehicleSim::VehicleSim(uint64_t seed) : rng(seed), state() {
+  state.oilTempC = ambientC;
+  state.fuelPercent = 50;
+  state.senderPercent = 50;
+  state.rpm = IDLE_RPM;
+  state.load = IDLE_LOAD;
+}
+
+bool VehicleSim::loadScenario(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+  char line[512];
+  int lineNo = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineNo++;
+    std::string s(line);
+    size_t hash = s.find('#');
+    if (hash != std::string::npos)
+      s = s.substr(0, hash);
+    while (!s.empty() && (s.back() == '\n' || s.back() == '\r' ||
+                          s.back() == ' '))
+      s.pop_back();
+    if (s.empty())
+      continue;
+
+    char kind[16] = {0};
+    unsigned ms = 0;
+    int consumed = 0;
+    if (sscanf(s.c_str(), "%u %15s %n", &ms, kind, &consumed) < 2) {
+      fprintf(stderr, "%s:%d: skipped\n", path, lineNo);
+      continue;
+    }
+    ScenarioEvent e = {ms, kind, s.substr(consumed)};
+    if (e.kind == "end")
+      scenarioEndMs = ms;
+    events.push_back(e);
+  }
+  fclose(f);
+  return true;
+}
+
+void VehicleSim::step(uint64_t nowUs) {
+  while (nextEvent < events.size() &&
+         (uint64_t)events[nextEvent].ms * 1000 <= nowUs) {
+    const uint64_t atUs = (uint64_t)events[nextEvent].ms * 1000;
+    if (atUs > lastUs) {
+      integrate((atUs - lastUs) / 1e6);
+      lastUs = atUs;
+    }
+    apply(events[nextEvent++]);
+  }
+  if (nowUs > lastUs) {
+    integrate((nowUs - lastUs) / 1e6);
+    lastUs = nowUs;
+  }
+}
+
+void VehicleSim::apply(const ScenarioEvent &e) {
+  const double value = atof(e.arg.c_str());
+  bool ok = true;
+  if (e.kind == "speed")
+    targetMs = value / 3.6;
+  else if (e.kind == "turn")
+    lateralG = value;
+  else if (e.kind == "ambient")
+    ambientC = value;
+  else if (e.kind == "oil")
+    state.oilTempC = value;
+  else if (e.kind == "fuel")
+    state.fuelPercent = state.senderPercent = clampd(value, 0, 100);
+  else if (e.kind == "pump")
+    pumpHealth = clampd(value, 0, 1);
+  else if (e.kind == "cooling")
+    coolingShare = clampd(value, 0, 1);
+  else if (e.kind == "tc")
+    ok = parseWireFault(e.arg, &thermocouple);
+  else if (e.kind == "pressure")
+    ok = parseWireFault(e.arg, &pressureSender);
+  else if (e.kind == "level")
+    ok = parseWireFault(e.arg, &fuelSender);
+  else if (e.kind == "noise") {
+    char which[8] = {0};
+    double sigma = 0;
+    ok = sscanf(e.arg.c_str(), "%7s %lf", which, &sigma) == 2;
+    if (ok && !strcmp(which, "tc"))
+      tcNoiseC = sigma;
+    else if (ok && !strcmp(which, "ads"))
+      adsNoiseMv = sigma;
+    else if (ok && !strcmp(which, "adc"))
+      adcNoiseLsb = sigma;
+    else
+      ok = false;
+  } else if (e.kind == "end")
+    ended = true;
+  else
+    ok = false;
+  if (!ok)
+    fprintf(stderr, "scenario: bad event at %u ms: %s %s\n", e.ms,
+            e.kind.c_str(), e.arg.c_str());
+}
+
+void VehicleSim::integrate(double dt) {
+  while (dt > 0) {
+    const double h = dt < MAX_STEP_S ? dt : MAX_STEP_S;
+    dt -= h;
+
+    // Speed towards the target within what the current gear can pull
+    const double drag = ROLLING_MS2 + AERO_PER_MS2 * speedMs * speedMs;
+    const int g = state.gear > 0 ? state.gear - 1 : 0;
+    double a = (targetMs - speedMs) * 0.5;
+    a = clampd(a, -BRAKE_MS2, TRACTION_MS2[g] - drag);
+    speedMs += a * h;
+    if (speedMs < 0)
+      speedMs = 0;
+    accelMs2 = a;
+
+    // Gearbox
+    if (speedMs < 0.5 && targetMs == 0)
+      state.gear = 0;
+    else if (state.gear == 0)
+      state.gear = 1;
+    const double wheelRpm = speedMs / TYRE_CIRCUMFERENCE_M * 60;
+    if (state.gear > 0) {
+      double rpm = wheelRpm * GEAR_RATIO[state.gear - 1] * FINAL_DRIVE;
+      if (rpm > UPSHIFT_RPM && state.gear < GEARS && a > 0)
+        state.gear++;
+      else if (rpm < DOWNSHIFT_RPM && state.gear > 1)
+        state.gear--;
+    }
+    const double tractive = a + drag;
+    state.load =
+        state.gear > 0 && tractive > 0
+            ? clampd(tractive / TRACTION_MS2[state.gear - 1], IDLE_LOAD, 1)
+            : IDLE_LOAD;
+    double rpm = IDLE_RPM;
+    if (state.gear > 0) {
+      rpm = wheelRpm * GEAR_RATIO[state.gear - 1] * FINAL_DRIVE;
+      // Clutch slipping while pulling away
+      if (rpm < IDLE_RPM + 1000 * state.load && state.gear == 1)
+        rpm = IDLE_RPM + 1000 * state.load;
+      if (rpm < IDLE_RPM)
+        rpm = IDLE_RPM;
+    }
+    state.rpm = rpm;
+    state.speedKph = speedMs * 3.6;
+
+    // Oil temperature
+    const double krpm = rpm / 1000;
+    double dT = OIL_HEAT * krpm * (0.3 + state.load) -
+                coolingShare * (OIL_COOL_BASE + OIL_COOL_SPEED * speedMs) *
+                    (state.oilTempC - ambientC);
+    if (state.oilTempC > OIL_COOLER_C)
+      dT -= coolingShare * OIL_COOLER * (state.oilTempC - OIL_COOLER_C);
+    state.oilTempC += dT * h;
+
+    // Oil pressure: pump flow against thinning oil, then the gauge line lag
+    double pump = pumpHealth * PUMP_PSI_PER_KRPM * krpm *
+                  exp(-(state.oilTempC - 90) / VISCOSITY_C);
+    if (pump > RELIEF_PSI)
+      pump = RELIEF_PSI;
+    pressureLagPsi += (pump - pressureLagPsi) * (h / (PRESSURE_LAG_S + h));
+    pumpPhase = fmod(pumpPhase + 2 * M_PI * rpm / 60 * h, 2 * M_PI);
+    state.oilPressurePsi = pressureLagPsi + PUMP_RIPPLE_PSI * sin(pumpPhase);
+
+    // Fuel burnt, and the surface at the float
+    const double lph = IDLE_LITRES_PER_HOUR +
+                       BURN_LITRES_PER_HOUR * state.load * rpm / 4000;
+    state.fuelPercent -= lph / 3600 * h / TANK_LITRES * 100;
+    if (state.fuelPercent < 0)
+      state.fuelPercent = 0;
+    const double w = 2 * M_PI * SLOSH_HZ;
+    const double drive = -SLOSH_PERCENT_PER_MS2 * w * w *
+                         (a + SLOSH_LATERAL * lateralG * GRAVITY);
+    sloshRate += (drive - w * w * slosh - 2 * SLOSH_DAMPING * w * sloshRate) *
+                 h;
+    slosh += sloshRate * h;
+    state.senderPercent = clampd(state.fuelPercent + slosh, 0, 100);
+  }
+}
+
+// ===== Sensor outputs =====
+
+float VehicleSim::coldJunctionC() const {
+  // The amplifier sits in the engine bay
+  return (float)(ambientC + 0.25 * (state.oilTempC - ambientC));
+}
+
+uint8_t VehicleSim::thermocoupleFault() const {
+  switch (thermocouple) {
+  case WIRE_OPEN:
+    return TC_FAULT_OPEN;
+  case WIRE_SHORT:
+    return TC_FAULT_OVUV;
+  default:
+    return 0;
+  }
+}
+
+float VehicleSim::thermocoupleC() {
+  // With no junction to measure, the chip reads about its own temperature
+  if (thermocouple != WIRE_OK)
+    return coldJunctionC();
+  return (float)(state.oilTempC + tcNoiseC * unit(rng));
+}
+
+float VehicleSim::adsVolts(uint8_t channel) {
+  const double noise = adsNoiseMv / 1000 * unit(rng);
+  if (channel != 0)
+    return (float)noise;
+  switch (pressureSender) {
+  case WIRE_OPEN:
+    return (float)noise; // The divider pulls the input to ground
+  case WIRE_SHORT:
+    return (float)(SENDER_SUPPLY_V * SENDER_DIVIDER + noise);
+  default:
+    break;
+  }
+  const double psi = clampd(state.oilPressurePsi, 0, 100);
+  return (float)((0.5 + 4.0 * psi / 100) * SENDER_DIVIDER + noise);
+}
+
+int VehicleSim::fuelAdcRaw() {
+  double ratio;
+  switch (fuelSender) {
+  case WIRE_OPEN:
+    ratio = 1;
+    break;
+  case WIRE_SHORT:
+    ratio = 0;
+    break;
+  default: {
+    const double ohms =
+        SENDER_EMPTY_OHMS -
+        (SENDER_EMPTY_OHMS - SENDER_FULL_OHMS) * state.senderPercent / 100;
+    ratio = ohms / (SERIES_OHMS + ohms);
+    break;
+  }
+  }
+  const double raw = ratio * ADC_MAX + adcNoiseLsb * unit(rng);
+  return (int)clampd(round(raw), 0, ADC_MAX);
+}
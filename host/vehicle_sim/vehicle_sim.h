@@ -0,0 +1,119 @@
+#ifndef HOST_VEHICLE_SIM_H
+#define HOST_VEHICLE_SIM_H
+
+// ============================================================================
+// VEHICLE SIGNAL SIMULATOR
+// ============================================================================
+// A small physical model of the car the senders are fitted to (a 1972
+// Superbeetle), stepped on the host's virtual clock. A scenario script sets
+// the target road speed, cornering load, ambient temperature and wiring
+// faults over time; the model works out the rest:
+//
+//   - Drivetrain: speed follows the target at the car's acceleration and
+//     braking limits, the gearbox shifts on RPM, engine load comes from
+//     acceleration plus rolling and air drag.
+//   - Oil temperature: heat from RPM x load against cooling that grows with
+//     road speed and, above 95 C, the oil cooler. A cold start warms up over
+//     several minutes.
+//   - Oil pressure: pump output rises with RPM and falls as the oil thins
+//     with temperature, capped by the relief valve, with pump ripple.
+//     A scenario can wear the pump out or block the oil cooler.
+//   - Fuel: the tank drains with fuel burnt, and the surface at the sender
+//     sloshes as a damped oscillator driven by braking and cornering.
+//
+// Sensor outputs are what the sender hardware would see: thermocouple and
+// cold-junction temperature with the MAX31856 fault register, the pressure
+// sender voltage after its divider at the ADS1115, and the ESP32 ADC count
+// across the fuel sender divider, each with its own noise. Reads draw fresh
+// noise, so a sender can sample at any rate.
+
+#include <random>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Wiring faults a scenario can inject
+typedef enum {
+  WIRE_OK,
+  WIRE_OPEN,  // Broken wire or unplugged connector
+  WIRE_SHORT, // Chafed to ground (or to supply for the pressure sender)
+} WireFault;
+
+typedef struct {
+  uint32_t ms;
+  std::string kind;
+  std::string arg;
+} ScenarioEvent;
+
+// Ground truth at one instant
+typedef struct {
+  double speedKph;
+  double rpm;
+  int gear;     // 0 = stopped in neutral
+  double load;  // 0..1
+  double oilTempC;
+  double oilPressurePsi;
+  double fuelPercent; // Tank contents
+  double senderPercent; // Level at the float, with slosh
+} VehicleTruth;
+
+class VehicleSim {
+public:
+  explicit VehicleSim(uint64_t seed = 1);
+
+  // Read a scenario script. Returns false if the file can't be read; unknown
+  // lines are reported on stderr and skipped.
+  bool loadScenario(const char *path);
+
+  // Advance the model to nowUs, applying due scenario events
+  void step(uint64_t nowUs);
+  bool finished() const { return ended; }
+  // Time of the scenario's end line, 0 if it has none
+  uint32_t endMs() const { return scenarioEndMs; }
+
+  const VehicleTruth &truth() const { return state; }
+
+  // MAX31856: thermocouple and cold junction C, fault register
+  float thermocoupleC();
+  float coldJunctionC() const;
+  uint8_t thermocoupleFault() const;
+  // ADS1115 input volts for channel (the pressure sender is on 0)
+  float adsVolts(uint8_t channel);
+  // ESP32 12-bit ADC count on the fuel sender pin
+  int fuelAdcRaw();
+
+private:
+  void apply(const ScenarioEvent &e);
+  void integrate(double dt);
+
+  std::mt19937_64 rng;
+  std::normal_distribution<double> unit{0.0, 1.0};
+  std::vector<ScenarioEvent> events;
+  size_t nextEvent = 0;
+  uint32_t scenarioEndMs = 0;
+  bool ended = false;
+  uint64_t lastUs = 0;
+
+  VehicleTruth state;
+  double speedMs = 0;
+  double targetMs = 0;
+  double accelMs2 = 0; // Longitudinal, from the last step
+  double lateralG = 0;
+  double ambientC = 20;
+  double pressureLagPsi = 0; // Pump output before the gauge line
+  double pumpPhase = 0;
+  double slosh = 0; // Surface displacement at the float, percent
+  double sloshRate = 0;
+
+  double pumpHealth = 1;  // Pump output share (worn pump, blocked pickup)
+  double coolingShare = 1; // Cooling share (blocked cooler, fan belt off)
+
+  WireFault thermocouple = WIRE_OK;
+  WireFault pressureSender = WIRE_OK;
+  WireFault fuelSender = WIRE_OK;
+  double tcNoiseC = 0.1;
+  double adsNoiseMv = 2.0;
+  double adcNoiseLsb = 8.0;
+};
+
+#endif // HOST_VEHICLE_SIM_H
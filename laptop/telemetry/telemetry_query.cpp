@@ -0,0 +1,255 @@
+// ============================================================================
+// TELEMETRY QUERY
+// ============================================================================
+// Prints the rows of a telemetry store (telemetry_store.h) in a time range
+// and matching value conditions, as CSV. Chunks whose header stats rule the
+// range or a condition out are skipped without reading their data; of the
+// rest, the condition columns are decoded first and the other columns only
+// if a row matched.
+//
+// Conditions are COLUMN OP VALUE in the column's units, OP one of < <= >
+// >= =, for example "oil_press_psi<15" or "speed_mph>=60". A row matches
+// only if the channel was fresh. Times are UTC: "2026-10-18",
+// "2026-10-18T14:05[:30]" or Unix seconds.
+//
+// Usage: telemetry_query FILE [--from TIME] [--to TIME] [--where COND]...
+//                        [--columns a,b,...] [--count]
+
+#include "telemetry_store.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum { OP_LT, OP_LE, OP_GT, OP_GE, OP_EQ } CompareOp;
+
+typedef struct {
+  int column;
+  CompareOp op;
+  int64_t value; // Stored units
+} Condition;
+
+static bool parseCondition(const char *text, Condition *cond) {
+  const char *op = strpbrk(text, "<>=");
+  if (!op)
+    return false;
+  const std::string name(text, op - text);
+  cond->column = telemetryColumn(name.c_str());
+  if (cond->column < 0)
+    return false;
+  const char *value = op + 1;
+  if (op[0] == '<')
+    cond->op = op[1] == '=' ? OP_LE : OP_LT;
+  else if (op[0] == '>')
+    cond->op = op[1] == '=' ? OP_GE : OP_GT;
+  else
+    cond->op = OP_EQ;
+  if (op[0] != '=' && op[1] == '=')
+    value++;
+  char *end;
+  const double v = strtod(value, &end);
+  if (end == value || *end != '\0')
+    return false;
+  cond->value = llround(v * TLM_COLUMN_DEFS[cond->column].scale);
+  return true;
+}
+
+static bool compare(int64_t v, const Condition &c) {
+  switch (c.op) {
+  case OP_LT:
+    return v < c.value;
+  case OP_LE:
+    return v <= c.value;
+  case OP_GT:
+    return v > c.value;
+  case OP_GE:
+    return v >= c.value;
+  default:
+    return v == c.value;
+  }
+}
+
+// Whether any value in [lo, hi] could satisfy c
+static bool mayMatch(int64_t lo, int64_t hi, const Condition &c) {
+  switch (c.op) {
+  case OP_LT:
+    return lo < c.value;
+  case OP_LE:
+    return lo <= c.value;
+  case OP_GT:
+    return hi > c.value;
+  case OP_GE:
+    return hi >= c.value;
+  default:
+    return lo <= c.value && c.value <= hi;
+  }
+}
+
+static void printValue(int column, int64_t v) {
+  const int64_t scale = TLM_COLUMN_DEFS[column].scale;
+  if (column == TLM_TIME) {
+    char text[40];
+    telemetryFormatTime(v, text, sizeof(text));
+    fputs(text, stdout);
+  } else if (scale == 1) {
+    printf("%lld", (long long)v);
+  } else {
+    int decimals = 0;
+    for (int64_t s = scale; s > 1; s /= 10)
+      decimals++;
+    printf("%.*f", decimals, (double)v / scale);
+  }
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s FILE [--from TIME] [--to TIME] [--where COND]... "
+          "[--columns a,b,...] [--count]\n"
+          "columns:",
+          argv0);
+  for (int c = 0; c < TLM_COLUMNS; c++)
+    fprintf(stderr, " %s", TLM_COLUMN_DEFS[c].name);
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+  const char *path = nullptr;
+  int64_t fromMs = INT64_MIN;
+  int64_t toMs = INT64_MAX;
+  std::vector<Condition> conditions;
+  std::vector<int> columns;
+  bool countOnly = false;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string a = argv[i];
+    const bool hasValue = i + 1 < argc;
+    bool ok = true;
+    if (a == "--from" && hasValue) {
+      ok = telemetryParseTime(argv[++i], &fromMs);
+    } else if (a == "--to" && hasValue) {
+      ok = telemetryParseTime(argv[++i], &toMs);
+    } else if (a == "--where" && hasValue) {
+      Condition c;
+      ok = parseCondition(argv[++i], &c);
+      conditions.push_back(c);
+    } else if (a == "--columns" && hasValue) {
+      char *list = argv[++i];
+      for (char *name = strtok(list, ","); name && ok;
+           name = strtok(nullptr, ",")) {
+        columns.push_back(telemetryColumn(name));
+        ok = columns.back() >= 0;
+      }
+    } else if (a == "--count") {
+      countOnly = true;
+    } else if (!path && a[0] != '-') {
+      path = argv[i];
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      fprintf(stderr, "bad argument: %s\n", argv[i]);
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (!path) {
+    usage(argv[0]);
+    return 2;
+  }
+  if (columns.empty())
+    for (int c = 0; c < TLM_COLUMNS; c++)
+      if (c != TLM_FRESH)
+        columns.push_back(c);
+
+  const auto t0 = std::chrono::steady_clock::now();
+  TelemetryReader reader;
+  if (!reader.open(path)) {
+    fprintf(stderr, "cannot read %s\n", path);
+    return 1;
+  }
+
+  if (!countOnly) {
+    for (size_t i = 0; i < columns.size(); i++)
+      printf("%s%s", i ? "," : "", TLM_COLUMN_DEFS[columns[i]].name);
+    printf("\n");
+  }
+
+  uint64_t rowsTotal = 0, rowsScanned = 0, matched = 0;
+  uint32_t chunksRead = 0;
+  std::vector<int64_t> values[TLM_COLUMNS];
+  for (const TelemetryChunk &chunk : reader.chunks()) {
+    const TelemetryChunkHeader &h = chunk.header;
+    rowsTotal += h.rows;
+    bool candidate = h.stats[TLM_TIME].max >= fromMs &&
+                     h.stats[TLM_TIME].min <= toMs;
+    for (const Condition &c : conditions)
+      candidate = candidate && h.stats[c.column].count > 0 &&
+                  mayMatch(h.stats[c.column].min, h.stats[c.column].max, c);
+    if (!candidate)
+      continue;
+
+    // Filter columns first, the rest only if a row matches
+    chunksRead++;
+    rowsScanned += h.rows;
+    bool loaded[TLM_COLUMNS] = {};
+    bool ok = true;
+    auto load = [&](int col) {
+      if (!loaded[col])
+        ok = reader.readColumn(chunk, col, &values[col]) && ok;
+      loaded[col] = true;
+    };
+    load(TLM_TIME);
+    load(TLM_FRESH);
+    for (const Condition &c : conditions)
+      load(c.column);
+    std::vector<uint32_t> hits;
+    for (uint32_t r = 0; ok && r < h.rows; r++) {
+      const int64_t t = values[TLM_TIME][r];
+      bool match = t >= fromMs && t <= toMs;
+      for (const Condition &c : conditions) {
+        const uint8_t bit = TLM_COLUMN_DEFS[c.column].freshBit;
+        match = match && (bit == 0 || (values[TLM_FRESH][r] & bit)) &&
+                compare(values[c.column][r], c);
+      }
+      if (match)
+        hits.push_back(r);
+    }
+    matched += hits.size();
+    if (!countOnly && !hits.empty())
+      for (int col : columns)
+        load(col);
+    if (!ok) {
+      fprintf(stderr, "chunk at offset %ld is corrupt\n", chunk.offset);
+      return 1;
+    }
+    if (countOnly)
+      continue;
+
+    for (uint32_t r : hits) {
+      for (size_t i = 0; i < columns.size(); i++) {
+        const int col = columns[i];
+        if (i)
+          putchar(',');
+        const uint8_t bit = TLM_COLUMN_DEFS[col].freshBit;
+        if (bit == 0 || (values[TLM_FRESH][r] & bit))
+          printValue(col, values[col][r]);
+      }
+      putchar('\n');
+    }
+  }
+  if (countOnly)
+    printf("%llu\n", (unsigned long long)matched);
+
+  const double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - t0)
+                        .count();
+  fprintf(stderr,
+          "%llu of %llu rows matched; read %u of %zu chunks (%llu rows), "
+          "%llu of %llu bytes, %.1f ms\n",
+          (unsigned long long)matched, (unsigned long long)rowsTotal,
+          chunksRead, reader.chunks().size(), (unsigned long long)rowsScanned,
+          (unsigned long long)reader.bytesRead(),
+          (unsigned long long)reader.fileBytes(), ms);
+  return 0;
+}
@@ -0,0 +1,217 @@
+// ============================================================================
+// TELEMETRY RECORDER
+// ============================================================================
+// Reads the CYD's USB serial, passes its log text through to stdout and
+// appends every telemetry frame (telemetry_uplink.h) to a telemetry store
+// (telemetry_store.h) as one row, stamped with the laptop's clock.
+//
+// The GPS forwarder and the recorder can't both own the port, so with
+// --forward the recorder also copies lines from stdin to the CYD: pipe the
+// forwarder's output into it (see laptop/README.md).
+//
+// --in replays a saved capture instead (espnow_soak --uplink). Rows are then
+// stamped from the frames' display time, counted from --start.
+//
+// Ctrl-C writes the rows still buffered before exiting.
+//
+// Usage: telemetry_rec --out FILE (--port DEV [--forward] | --in CAPTURE
+//                      [--start TIME]) [--quiet]
+
+#include "telemetry_store.h"
+
+#include <telemetry_uplink.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CYD_BAUD B115200
+
+static volatile sig_atomic_t stopping = 0;
+
+static void onSignal(int) { stopping = 1; }
+
+static int64_t wallClockMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int openPort(const char *dev) {
+  const int fd = open(dev, O_RDWR | O_NOCTTY);
+  if (fd < 0)
+    return -1;
+  struct termios tio;
+  if (tcgetattr(fd, &tio) != 0) {
+    close(fd);
+    return -1;
+  }
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, CYD_BAUD);
+  cfsetospeed(&tio, CYD_BAUD);
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Frames and text out of the serial stream, rows into the store
+struct Recorder {
+  UplinkReader uplink;
+  TelemetryWriter store;
+  bool quiet = false;
+  uint32_t rows = 0;
+  uint32_t invalid = 0;
+
+  // Replay clock: display time mapped onto startMs, across CYD restarts
+  bool replay = false;
+  int64_t startMs = 0;
+  int64_t replayOffsetMs = 0;
+  uint32_t lastDisplayMs = 0;
+  bool haveDisplayMs = false;
+
+  bool feed(const uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      const int kind = uplink.feed(buf[i]);
+      if (kind == UPLINK_TEXT && !quiet)
+        fputc(buf[i], stdout);
+      if (kind == UPLINK_FRAME && !frame())
+        return false;
+    }
+    return true;
+  }
+
+  bool frame() {
+    TelemetryPacketView pkt(uplink.packet(), uplink.packetLen());
+    if (!pkt.valid()) {
+      invalid++;
+      return true;
+    }
+    int64_t unixMs = wallClockMs();
+    if (replay) {
+      if (!haveDisplayMs)
+        replayOffsetMs = startMs - pkt.displayMs();
+      else if (pkt.displayMs() < lastDisplayMs) // The CYD restarted
+        replayOffsetMs += (int64_t)lastDisplayMs - pkt.displayMs() + 1000;
+      lastDisplayMs = pkt.displayMs();
+      haveDisplayMs = true;
+      unixMs = replayOffsetMs + pkt.displayMs();
+    }
+    rows++;
+    return store.add(telemetryRow(pkt, unixMs));
+  }
+};
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s --out FILE (--port DEV [--forward] | --in CAPTURE "
+          "[--start TIME]) [--quiet]\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  const char *outPath = nullptr;
+  const char *port = nullptr;
+  const char *inPath = nullptr;
+  const char *start = nullptr;
+  bool forward = false;
+  Recorder rec;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string a = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (a == "--out" && hasValue)
+      outPath = argv[++i];
+    else if (a == "--port" && hasValue)
+      port = argv[++i];
+    else if (a == "--in" && hasValue)
+      inPath = argv[++i];
+    else if (a == "--start" && hasValue)
+      start = argv[++i];
+    else if (a == "--forward")
+      forward = true;
+    else if (a == "--quiet")
+      rec.quiet = true;
+    else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (!outPath || !port == !inPath || (forward && !port)) {
+    usage(argv[0]);
+    return 2;
+  }
+  rec.replay = inPath != nullptr;
+  rec.startMs = wallClockMs();
+  if (start && !telemetryParseTime(start, &rec.startMs)) {
+    fprintf(stderr, "bad --start time %s\n", start);
+    return 2;
+  }
+  if (!rec.store.open(outPath)) {
+    fprintf(stderr, "cannot open %s\n", outPath);
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  const int fd = port ? openPort(port) : open(inPath, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "cannot open %s: %s\n", port ? port : inPath,
+            strerror(errno));
+    return 1;
+  }
+
+  bool ok = true;
+  uint8_t buf[512];
+  while (!stopping && ok) {
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+    if (forward)
+      FD_SET(STDIN_FILENO, &fds);
+    if (port && select(fd + 1, &fds, nullptr, nullptr, nullptr) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (forward && FD_ISSET(STDIN_FILENO, &fds)) {
+      const ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+      if (n <= 0)
+        forward = false; // Forwarder gone, keep recording
+      else if (write(fd, buf, n) != n)
+        fprintf(stderr, "short write forwarding GPS to %s\n", port);
+    }
+    if (!FD_ISSET(fd, &fds) && port)
+      continue;
+    const ssize_t n = read(fd, buf, sizeof(buf));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break; // End of capture, or the CYD was unplugged
+    ok = rec.feed(buf, (size_t)n);
+  }
+  fflush(stdout);
+
+  ok = rec.store.flush() && ok;
+  fprintf(stderr,
+          "recorded %u rows (%u frames invalid, %u unframed) in %u chunks, "
+          "%llu bytes written\n",
+          rec.rows, rec.invalid, rec.uplink.badFrameCount(),
+          rec.store.chunksWritten(),
+          (unsigned long long)rec.store.bytesWritten());
+  if (!ok)
+    fprintf(stderr, "write to %s failed\n", outPath);
+  rec.store.close();
+  close(fd);
+  return ok ? 0 : 1;
+}
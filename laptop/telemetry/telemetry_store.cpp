@@ -0,0 +1,323 @@
+#include "telemetry_store.h"
+
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+const TelemetryColumnDef TLM_COLUMN_DEFS[TLM_COLUMNS] = {
+    {"time", 1, 0},
+    {"fresh", 1, 0},
+    {"oil_temp_f", 10, TELEMETRY_OIL_TEMP},
+    {"oil_press_psi", 10, TELEMETRY_OIL_PRESS},
+    {"fuel_pct", 10, TELEMETRY_FUEL},
+    {"oil_faults", 1, 0},
+    {"fuel_faults", 1, 0},
+    {"oil_alarms", 1, 0},
+    {"fuel_alarms", 1, 0},
+    {"speed_mph", 10, TELEMETRY_GPS_FIX},
+    {"lat", 10000000, TELEMETRY_GPS_FIX},
+    {"lon", 10000000, TELEMETRY_GPS_FIX},
+    {"alt_m", 1, TELEMETRY_GPS_FIX},
+    {"heading", 10, TELEMETRY_GPS_FIX},
+    {"satellites", 1, 0},
+};
+
+int telemetryColumn(const char *name) {
+  for (int c = 0; c < TLM_COLUMNS; c++)
+    if (strcmp(TLM_COLUMN_DEFS[c].name, name) == 0)
+      return c;
+  return -1;
+}
+
+TelemetryRow telemetryRow(const TelemetryPacketView &pkt, int64_t unixMs) {
+  TelemetryRow row;
+  row.v[TLM_TIME] = unixMs;
+  row.v[TLM_FRESH] = pkt.fresh();
+  row.v[TLM_OIL_TEMP] = pkt.oilTempF10();
+  row.v[TLM_OIL_PRESS] = pkt.oilPressPsi10();
+  row.v[TLM_FUEL] = pkt.fuelPercent10();
+  row.v[TLM_OIL_FAULTS] = pkt.oilFaults();
+  row.v[TLM_FUEL_FAULTS] = pkt.fuelFaults();
+  row.v[TLM_OIL_ALARMS] = pkt.oilAlarms();
+  row.v[TLM_FUEL_ALARMS] = pkt.fuelAlarms();
+  row.v[TLM_SPEED] = pkt.speedMph10();
+  row.v[TLM_LAT] = pkt.latE7();
+  row.v[TLM_LON] = pkt.lonE7();
+  row.v[TLM_ALT] = pkt.altM();
+  row.v[TLM_HEADING] = pkt.headingDeg10();
+  row.v[TLM_SATELLITES] = pkt.satellites();
+  return row;
+}
+
+bool telemetryParseTime(const char *text, int64_t *unixMs) {
+  struct tm tm = {};
+  int n = 0;
+  if (sscanf(text, "%d-%d-%d%n", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &n) ==
+      3) {
+    if (text[n] == 'T' || text[n] == ' ') {
+      int used = 0;
+      if (sscanf(text + n + 1, "%d:%d%n", &tm.tm_hour, &tm.tm_min, &used) < 2)
+        return false;
+      n += 1 + used;
+      if (text[n] == ':' &&
+          sscanf(text + n + 1, "%d%n", &tm.tm_sec, &used) == 1)
+        n += 1 + used;
+    }
+    if (text[n] != '\0' && strcmp(text + n, "Z") != 0)
+      return false;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    *unixMs = (int64_t)timegm(&tm) * 1000;
+    return true;
+  }
+  char *end;
+  const double seconds = strtod(text, &end);
+  if (end == text || *end != '\0')
+    return false;
+  *unixMs = (int64_t)(seconds * 1000);
+  return true;
+}
+
+void telemetryFormatTime(int64_t unixMs, char *out, size_t outLen) {
+  const time_t s = (time_t)(unixMs / 1000);
+  struct tm tm;
+  gmtime_r(&s, &tm);
+  char date[32];
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &tm);
+  snprintf(out, outLen, "%s.%03dZ", date, (int)(unixMs % 1000));
+}
+
+// ===== Column codec =====
+// Tokens are unsigned varints. Even: the next delta, zigzag coded, in the
+// bits above. Odd: the bits above count values that repeat the last delta.
+
+static void putVarint(uint64_t v, std::string *out) {
+  while (v >= 0x80) {
+    out->push_back((char)(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back((char)v);
+}
+
+static uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (v >> 63); }
+
+static int64_t unzigzag(uint64_t v) {
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+void telemetryEncode(const int64_t *values, size_t n, std::string *out) {
+  int64_t prev = 0;
+  int64_t lastDelta = 0;
+  size_t i = 0;
+  while (i < n) {
+    size_t run = 0;
+    while (i + run < n &&
+           values[i + run] - (run ? values[i + run - 1] : prev) == lastDelta)
+      run++;
+    if (run > 1) {
+      putVarint((uint64_t)run << 1 | 1, out);
+      i += run;
+      prev = values[i - 1];
+      continue;
+    }
+    lastDelta = values[i] - prev;
+    putVarint(zigzag(lastDelta) << 1, out);
+    prev = values[i++];
+  }
+}
+
+bool telemetryDecode(const uint8_t *data, size_t len, size_t n,
+                     std::vector<int64_t> *out) {
+  out->clear();
+  out->reserve(n);
+  int64_t prev = 0;
+  int64_t lastDelta = 0;
+  size_t pos = 0;
+  while (out->size() < n) {
+    uint64_t token = 0;
+    for (int shift = 0;; shift += 7) {
+      if (pos >= len || shift > 63)
+        return false;
+      const uint8_t b = data[pos++];
+      token |= (uint64_t)(b & 0x7F) << shift;
+      if (!(b & 0x80))
+        break;
+    }
+    if (token & 1) {
+      const uint64_t run = token >> 1;
+      if (run > n - out->size())
+        return false;
+      for (uint64_t r = 0; r < run; r++)
+        out->push_back(prev += lastDelta);
+    } else {
+      lastDelta = unzigzag(token >> 1);
+      out->push_back(prev += lastDelta);
+    }
+  }
+  return pos == len;
+}
+
+// ===== Writing =====
+
+// Chunks of an open file, hopping over their data. Returns the offset just
+// past the last complete one.
+static long lastCompleteChunk(FILE *f, uint64_t size) {
+  long pos = sizeof(TelemetryFileHeader);
+  TelemetryChunkHeader h;
+  while (fseek(f, pos, SEEK_SET) == 0 && fread(&h, sizeof(h), 1, f) == 1 &&
+         h.magic == TLM_CHUNK_MAGIC &&
+         pos + sizeof(h) + (uint64_t)h.dataBytes <= size)
+    pos += sizeof(h) + h.dataBytes;
+  return pos;
+}
+
+static bool headerOk(FILE *f) {
+  TelemetryFileHeader fh;
+  return fseek(f, 0, SEEK_SET) == 0 && fread(&fh, sizeof(fh), 1, f) == 1 &&
+         fh.magic == TLM_FILE_MAGIC && fh.version == TLM_FILE_VERSION &&
+         fh.columns == TLM_COLUMNS;
+}
+
+bool TelemetryWriter::open(const char *path) {
+  close();
+  struct stat st;
+  if (stat(path, &st) == 0 && st.st_size > 0) {
+    file = fopen(path, "r+b");
+    if (!file)
+      return false;
+    if (!headerOk(file)) {
+      fprintf(stderr, "%s is not a telemetry file of this version\n", path);
+      close();
+      return false;
+    }
+    const long end = lastCompleteChunk(file, st.st_size);
+    if (end < st.st_size) {
+      fprintf(stderr, "%s: dropping %ld bytes of a torn chunk\n", path,
+              (long)(st.st_size - end));
+      if (ftruncate(fileno(file), end) != 0) {
+        close();
+        return false;
+      }
+    }
+    return fseek(file, end, SEEK_SET) == 0;
+  }
+
+  file = fopen(path, "w+b");
+  if (!file)
+    return false;
+  const TelemetryFileHeader fh = {TLM_FILE_MAGIC, TLM_FILE_VERSION,
+                                  TLM_COLUMNS};
+  if (fwrite(&fh, sizeof(fh), 1, file) != 1) {
+    close();
+    return false;
+  }
+  bytes += sizeof(fh);
+  return true;
+}
+
+bool TelemetryWriter::add(const TelemetryRow &row) {
+  if (!rows.empty() &&
+      row.v[TLM_TIME] - rows.back().v[TLM_TIME] > TLM_SESSION_GAP_MS &&
+      !flush())
+    return false;
+  rows.push_back(row);
+  return rows.size() < TLM_CHUNK_ROWS || flush();
+}
+
+bool TelemetryWriter::flush() {
+  if (!file || rows.empty())
+    return true;
+  TelemetryChunkHeader h = {};
+  h.magic = TLM_CHUNK_MAGIC;
+  h.rows = (uint32_t)rows.size();
+  std::string data;
+  std::vector<int64_t> column(rows.size());
+  for (int c = 0; c < TLM_COLUMNS; c++) {
+    TelemetryColumnStats &s = h.stats[c];
+    for (size_t r = 0; r < rows.size(); r++) {
+      const int64_t v = rows[r].v[c];
+      column[r] = v;
+      if (!telemetryFresh(rows[r], c))
+        continue;
+      if (s.count == 0 || v < s.min)
+        s.min = v;
+      if (s.count == 0 || v > s.max)
+        s.max = v;
+      s.count++;
+    }
+    const size_t before = data.size();
+    telemetryEncode(column.data(), column.size(), &data);
+    s.bytes = (uint32_t)(data.size() - before);
+  }
+  h.dataBytes = (uint32_t)data.size();
+  // Header last would need a seek back; a torn chunk is caught by its
+  // length against the file size instead
+  if (fwrite(&h, sizeof(h), 1, file) != 1 ||
+      fwrite(data.data(), 1, data.size(), file) != data.size() ||
+      fflush(file) != 0)
+    return false;
+  chunks++;
+  bytes += sizeof(h) + data.size();
+  rows.clear();
+  return true;
+}
+
+void TelemetryWriter::close() {
+  if (!file)
+    return;
+  flush();
+  fclose(file);
+  file = nullptr;
+}
+
+// ===== Reading =====
+
+bool TelemetryReader::open(const char *path) {
+  close();
+  file = fopen(path, "rb");
+  if (!file)
+    return false;
+  struct stat st;
+  if (fstat(fileno(file), &st) != 0 || !headerOk(file)) {
+    close();
+    return false;
+  }
+  size = st.st_size;
+  long pos = sizeof(TelemetryFileHeader);
+  TelemetryChunk chunk;
+  while (fseek(file, pos, SEEK_SET) == 0 &&
+         fread(&chunk.header, sizeof(chunk.header), 1, file) == 1 &&
+         chunk.header.magic == TLM_CHUNK_MAGIC &&
+         pos + sizeof(chunk.header) + (uint64_t)chunk.header.dataBytes <=
+             size) {
+    chunk.offset = pos;
+    index.push_back(chunk);
+    read += sizeof(chunk.header);
+    pos += sizeof(chunk.header) + chunk.header.dataBytes;
+  }
+  return true;
+}
+
+void TelemetryReader::close() {
+  if (file)
+    fclose(file);
+  file = nullptr;
+  index.clear();
+  size = 0;
+  read = 0;
+}
+
+bool TelemetryReader::readColumn(const TelemetryChunk &chunk, int col,
+                                 std::vector<int64_t> *out) {
+  long pos = chunk.offset + sizeof(TelemetryChunkHeader);
+  for (int c = 0; c < col; c++)
+    pos += chunk.header.stats[c].bytes;
+  const uint32_t len = chunk.header.stats[col].bytes;
+  buf.resize(len);
+  if (fseek(file, pos, SEEK_SET) != 0 ||
+      fread(buf.data(), 1, len, file) != len)
+    return false;
+  read += len;
+  return telemetryDecode(buf.data(), len, chunk.header.rows, out);
+}
@@ -0,0 +1,166 @@
+#ifndef TELEMETRY_STORE_H
+#define TELEMETRY_STORE_H
+
+// ============================================================================
+// TELEMETRY STORE
+// ============================================================================
+// Chunked columnar file of the CYD's telemetry frames, one row per frame,
+// appended to drive after drive. Built for months of 1 Hz history that
+// stays small and quick to query:
+//
+//   - Rows are buffered and written as chunks of up to TLM_CHUNK_ROWS. A
+//     chunk also ends when the frames stop for TLM_SESSION_GAP_MS, so a
+//     chunk never spans the car being off.
+//   - Inside a chunk each column is stored on its own: deltas between
+//     consecutive values, zigzag varint coded, with a run of repeated
+//     deltas as one token. Slow signals cost about a byte a row, flags and
+//     counters that don't change almost nothing.
+//   - Each chunk header holds every column's min and max (over the rows
+//     where the channel was fresh) and its coded length, so a query reads
+//     only the headers of chunks outside its time or value range, and only
+//     the columns it needs of the rest.
+//
+// All values are integers in the packet's units (TELEMETRY_FIELDS); time is
+// Unix ms. A torn last chunk (recorder killed mid-write) is dropped the next
+// time the file is opened for appending.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include <vehicle_packets.h>
+
+#define TLM_FILE_MAGIC 0x464D4C54u  // "TLMF"
+#define TLM_CHUNK_MAGIC 0x434D4C54u // "TLMC"
+#define TLM_FILE_VERSION 1
+#define TLM_CHUNK_ROWS 1800          // 30 minutes at 1 Hz
+#define TLM_SESSION_GAP_MS 60000     // Longer silence starts a new chunk
+
+enum TelemetryColumn {
+  TLM_TIME,        // Unix ms, recorder's clock
+  TLM_FRESH,       // TELEMETRY_* bits
+  TLM_OIL_TEMP,    // 0.1 F
+  TLM_OIL_PRESS,   // 0.1 PSI
+  TLM_FUEL,        // 0.1%
+  TLM_OIL_FAULTS,
+  TLM_FUEL_FAULTS,
+  TLM_OIL_ALARMS,
+  TLM_FUEL_ALARMS,
+  TLM_SPEED,       // 0.1 mph
+  TLM_LAT,         // 1e-7 degree
+  TLM_LON,
+  TLM_ALT,         // m
+  TLM_HEADING,     // 0.1 degree
+  TLM_SATELLITES,
+  TLM_COLUMNS,
+};
+
+typedef struct {
+  const char *name;  // Query and CSV name
+  int64_t scale;     // Stored value per unit (10 = tenths)
+  uint8_t freshBit;  // TELEMETRY_* bit the value depends on, 0 = always
+} TelemetryColumnDef;
+
+extern const TelemetryColumnDef TLM_COLUMN_DEFS[TLM_COLUMNS];
+
+// Column index by name, or -1
+int telemetryColumn(const char *name);
+
+typedef struct {
+  int64_t v[TLM_COLUMNS];
+} TelemetryRow;
+
+// Whether row's value in col was fresh (counts for stats and filters)
+inline bool telemetryFresh(const TelemetryRow &row, int col) {
+  const uint8_t bit = TLM_COLUMN_DEFS[col].freshBit;
+  return bit == 0 || (row.v[TLM_FRESH] & bit);
+}
+
+// A checked TelemetryPacket, stamped unixMs
+TelemetryRow telemetryRow(const TelemetryPacketView &pkt, int64_t unixMs);
+
+// "2026-10-18", "2026-10-18T14:05[:30]" (UTC) or Unix seconds
+bool telemetryParseTime(const char *text, int64_t *unixMs);
+void telemetryFormatTime(int64_t unixMs, char *out, size_t outLen);
+
+// ===== On disk =====
+typedef struct __attribute__((packed)) {
+  uint32_t magic; // TLM_FILE_MAGIC
+  uint16_t version;
+  uint16_t columns; // TLM_COLUMNS when written
+} TelemetryFileHeader;
+
+typedef struct __attribute__((packed)) {
+  int64_t min; // Over fresh rows only
+  int64_t max;
+  uint32_t count; // Fresh rows, 0 = min/max unset
+  uint32_t bytes; // Coded length of the column
+} TelemetryColumnStats;
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic; // TLM_CHUNK_MAGIC
+  uint32_t rows;
+  uint32_t dataBytes; // Column data after the stats
+  TelemetryColumnStats stats[TLM_COLUMNS];
+} TelemetryChunkHeader;
+
+// ===== Writing =====
+class TelemetryWriter {
+public:
+  ~TelemetryWriter() { close(); }
+
+  // Create path, or append to it after dropping a torn last chunk
+  bool open(const char *path);
+  // Buffer a row; writes a chunk when it fills or a session gap starts one
+  bool add(const TelemetryRow &row);
+  // Write the buffered rows as a chunk
+  bool flush();
+  void close();
+
+  uint32_t chunksWritten() const { return chunks; }
+  uint64_t bytesWritten() const { return bytes; }
+
+private:
+  FILE *file = nullptr;
+  std::vector<TelemetryRow> rows;
+  uint32_t chunks = 0;
+  uint64_t bytes = 0;
+};
+
+// ===== Reading =====
+typedef struct {
+  long offset; // Of the chunk header
+  TelemetryChunkHeader header;
+} TelemetryChunk;
+
+class TelemetryReader {
+public:
+  ~TelemetryReader() { close(); }
+
+  // Read every chunk header, hopping over the data
+  bool open(const char *path);
+  void close();
+
+  const std::vector<TelemetryChunk> &chunks() const { return index; }
+  // Decode one column of a chunk, reading only its bytes
+  bool readColumn(const TelemetryChunk &chunk, int col,
+                  std::vector<int64_t> *out);
+
+  uint64_t fileBytes() const { return size; }
+  uint64_t bytesRead() const { return read; }
+
+private:
+  FILE *file = nullptr;
+  std::vector<TelemetryChunk> index;
+  std::vector<uint8_t> buf;
+  uint64_t size = 0;
+  uint64_t read = 0;
+};
+
+// ===== Column codec (exposed for the bench) =====
+void telemetryEncode(const int64_t *values, size_t n, std::string *out);
+bool telemetryDecode(const uint8_t *data, size_t len, size_t n,
+                     std::vector<int64_t> *out);
+
+#endif // TELEMETRY_STORE_H